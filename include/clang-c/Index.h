@@ -32,7 +32,7 @@
  * compatible, thus CINDEX_VERSION_MAJOR is expected to remain stable.
  */
 #define CINDEX_VERSION_MAJOR 0
-#define CINDEX_VERSION_MINOR 37
+#define CINDEX_VERSION_MINOR 39
 
 #define CINDEX_VERSION_ENCODE(major, minor) ( \
       ((major) * 10000)                       \
@@ -1228,7 +1228,19 @@ enum CXTranslationUnit_Flags {
    * purposes of an IDE, this is undesirable behavior and as much information
    * as possible should be reported. Use this flag to enable this behavior.
    */
-  CXTranslationUnit_KeepGoing = 0x200
+  CXTranslationUnit_KeepGoing = 0x200,
+
+  /**
+   * \brief Used in combination with CXTranslationUnit_SkipFunctionBodies to
+   * still parse the function bodies in the main file.
+   *
+   * The bodies of functions declared in headers, including those in the
+   * preamble, are skipped, while those in the file being edited are fully
+   * parsed and checked. This keeps the diagnostics and cursors of the main
+   * file complete while reducing the time and memory needed to (re)parse
+   * translation units that include large headers.
+   */
+  CXTranslationUnit_KeepMainFileFunctionBodies = 0x400
 };
 
 /**
@@ -1505,12 +1517,15 @@ enum CXTUResourceUsageKind {
   CXTUResourceUsage_PreprocessingRecord = 12,
   CXTUResourceUsage_SourceManager_DataStructures = 13,
   CXTUResourceUsage_Preprocessor_HeaderSearch = 14,
+  CXTUResourceUsage_Sema = 15,
+  CXTUResourceUsage_Preamble = 16,
+  CXTUResourceUsage_ExternalASTSource_DataStructures = 17,
   CXTUResourceUsage_MEMORY_IN_BYTES_BEGIN = CXTUResourceUsage_AST,
   CXTUResourceUsage_MEMORY_IN_BYTES_END =
-    CXTUResourceUsage_Preprocessor_HeaderSearch,
+    CXTUResourceUsage_ExternalASTSource_DataStructures,
 
   CXTUResourceUsage_First = CXTUResourceUsage_AST,
-  CXTUResourceUsage_Last = CXTUResourceUsage_Preprocessor_HeaderSearch
+  CXTUResourceUsage_Last = CXTUResourceUsage_ExternalASTSource_DataStructures
 };
 
 /**
@@ -1552,6 +1567,71 @@ CINDEX_LINKAGE CXTUResourceUsage clang_getCXTUResourceUsage(CXTranslationUnit TU
 
 CINDEX_LINKAGE void clang_disposeCXTUResourceUsage(CXTUResourceUsage usage);
 
+/**
+ * \brief Return the total number of bytes of memory used by a translation
+ * unit, i.e. the sum of all of its entries reported by
+ * \c clang_getCXTUResourceUsage() that are measured in bytes.
+ */
+CINDEX_LINKAGE unsigned long long
+clang_getTranslationUnitMemoryUsage(CXTranslationUnit TU);
+
+/**
+ * \brief Set the memory budget, in bytes, for all of the translation units
+ * created from the given index.
+ *
+ * A budget of zero (the default) means that no budget is enforced.
+ *
+ * \sa clang_CXIndex_enforceMemoryBudget
+ */
+CINDEX_LINKAGE void clang_CXIndex_setMemoryBudget(CXIndex CIdx,
+                                                  unsigned long long budget);
+
+/**
+ * \brief Retrieve the memory budget set by
+ * \c clang_CXIndex_setMemoryBudget().
+ */
+CINDEX_LINKAGE unsigned long long clang_CXIndex_getMemoryBudget(CXIndex CIdx);
+
+/**
+ * \brief Visitor invoked by \c clang_CXIndex_enforceMemoryBudget() for each
+ * translation unit that should be evicted to get back under budget.
+ *
+ * \param tu The least recently used translation unit that is still alive.
+ *
+ * \param bytes The number of bytes of memory used by \p tu.
+ *
+ * \param client_data The client data passed to
+ * \c clang_CXIndex_enforceMemoryBudget().
+ *
+ * \returns non-zero if the client disposed of \p tu (with
+ * \c clang_disposeTranslationUnit()) and zero if it should be kept. The
+ * visitor must not dispose of any other translation unit.
+ */
+typedef int (*CXTranslationUnitEvictor)(CXTranslationUnit tu,
+                                        unsigned long long bytes,
+                                        CXClientData client_data);
+
+/**
+ * \brief Bring the translation units created from the given index back under
+ * the budget set by \c clang_CXIndex_setMemoryBudget().
+ *
+ * Translation units are considered in least-recently-used order, where a
+ * translation unit is "used" when it is parsed, reparsed or code-completed.
+ * For each one, libclang first releases the caches that it can recompute on
+ * the next reparse (e.g., cached code-completion results). If the index is
+ * still over budget, \p evictor is invoked so that the client can dispose of
+ * the translation unit.
+ *
+ * \param evictor The visitor invoked for each eviction candidate, or NULL to
+ * only release recomputable caches.
+ *
+ * \returns the number of translation units disposed of by the client.
+ */
+CINDEX_LINKAGE unsigned
+clang_CXIndex_enforceMemoryBudget(CXIndex CIdx,
+                                  CXTranslationUnitEvictor evictor,
+                                  CXClientData client_data);
+
 /**
  * @}
  */
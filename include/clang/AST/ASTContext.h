@@ -2593,6 +2593,16 @@ public:
   /// \brief The number of implicitly-declared destructors for which 
   /// declarations were built.
   static unsigned NumImplicitDestructorsDeclared;
+
+  /// \brief The number of lookups of function prototype types, and how many
+  /// of them found an existing type.
+  static unsigned NumFunctionProtoTypeLookups;
+  static unsigned NumFunctionProtoTypeHits;
+
+  /// \brief The number of lookups of canonical template specialization
+  /// types, and how many of them found an existing type.
+  static unsigned NumTemplateSpecializationTypeLookups;
+  static unsigned NumTemplateSpecializationTypeHits;
   
 public:
   /// \brief Initialize built-in types.
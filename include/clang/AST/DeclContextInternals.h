@@ -242,10 +242,20 @@ class StoredDeclsMap
 public:
   static void DestroyAll(StoredDeclsMap *Map, bool Dependent);
 
+  /// \brief Whether this map still fits in its inline buckets, i.e., the
+  /// owning context has only a handful of names and the map has not made
+  /// a separate allocation.
+  bool usesInlineStorage() const {
+    return getMemorySize() <= 4 * sizeof(value_type);
+  }
+
 private:
   friend class ASTContext; // walks the chain deleting these
   friend class DeclContext;
   llvm::PointerIntPair<StoredDeclsMap*, 1> Previous;
+
+  /// \brief The kind of the context that owns this map, for statistics.
+  Decl::Kind OwnerKind;
 };
 
 class DependentStoredDeclsMap : public StoredDeclsMap {
@@ -302,6 +302,10 @@ public:
 
   virtual void getMemoryBufferSizes(MemoryBufferSizes &sizes) const;
 
+  /// Return the amount of memory used by the in-memory tables this source
+  /// keeps to map serialized IDs to deserialized entities.
+  virtual size_t getDataStructureSizes() const;
+
 protected:
   static DeclContextLookupResult
   SetExternalVisibleDeclsForName(const DeclContext *DC,
@@ -3254,6 +3254,9 @@ private:
   /// Whether this function has a trailing return type.
   unsigned HasTrailingReturn : 1;
 
+  /// The hash of this type's profile, or 0 if it has not been computed.
+  mutable unsigned ProfileHash;
+
   // ParamInfo - There is an variable size array after the class in memory that
   // holds the parameter types.
 
@@ -3501,7 +3504,18 @@ public:
     return T->getTypeClass() == FunctionProto;
   }
 
-  void Profile(llvm::FoldingSetNodeID &ID, const ASTContext &Ctx);
+  /// \brief Retrieve the hash of this type's profile, as used to unique it
+  /// in the ASTContext. The hash is computed once and then cached.
+  unsigned getProfileHash(const ASTContext &Ctx) const {
+    if (!ProfileHash) {
+      llvm::FoldingSetNodeID ID;
+      Profile(ID, Ctx);
+      ProfileHash = ID.ComputeHash();
+    }
+    return ProfileHash;
+  }
+
+  void Profile(llvm::FoldingSetNodeID &ID, const ASTContext &Ctx) const;
   static void Profile(llvm::FoldingSetNodeID &ID, QualType Result,
                       param_type_iterator ArgTys, unsigned NumArgs,
                       const ExtProtoInfo &EPI, const ASTContext &Context,
@@ -4278,6 +4292,9 @@ class LLVM_ALIGNAS(/*alignof(uint64_t)*/ 8) TemplateSpecializationType
   /// Whether this template specialization type is a substituted type alias.
   unsigned TypeAlias : 1;
 
+  /// The hash of this type's profile, or 0 if it has not been computed.
+  mutable unsigned ProfileHash;
+
   TemplateSpecializationType(TemplateName T,
                              ArrayRef<TemplateArgument> Args,
                              QualType Canon,
@@ -4367,7 +4384,18 @@ public:
   }
   QualType desugar() const { return getCanonicalTypeInternal(); }
 
-  void Profile(llvm::FoldingSetNodeID &ID, const ASTContext &Ctx) {
+  /// \brief Retrieve the hash of this type's profile, as used to unique it
+  /// in the ASTContext. The hash is computed once and then cached.
+  unsigned getProfileHash(const ASTContext &Ctx) const {
+    if (!ProfileHash) {
+      llvm::FoldingSetNodeID ID;
+      Profile(ID, Ctx);
+      ProfileHash = ID.ComputeHash();
+    }
+    return ProfileHash;
+  }
+
+  void Profile(llvm::FoldingSetNodeID &ID, const ASTContext &Ctx) const {
     Profile(ID, Template, template_arguments(), Ctx);
     if (isTypeAlias())
       getAliasedType().Profile(ID);
@@ -6098,7 +6126,37 @@ QualType DecayedType::getPointeeType() const {
   return cast<PointerType>(Decayed)->getPointeeType();
 }
 
+/// \brief Folding set trait for types that cache the hash of their profile.
+///
+/// Candidate nodes in a bucket are rejected by comparing the cached hash
+/// before building and comparing their full profile, and growing the folding
+/// set reuses the cached hashes rather than re-profiling every node.
+template <typename T>
+struct CachedHashFoldingSetTrait
+    : llvm::DefaultContextualFoldingSetTrait<T, ASTContext &> {
+  static bool Equals(T &X, const llvm::FoldingSetNodeID &ID, unsigned IDHash,
+                     llvm::FoldingSetNodeID &TempID, ASTContext &Context) {
+    if (X.getProfileHash(Context) != IDHash)
+      return false;
+    X.Profile(TempID, Context);
+    return TempID == ID;
+  }
+  static unsigned ComputeHash(T &X, llvm::FoldingSetNodeID &TempID,
+                              ASTContext &Context) {
+    return X.getProfileHash(Context);
+  }
+};
 
 }  // end namespace clang
 
+namespace llvm {
+template <>
+struct ContextualFoldingSetTrait<clang::FunctionProtoType, clang::ASTContext &>
+    : clang::CachedHashFoldingSetTrait<clang::FunctionProtoType> {};
+template <>
+struct ContextualFoldingSetTrait<clang::TemplateSpecializationType,
+                                 clang::ASTContext &>
+    : clang::CachedHashFoldingSetTrait<clang::TemplateSpecializationType> {};
+} // end namespace llvm
+
 #endif
@@ -19,8 +19,13 @@
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/StringMap.h"
 
+#include <string>
 #include <vector>
 
+namespace llvm {
+class raw_ostream;
+}
+
 namespace clang {
 
 class Stmt;
@@ -242,8 +247,63 @@ public:
   ///                           complexity value.
   /// \param CheckPatterns Returns only clone groups in which the referenced
   ///                      variables follow the same pattern.
+  /// \param NumThreads The number of threads used to split the groups of
+  ///                   statements with the same hash code into actual clone
+  ///                   groups. The data that is compared for this is
+  ///                   collected from the AST up front on the calling thread,
+  ///                   so only the comparisons run concurrently. The result
+  ///                   does not depend on this value.
   void findClones(std::vector<CloneGroup> &Result, unsigned MinGroupComplexity,
-                  bool CheckPatterns = true);
+                  bool CheckPatterns = true, unsigned NumThreads = 1);
+
+  /// \brief The hash code and location of a StmtSequence, which, unlike the
+  ///        StmtSequence itself, remains usable after its translation unit is
+  ///        gone.
+  ///
+  /// Hash codes only depend on the structure of the statements (see
+  /// CloneSignature::Hash) so they can be compared across translation units.
+  struct SignatureRecord {
+    size_t Hash;
+    unsigned Complexity;
+    std::string File;
+    unsigned StartLine, StartColumn;
+    unsigned EndLine, EndColumn;
+
+    /// Returns true if this record covers the source range of \p Other.
+    bool contains(const SignatureRecord &Other) const;
+  };
+
+  /// \brief Writes a SignatureRecord for every stored StmtSequence with at
+  ///        least the complexity \p MinComplexity to \p OS, one per line.
+  ///
+  /// The output can be saved per translation unit and later read back with
+  /// readSignatures() to search for clones across translation units.
+  void writeSignatures(llvm::raw_ostream &OS, unsigned MinComplexity) const;
+
+  /// \brief Parses the output of writeSignatures() and appends the records to
+  ///        \p Records.
+  ///
+  /// \returns false if \p Buffer is malformed.
+  static bool readSignatures(StringRef Buffer,
+                             std::vector<SignatureRecord> &Records);
+
+  /// \brief Groups the given records, which can come from any number of
+  ///        translation units, by their hash code.
+  ///
+  /// Records for the same code that was seen by multiple translation units
+  /// (e.g. code in headers) are counted once, and groups that are covered by
+  /// a bigger group are dropped, as in findClones(). As the AST is not
+  /// available anymore, members are not compared against each other, so
+  /// unlike with findClones() a hash collision can result in a false
+  /// positive.
+  ///
+  /// \param Result Output parameter that is filled with groups of at least
+  ///               two records, each sorted by location.
+  /// \param MinGroupComplexity Only return records which have at least this
+  ///                           complexity value.
+  static void groupSignatures(std::vector<SignatureRecord> Records,
+                              unsigned MinGroupComplexity,
+                              std::vector<std::vector<SignatureRecord>> &Result);
 
   /// \brief Describes two clones that reference their variables in a different
   ///        pattern which could indicate a programming error.
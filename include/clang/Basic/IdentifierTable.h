@@ -458,6 +458,15 @@ class IdentifierTable {
 
   IdentifierInfoLookup* ExternalLookup;
 
+  /// \brief A direct-mapped cache in front of HashTable for lookups whose
+  /// hash value is already known, see getWithHash().
+  ///
+  /// A hit costs one probe and one comparison of the name, instead of hashing
+  /// the name again and probing the StringMap.
+  enum { LookupCacheSize = 1024 };
+  IdentifierInfo *LookupCache[LookupCacheSize];
+  unsigned NumLookupCacheHits, NumLookupCacheMisses;
+
 public:
   /// \brief Create the identifier table, populating it with info about the
   /// language keywords for the language specified by \p LangOpts.
@@ -504,6 +513,44 @@ public:
     return *II;
   }
 
+  /// \brief Compute the hash value of an identifier for use with
+  /// getWithHash().
+  ///
+  /// Clients that already scan the identifier (e.g. the lexer) can compute
+  /// this incrementally with updateHashValue() instead.
+  static unsigned getHashValue(StringRef Name) {
+    unsigned Hash = 0;
+    for (char C : Name)
+      Hash = updateHashValue(Hash, C);
+    return Hash;
+  }
+
+  /// \brief Add the character \p C to the hash value \p Hash of the
+  /// preceding characters of an identifier.
+  static unsigned updateHashValue(unsigned Hash, char C) {
+    return Hash * 33 + (unsigned char)C;
+  }
+
+  /// \brief Return the identifier token info for the specified named
+  /// identifier, whose getHashValue() is \p Hash.
+  ///
+  /// This returns the same IdentifierInfo as get(StringRef), but identifiers
+  /// that were looked up recently are found without hashing \p Name again.
+  IdentifierInfo &getWithHash(StringRef Name, unsigned Hash) {
+    assert(Hash == getHashValue(Name) && "Wrong hash value for identifier");
+    IdentifierInfo *&Cached = LookupCache[Hash % LookupCacheSize];
+    if (Cached && Cached->getLength() == Name.size() &&
+        memcmp(Cached->getNameStart(), Name.data(), Name.size()) == 0) {
+      ++NumLookupCacheHits;
+      return *Cached;
+    }
+
+    ++NumLookupCacheMisses;
+    IdentifierInfo &II = get(Name);
+    Cached = &II;
+    return II;
+  }
+
   IdentifierInfo &get(StringRef Name, tok::TokenKind TokenCode) {
     IdentifierInfo &II = get(Name);
     II.TokenID = TokenCode;
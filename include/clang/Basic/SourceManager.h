@@ -55,7 +55,9 @@
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -67,6 +69,55 @@ class DiagnosticsEngine;
 class LineTableInfo;
 class SourceManager;
 
+/// \brief A thread-safe pool of the contents of source files, which the
+/// SourceManagers of a process can share, e.g., those of the translation
+/// units of an index, which all read the same system headers.
+///
+/// Contents are identified by the unique ID, size and modification time of
+/// their file, and live as long as a SourceManager uses them. The offsets of
+/// their lines are computed once for all the SourceManagers.
+class SourceBufferPool {
+public:
+  /// \brief The immutable contents of a file.
+  class Contents {
+    std::unique_ptr<llvm::MemoryBuffer> Buffer;
+    mutable std::mutex LineOffsetsMutex;
+    mutable std::vector<unsigned> LineOffsets;
+
+  public:
+    explicit Contents(std::unique_ptr<llvm::MemoryBuffer> Buffer)
+        : Buffer(std::move(Buffer)) {}
+
+    llvm::MemoryBuffer *getBuffer() const { return Buffer.get(); }
+
+    /// \brief Get the offsets of the lines of the contents, computing them
+    /// the first time.
+    ArrayRef<unsigned> getLineOffsets() const;
+  };
+
+  /// \brief Get the contents of \p File, reading them with \p FileMgr if no
+  /// SourceManager holds them yet.
+  ///
+  /// \returns null if \p File is not a regular file on disk or could not be
+  /// read as described by its FileEntry, in which case it should be read as
+  /// usual.
+  std::shared_ptr<const Contents> getContents(const FileEntry *File,
+                                              FileManager &FileMgr);
+
+  /// \brief The number of files whose contents are in use.
+  unsigned getNumFiles() const;
+
+private:
+  typedef std::tuple<llvm::sys::fs::UniqueID, off_t, time_t> KeyTy;
+
+  mutable std::mutex Mutex;
+  std::map<KeyTy, std::weak_ptr<const Contents>> Entries;
+
+  /// \brief The number of entries at which to drop the ones whose contents
+  /// are no longer in use.
+  size_t NextPruneSize = 64;
+};
+
 /// \brief Public enums and private classes that are part of the
 /// SourceManager implementation.
 ///
@@ -116,11 +167,17 @@ namespace SrcMgr {
     /// with the contents of another file.
     const FileEntry *ContentsEntry;
 
+    /// \brief The contents of the file, when they are shared with other
+    /// SourceManagers through a SourceBufferPool.
+    ///
+    /// They own the buffer and the line offsets in this case.
+    mutable std::shared_ptr<const SourceBufferPool::Contents> PooledContents;
+
     /// \brief A bump pointer allocated array of offsets for each source line.
     ///
     /// This is lazily computed.  This is owned by the SourceManager
-    /// BumpPointerAllocator object.
-    unsigned *SourceLineCache;
+    /// BumpPointerAllocator object, or by the pooled contents.
+    const unsigned *SourceLineCache;
 
     /// \brief The number of lines in this ContentCache.
     ///
@@ -582,6 +639,10 @@ class SourceManager : public RefCountedBase<SourceManager> {
   /// file created from this compilation). Defaults to false.
   bool FilesAreTransient;
 
+  /// \brief The pool through which the contents of non-volatile files are
+  /// shared with other SourceManagers, if any.
+  std::shared_ptr<SourceBufferPool> BufferPool;
+
   struct OverriddenFilesInfoTy {
     /// \brief Files that have been overridden with the contents from another
     /// file.
@@ -612,6 +673,12 @@ class SourceManager : public RefCountedBase<SourceManager> {
   /// expansion.
   SmallVector<SrcMgr::SLocEntry, 0> LocalSLocEntryTable;
 
+  /// \brief The offsets of the entries in LocalSLocEntryTable.
+  ///
+  /// These are stored separately so that searching for the entry that
+  /// contains an offset touches as few cache lines as possible.
+  SmallVector<unsigned, 0> LocalSLocEntryOffsets;
+
   /// \brief The table of SLocEntries that are loaded from other modules.
   ///
   /// Negative FileIDs are indexes into this table. To get from ID to an index,
@@ -648,6 +715,16 @@ class SourceManager : public RefCountedBase<SourceManager> {
   /// is very common to look up many tokens from the same file.
   mutable FileID LastFileIDLookup;
 
+  /// \brief A small cache of the files that were looked up before
+  /// LastFileIDLookup.
+  ///
+  /// Lookups often alternate between a few files, e.g. a header and the file
+  /// that includes it, which keeps evicting the one-entry cache. Unused
+  /// entries are invalid FileIDs.
+  static const unsigned FileIDLookupCacheSize = 4;
+  mutable FileID RecentFileIDLookups[FileIDLookupCacheSize];
+  mutable unsigned NextRecentFileIDLookup;
+
   /// \brief Holds information for \#line directives.
   ///
   /// This is referenced by indices from SLocEntryTable.
@@ -667,7 +744,8 @@ class SourceManager : public RefCountedBase<SourceManager> {
   FileID PreambleFileID;
 
   // Statistics for -print-stats.
-  mutable unsigned NumLinearScans, NumBinaryProbes;
+  mutable unsigned NumLinearScans, NumBinaryProbes, NumBinarySearches;
+  mutable unsigned NumFileIDCacheHits;
 
   /// \brief Associates a FileID with its "included/expanded in" decomposed
   /// location.
@@ -737,6 +815,15 @@ public:
   /// (likely to change while trying to use them).
   bool userFilesAreVolatile() const { return UserFilesAreVolatile; }
 
+  /// \brief Share the contents of the non-volatile files that are read from
+  /// now on with the other SourceManagers that use \p Pool.
+  void setBufferPool(std::shared_ptr<SourceBufferPool> Pool) {
+    BufferPool = std::move(Pool);
+  }
+
+  /// \brief Retrieve the pool through which file contents are shared, if any.
+  SourceBufferPool *getBufferPool() const { return BufferPool.get(); }
+
   /// \brief Retrieve the module build stack.
   ModuleBuildStack getModuleBuildStack() const {
     return StoredModuleBuildStack;
@@ -1624,6 +1711,17 @@ private:
   /// \brief Return true if the specified FileID contains the
   /// specified SourceLocation offset.  This is a very hot method.
   inline bool isOffsetInFileID(FileID FID, unsigned SLocOffset) const {
+    // Local entries can be checked without touching the SLocEntries.
+    if (FID.ID >= 0) {
+      assert(unsigned(FID.ID) < LocalSLocEntryOffsets.size() &&
+             "Invalid index");
+      if (SLocOffset < LocalSLocEntryOffsets[FID.ID])
+        return false;
+      if (unsigned(FID.ID) + 1 == LocalSLocEntryOffsets.size())
+        return SLocOffset < NextLocalOffset;
+      return SLocOffset < LocalSLocEntryOffsets[FID.ID + 1];
+    }
+
     const SrcMgr::SLocEntry &Entry = getSLocEntry(FID);
     // If the entry is after the offset, it can't contain it.
     if (SLocOffset < Entry.getOffset()) return false;
@@ -1632,12 +1730,7 @@ private:
     if (FID.ID == -2)
       return true;
 
-    // If it is the last local entry, then it does if the location is local.
-    if (FID.ID+1 == static_cast<int>(LocalSLocEntryTable.size()))
-      return SLocOffset < NextLocalOffset;
-
-    // Otherwise, the entry after it has to not include it. This works for both
-    // local and loaded entries.
+    // Otherwise, the entry after it has to not include it.
     return SLocOffset < getSLocEntryByID(FID.ID+1).getOffset();
   }
 
@@ -1671,6 +1764,10 @@ private:
   FileID getFileIDLocal(unsigned SLocOffset) const;
   FileID getFileIDLoaded(unsigned SLocOffset) const;
 
+  /// \brief Make \p FID the one-entry lookup cache, moving the previous entry
+  /// into RecentFileIDLookups.
+  void setLastFileIDLookup(FileID FID) const;
+
   SourceLocation getExpansionLocSlowCase(SourceLocation Loc) const;
   SourceLocation getSpellingLocSlowCase(SourceLocation Loc) const;
   SourceLocation getFileLocSlowCase(SourceLocation Loc) const;
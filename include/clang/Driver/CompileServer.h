@@ -0,0 +1,75 @@
+//===--- CompileServer.h - Persistent -cc1 compile server -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// A compile server is a long-lived clang process (started with
+// 'clang -cc1d <socket>') that accepts -cc1 jobs over a Unix domain socket, so
+// that each compile does not pay for starting and initializing a new clang
+// process. The driver sends jobs to it when given -fcompile-server=<socket>.
+//
+// Each job is run in a process forked from the server, which isolates jobs
+// from each other and from the server while inheriting its initialized state.
+// Jobs run concurrently, in the working directory, environment and umask of
+// the driver that sent them, and are terminated if that driver goes away.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_DRIVER_COMPILESERVER_H
+#define LLVM_CLANG_DRIVER_COMPILESERVER_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+#include <string>
+
+namespace clang {
+namespace driver {
+namespace compile_server {
+
+/// \brief Whether compile servers are supported on this host, which requires
+/// a way to identify the user on the other end of a connection.
+bool isSupported();
+
+/// \brief Run a job on the compile server listening on \p SocketPath.
+///
+/// The job is run in the current working directory, environment and umask of
+/// the caller, and writes to the caller's standard output and error.
+///
+/// \param Argv The full command line of the job, starting with the
+/// executable.
+/// \param Result Set to the exit status of the job, or to a negative value if
+/// the job crashed.
+///
+/// \returns false if the job was not started by the server, e.g., because no
+/// server is running or the server refused it; in that case, \p ErrMsg
+/// describes the problem, and the caller may run the job itself.
+bool runJob(StringRef SocketPath, ArrayRef<const char *> Argv, int &Result,
+            std::string *ErrMsg = nullptr);
+
+/// \brief Function that runs a job received by the server, given its full
+/// command line, returning its exit status.
+typedef llvm::function_ref<int(ArrayRef<const char *> Argv)> JobFunc;
+
+/// \brief Listen on \p SocketPath and run the jobs received there with
+/// \p RunJob, each in its own process.
+///
+/// Only the user running the server may access the socket, and connections
+/// from other users are dropped.
+///
+/// \param MaxJobs The number of jobs to accept before returning, or 0 to
+/// serve jobs until an error occurs.
+///
+/// \returns false if the server could not be started or an error occurred
+/// while accepting jobs; in that case, \p ErrMsg describes the problem.
+bool serve(StringRef SocketPath, JobFunc RunJob, unsigned MaxJobs = 0,
+           std::string *ErrMsg = nullptr);
+
+} // end namespace compile_server
+} // end namespace driver
+} // end namespace clang
+
+#endif
@@ -201,6 +201,13 @@ public:
   /// Whether the driver is generating diagnostics for debugging purposes.
   unsigned CCGenDiagnostics : 1;
 
+  /// Type of the function that runs a -cc1 tool, given its full command line.
+  typedef int (*CC1ToolFunc)(ArrayRef<const char *> Argv);
+
+  /// If set, the function used to run -cc1 jobs within the driver process
+  /// rather than by spawning a new one (see -fintegrated-cc1).
+  CC1ToolFunc CC1Main;
+
 private:
   /// Default target triple.
   std::string DefaultTargetTriple;
@@ -115,8 +115,47 @@ public:
 
   const llvm::opt::ArgStringList &getArguments() const { return Arguments; }
 
+  const llvm::opt::ArgStringList &getInputFilenames() const {
+    return InputFilenames;
+  }
+
+  /// Replace the arguments of the command, along with the ones among them
+  /// which are inputs.
+  void replaceArguments(llvm::opt::ArgStringList NewArguments,
+                        llvm::opt::ArgStringList NewInputFilenames) {
+    Arguments = std::move(NewArguments);
+    InputFilenames = std::move(NewInputFilenames);
+  }
+
   /// Print a command argument, and optionally quote it.
   static void printArg(llvm::raw_ostream &OS, StringRef Arg, bool Quote);
+
+  /// Whether the command is run within the driver process rather than by
+  /// spawning a new one, for commands that support it.
+  bool InProcess;
+};
+
+/// Like Command, but for a -cc1 job, which can be run within the driver
+/// process.
+class CC1Command : public Command {
+public:
+  CC1Command(const Action &Source, const Tool &Creator,
+             const char *Executable, const ArgStringList &Arguments,
+             ArrayRef<InputInfo> Inputs, bool InProcess);
+
+  /// Run the command on the compile server listening on the socket
+  /// \p SocketPath, if there is one (see -fcompile-server).
+  void setCompileServer(const char *SocketPath) { CompileServer = SocketPath; }
+
+  void Print(llvm::raw_ostream &OS, const char *Terminator, bool Quote,
+             CrashReportInfo *CrashInfo = nullptr) const override;
+
+  int Execute(const StringRef **Redirects, std::string *ErrMsg,
+              bool *ExecutionFailed) const override;
+
+private:
+  /// The socket of the compile server to run the command on, if any.
+  const char *CompileServer;
 };
 
 /// Like Command, but with a fallback which is executed in case
@@ -174,6 +213,7 @@ public:
   void clear();
 
   const list_type &getJobs() const { return Jobs; }
+  list_type &getJobs() { return Jobs; }
 
   bool empty() const { return Jobs.empty(); }
   size_type size() const { return Jobs.size(); }
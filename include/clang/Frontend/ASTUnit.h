@@ -298,6 +298,10 @@ private:
   /// \brief True if non-system source files should be treated as volatile
   /// (likely to change while trying to use them).
   bool UserFilesAreVolatile : 1;
+
+  /// \brief The pool through which the source managers of this unit share
+  /// the contents of non-volatile files with other units, if any.
+  std::shared_ptr<SourceBufferPool> BufferPool;
  
   /// \brief The language options used when we load an AST file.
   LangOptions ASTFileLangOpts;
@@ -521,6 +525,18 @@ public:
 
   IntrusiveRefCntPtr<ASTReader> getASTReader() const;
 
+  /// \brief Return the amount of memory used to keep the precompiled
+  /// preamble usable across reparses, not counting the preamble AST file
+  /// itself.
+  size_t getPreambleMemory() const;
+
+  /// \brief Release the cached global code-completion results.
+  ///
+  /// The cache is rebuilt on the next reparse, if caching is enabled.
+  ///
+  /// \returns the number of bytes released.
+  size_t releaseCachedCompletionResults();
+
   StringRef getOriginalSourceFileName() {
     return OriginalSourceFile;
   }
@@ -704,10 +720,14 @@ public:
   typedef std::pair<std::string, llvm::MemoryBuffer *> RemappedFile;
 
   /// \brief Create a ASTUnit. Gets ownership of the passed CompilerInvocation.
+  ///
+  /// \param BufferPool - If non-null, the pool through which the unit shares
+  /// the contents of non-volatile files with other units.
   static std::unique_ptr<ASTUnit>
   create(std::shared_ptr<CompilerInvocation> CI,
          IntrusiveRefCntPtr<DiagnosticsEngine> Diags, bool CaptureDiagnostics,
-         bool UserFilesAreVolatile);
+         bool UserFilesAreVolatile,
+         std::shared_ptr<SourceBufferPool> BufferPool = nullptr);
 
   /// \brief Create a ASTUnit from an AST file.
   ///
@@ -718,6 +738,9 @@ public:
   /// \param Diags - The diagnostics engine to use for reporting errors; its
   /// lifetime is expected to extend past that of the returned ASTUnit.
   ///
+  /// \param BufferPool - If non-null, the pool through which the unit shares
+  /// the contents of non-volatile files with other units.
+  ///
   /// \returns - The initialized ASTUnit or null if the AST failed to load.
   static std::unique_ptr<ASTUnit> LoadFromASTFile(
       const std::string &Filename, const PCHContainerReader &PCHContainerRdr,
@@ -725,7 +748,8 @@ public:
       const FileSystemOptions &FileSystemOpts, bool UseDebugInfo = false,
       bool OnlyLocalDecls = false, ArrayRef<RemappedFile> RemappedFiles = None,
       bool CaptureDiagnostics = false, bool AllowPCHWithCompilerErrors = false,
-      bool UserFilesAreVolatile = false);
+      bool UserFilesAreVolatile = false,
+      std::shared_ptr<SourceBufferPool> BufferPool = nullptr);
 
 private:
   /// \brief Helper function for \c LoadFromCompilerInvocation() and
@@ -830,6 +854,9 @@ public:
   /// (e.g. because the PCH could not be loaded), this accepts the ASTUnit
   /// mainly to allow the caller to see the diagnostics.
   ///
+  /// \param BufferPool - If non-null, the pool through which the unit shares
+  /// the contents of non-volatile files with other units.
+  ///
   // FIXME: Move OnlyLocalDecls, UseBumpAllocator to setters on the ASTUnit, we
   // shouldn't need to specify them at construction time.
   static ASTUnit *LoadFromCommandLine(
@@ -844,9 +871,11 @@ public:
       bool CacheCodeCompletionResults = false,
       bool IncludeBriefCommentsInCodeCompletion = false,
       bool AllowPCHWithCompilerErrors = false, bool SkipFunctionBodies = false,
+      bool KeepMainFileFunctionBodies = false,
       bool UserFilesAreVolatile = false, bool ForSerialization = false,
       llvm::Optional<StringRef> ModuleFormat = llvm::None,
-      std::unique_ptr<ASTUnit> *ErrAST = nullptr);
+      std::unique_ptr<ASTUnit> *ErrAST = nullptr,
+      std::shared_ptr<SourceBufferPool> BufferPool = nullptr);
 
   /// \brief Reparse the source files using the same command-line options that
   /// were originally used to produce this translation unit.
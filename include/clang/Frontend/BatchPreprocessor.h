@@ -0,0 +1,39 @@
+//===--- BatchPreprocessor.h - Parallel preprocessing of inputs -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Batch preprocessing runs -E on many inputs in a single process. Each input
+// is preprocessed as its own translation unit, on a thread pool, and all of
+// them share a cache of the file system: the results of stat calls, including
+// the misses of header search, and the contents of the files that were read.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FRONTEND_BATCHPREPROCESSOR_H
+#define LLVM_CLANG_FRONTEND_BATCHPREPROCESSOR_H
+
+namespace clang {
+
+class CompilerInvocation;
+class DiagnosticsEngine;
+
+/// \brief Preprocess each input of \p Invocation as its own translation unit.
+///
+/// The inputs are preprocessed in parallel, using the number of threads in
+/// FrontendOptions::BatchPreprocessThreads, and written to the matching
+/// FrontendOptions::BatchOutputFiles. The diagnostics of each input, and the
+/// inputs that are written to standard output, are emitted in input order as
+/// soon as the input and all those before it are done.
+///
+/// \returns true if all inputs were preprocessed without errors.
+bool preprocessBatch(const CompilerInvocation &Invocation,
+                     DiagnosticsEngine &Diags);
+
+} // end namespace clang
+
+#endif
@@ -153,6 +153,12 @@ public:
   /// in the backend for setting the name in the skeleton cu.
   std::string SplitDwarfFile;
 
+  /// The files to write additional code generation partitions to. If not
+  /// empty, the module is split into one more partition than there are files,
+  /// the first of which is written to the main output, and code is generated
+  /// for all of them in parallel.
+  std::vector<std::string> ParallelCodeGenOutputs;
+
   /// The name of the relocation model to use.
   std::string RelocationModel;
 
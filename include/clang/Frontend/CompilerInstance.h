@@ -22,6 +22,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
 #include <cassert>
 #include <list>
 #include <memory>
@@ -172,6 +173,10 @@ class CompilerInstance : public ModuleLoader {
   /// The list of active output files.
   std::list<OutputFile> OutputFiles;
 
+  /// \brief The stream for verbose output, such as the diagnostic summary
+  /// and statistics printed by ExecuteAction.
+  raw_ostream *VerboseOutputStream = &llvm::errs();
+
   CompilerInstance(const CompilerInstance &) = delete;
   void operator=(const CompilerInstance &) = delete;
 public:
@@ -341,6 +346,15 @@ public:
     return *Diagnostics->getClient();
   }
 
+  /// Get the stream that verbose output is written to.
+  raw_ostream &getVerboseOutputStream() { return *VerboseOutputStream; }
+
+  /// Replace the stream that verbose output is written to. The stream must
+  /// outlive the compiler instance.
+  void setVerboseOutputStream(raw_ostream &Value) {
+    VerboseOutputStream = &Value;
+  }
+
   /// }
   /// @name Target Info
   /// {
@@ -0,0 +1,93 @@
+//===--- DependencyScanningFileSystem.h - Minimized sources -----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// A dependency scan preprocesses the sources of a translation unit minimized
+// to their dependency directives (see minimizeSourceToDependencyDirectives),
+// which it reads through a DependencyScanningFileSystem. The minimized sources
+// are cached in a DependencyScanningCache, which many scans can share, even
+// concurrently.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FRONTEND_DEPENDENCYSCANNINGFILESYSTEM_H
+#define LLVM_CLANG_FRONTEND_DEPENDENCYSCANNINGFILESYSTEM_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Basic/VirtualFileSystem.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <memory>
+#include <mutex>
+
+namespace clang {
+
+/// \brief A thread-safe cache of the files read by dependency scans, with
+/// the contents of the sources minimized to their dependency directives.
+///
+/// The cache assumes that the files don't change while it is in use.
+class DependencyScanningCache {
+public:
+  /// \brief A file, directory or missing path, as seen by the scans.
+  struct Entry {
+    /// \brief The status of the path. For a file with cached contents, its
+    /// size is that of the contents.
+    llvm::ErrorOr<vfs::Status> Status;
+
+    /// \brief The contents of a source file, minimized unless minimizing it
+    /// failed. Null for the other paths, which are read from the underlying
+    /// file system.
+    std::unique_ptr<llvm::MemoryBuffer> Contents;
+
+    explicit Entry(llvm::ErrorOr<vfs::Status> Status)
+        : Status(std::move(Status)) {}
+  };
+
+  /// \brief Get the entry of the absolute path \p Path, creating it with
+  /// \p FS if no other scan did yet.
+  const Entry &getEntry(StringRef Path, vfs::FileSystem &FS);
+
+  /// \brief Whether the file at \p Path is a source file, to be minimized,
+  /// rather than, e.g., a module map or a precompiled file.
+  static bool shouldMinimize(StringRef Path);
+
+private:
+  std::mutex Mutex;
+  llvm::StringMap<std::unique_ptr<Entry>> Entries;
+};
+
+/// \brief A file system that reads sources minimized to their dependency
+/// directives, through a cache shared with other scans.
+///
+/// Unlike the underlying file system, which must be thread-safe, each
+/// instance has its own working directory and is meant to be used by a
+/// single scan at a time.
+class DependencyScanningFileSystem : public vfs::FileSystem {
+public:
+  DependencyScanningFileSystem(std::shared_ptr<DependencyScanningCache> Cache,
+                               IntrusiveRefCntPtr<vfs::FileSystem> FS);
+
+  llvm::ErrorOr<vfs::Status> status(const Twine &Path) override;
+  llvm::ErrorOr<std::unique_ptr<vfs::File>>
+  openFileForRead(const Twine &Path) override;
+  vfs::directory_iterator dir_begin(const Twine &Dir,
+                                    std::error_code &EC) override;
+  std::error_code setCurrentWorkingDirectory(const Twine &Path) override;
+  llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override;
+
+private:
+  const DependencyScanningCache::Entry &getEntry(const Twine &Path);
+
+  std::shared_ptr<DependencyScanningCache> Cache;
+  IntrusiveRefCntPtr<vfs::FileSystem> FS;
+  std::string WorkingDirectory;
+};
+
+} // end namespace clang
+
+#endif
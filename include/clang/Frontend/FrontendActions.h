@@ -245,6 +245,18 @@ protected:
   void ExecuteAction() override;
 };
 
+/// \brief Preprocess the input with its sources minimized to the directives
+/// that affect its dependencies, which are written as with -M.
+///
+/// If the compiler instance has no file manager yet, the sources are read
+/// through a DependencyScanningFileSystem with a cache of its own. Otherwise,
+/// the file manager is expected to read them through one, e.g., to share a
+/// DependencyScanningCache between many scans.
+class ScanDependenciesAction : public PreprocessOnlyAction {
+protected:
+  bool BeginInvocation(CompilerInstance &CI) override;
+};
+
 class PrintPreprocessedAction : public PreprocessorFrontendAction {
 protected:
   void ExecuteAction() override;
@@ -58,7 +58,9 @@ namespace frontend {
     RewriteTest,            ///< Rewriter playground
     RunAnalysis,            ///< Run one or more source code analyses.
     MigrateSource,          ///< Run migrator.
-    RunPreprocessorOnly     ///< Just lex, no output.
+    RunPreprocessorOnly,    ///< Just lex, no output.
+    ScanDependencies        ///< Preprocess minimized sources to compute
+                            ///< dependencies.
   };
 }
 
@@ -144,6 +146,9 @@ public:
                                            /// speed up parsing in cases you do
                                            /// not need them (e.g. with code
                                            /// completion).
+  unsigned KeepMainFileFunctionBodies : 1; ///< When skipping function bodies,
+                                           /// still parse the bodies in the
+                                           /// main file.
   unsigned UseGlobalModuleIndex : 1;       ///< Whether we can use the
                                            ///< global module index if available.
   unsigned GenerateGlobalModuleIndex : 1;  ///< Whether we can generate the
@@ -158,6 +163,9 @@ public:
                                            ///< files into the PCM file.
   unsigned IncludeTimestamps : 1;          ///< Whether timestamps should be
                                            ///< written to the produced PCH file.
+  unsigned BatchPreprocess : 1;            ///< Preprocess each input as its
+                                           ///< own translation unit, in
+                                           ///< parallel.
 
   CodeCompleteOptions CodeCompleteOpts;
 
@@ -245,6 +253,19 @@ public:
   /// The list of module file extensions.
   std::vector<std::shared_ptr<ModuleFileExtension>> ModuleFileExtensions;
 
+  /// \brief If not empty, KeepMainFileFunctionBodies only keeps the bodies
+  /// that overlap one of these 1-based, inclusive line ranges of the main file.
+  std::vector<std::pair<unsigned, unsigned>> KeptFunctionBodyLines;
+
+  /// \brief With BatchPreprocess, the number of threads to use, or 0 to use
+  /// one per hardware thread.
+  unsigned BatchPreprocessThreads = 0;
+
+  /// \brief With BatchPreprocess, the output file of each input, in order.
+  /// Inputs without an entry, or whose entry is "-", are written to standard
+  /// output.
+  std::vector<std::string> BatchOutputFiles;
+
   /// \brief The list of module map files to load before processing the input.
   std::vector<std::string> ModuleMapFiles;
 
@@ -282,10 +303,11 @@ public:
     ShowStats(false), ShowTimers(false), ShowVersion(false),
     FixWhatYouCan(false), FixOnlyWarnings(false), FixAndRecompile(false),
     FixToTemporaries(false), ARCMTMigrateEmitARCErrors(false),
-    SkipFunctionBodies(false), UseGlobalModuleIndex(true),
+    SkipFunctionBodies(false), KeepMainFileFunctionBodies(false),
+    UseGlobalModuleIndex(true),
     GenerateGlobalModuleIndex(true), ASTDumpDecls(false), ASTDumpLookups(false),
     BuildingImplicitModule(false), ModulesEmbedAllFiles(false),
-    IncludeTimestamps(true), ARCMTAction(ARCMT_None),
+    IncludeTimestamps(true), BatchPreprocess(false), ARCMTAction(ARCMT_None),
     ObjCMTAction(ObjCMT_None), ProgramAction(frontend::ParseSyntaxOnly)
   {}
 
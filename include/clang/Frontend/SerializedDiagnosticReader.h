@@ -13,6 +13,7 @@
 #include "clang/Basic/LLVM.h"
 #include "llvm/Bitcode/BitstreamReader.h"
 #include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 namespace clang {
 namespace serialized_diags {
@@ -63,6 +64,11 @@ public:
   /// \brief Read the diagnostics in \c File
   std::error_code readDiagnostics(StringRef File);
 
+  /// \brief Read the diagnostics in \c Buffer.
+  ///
+  /// Strings passed to the visit* methods point into \c Buffer.
+  std::error_code readDiagnostics(llvm::MemoryBufferRef Buffer);
+
 private:
   enum class Cursor;
 
@@ -0,0 +1,154 @@
+//===--- SerializedDiagnosticTable.h - Aggregated diagnostics ---*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FRONTEND_SERIALIZED_DIAGNOSTIC_TABLE_H_
+#define LLVM_CLANG_FRONTEND_SERIALIZED_DIAGNOSTIC_TABLE_H_
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace clang {
+namespace serialized_diags {
+
+/// \brief A table of the diagnostics found in many serialized diagnostics
+/// files, e.g., all of the .dia files produced by a build.
+///
+/// Identical top-level diagnostics (same severity, location, flag and
+/// message) are stored once, along with the number of times they were seen,
+/// so that a header warning emitted by thousands of translation units is a
+/// single row. Notes attached to a diagnostic are not recorded.
+///
+/// The table is stored column by column and all strings are interned, so that
+/// aggregate queries (e.g., counting warnings per flag) only touch the
+/// columns they need.
+class SerializedDiagnosticTable {
+public:
+  SerializedDiagnosticTable();
+
+  /// \brief Add the diagnostics in the serialized diagnostics file \p File.
+  std::error_code addFile(StringRef File);
+
+  /// \brief Add the diagnostics in the serialized diagnostics \p Buffer,
+  /// recording them as coming from \p SourceName.
+  std::error_code addBuffer(llvm::MemoryBufferRef Buffer,
+                            StringRef SourceName);
+
+  /// \brief Add the diagnostics of all of the given serialized diagnostics
+  /// files, decoding up to \p NumThreads of them concurrently.
+  ///
+  /// Files are merged in the order given, so the resulting table does not
+  /// depend on \p NumThreads. Files that cannot be read are skipped.
+  ///
+  /// \param NumThreads The number of decoding threads, or 0 to use the
+  /// hardware concurrency.
+  ///
+  /// \returns the number of files that could not be read.
+  unsigned addFiles(ArrayRef<std::string> Paths, unsigned NumThreads = 0);
+
+  /// \brief The number of unique diagnostics in the table.
+  size_t size() const { return Severities.size(); }
+  bool empty() const { return Severities.empty(); }
+
+  /// \name Columns
+  /// Each column has one entry per unique diagnostic. String-valued columns
+  /// hold IDs that can be resolved with \c getString(); the ID of the empty
+  /// string (used for diagnostics without a file, flag or category) is 0.
+  /// @{
+  ArrayRef<unsigned> getSeverities() const { return Severities; }
+  ArrayRef<unsigned> getFiles() const { return Files; }
+  ArrayRef<unsigned> getLines() const { return Lines; }
+  ArrayRef<unsigned> getColumns() const { return Columns; }
+  ArrayRef<unsigned> getCategories() const { return Categories; }
+  ArrayRef<unsigned> getFlags() const { return Flags; }
+  ArrayRef<unsigned> getMessages() const { return Messages; }
+  /// The number of times each diagnostic was seen.
+  ArrayRef<unsigned> getOccurrences() const { return Occurrences; }
+  /// The source (see \c getSourceName()) that first reported each diagnostic.
+  ArrayRef<unsigned> getFirstSources() const { return FirstSources; }
+  /// @}
+
+  /// \brief Retrieve an interned string.
+  StringRef getString(unsigned ID) const { return Strings[ID]; }
+
+  /// \brief The number of sources (files or buffers) added successfully.
+  unsigned getNumSources() const { return Sources.size(); }
+
+  /// \brief Retrieve the name of the given source.
+  StringRef getSourceName(unsigned Source) const {
+    return Strings[Sources[Source]];
+  }
+
+  /// \brief The total number of diagnostics read, including duplicates.
+  uint64_t getNumDiagnosticsRead() const { return NumDiagnosticsRead; }
+
+private:
+  struct PendingDiagnostic;
+  class DiagnosticCollector;
+
+  struct DiagnosticKey {
+    unsigned Severity, File, Line, Column, Flag, Message;
+  };
+
+  struct DiagnosticKeyInfo {
+    static DiagnosticKey getEmptyKey() {
+      return {~0U, ~0U, ~0U, ~0U, ~0U, ~0U};
+    }
+    static DiagnosticKey getTombstoneKey() {
+      return {~0U - 1, ~0U, ~0U, ~0U, ~0U, ~0U};
+    }
+    static unsigned getHashValue(const DiagnosticKey &K) {
+      return llvm::hash_combine(K.Severity, K.File, K.Line, K.Column, K.Flag,
+                                K.Message);
+    }
+    static bool isEqual(const DiagnosticKey &LHS, const DiagnosticKey &RHS) {
+      return LHS.Severity == RHS.Severity && LHS.File == RHS.File &&
+             LHS.Line == RHS.Line && LHS.Column == RHS.Column &&
+             LHS.Flag == RHS.Flag && LHS.Message == RHS.Message;
+    }
+  };
+
+  /// \brief Intern \p S, returning its ID.
+  unsigned intern(StringRef S);
+
+  /// \brief Merge the diagnostics decoded from one source into the table.
+  void merge(StringRef SourceName, ArrayRef<PendingDiagnostic> Diags);
+
+  /// \brief Maps each interned string to its ID; \c Strings refers to the
+  /// keys of this map.
+  llvm::StringMap<unsigned, llvm::BumpPtrAllocator> StringIDs;
+  std::vector<StringRef> Strings;
+
+  llvm::DenseMap<DiagnosticKey, unsigned, DiagnosticKeyInfo> Rows;
+
+  std::vector<unsigned> Severities;
+  std::vector<unsigned> Files;
+  std::vector<unsigned> Lines;
+  std::vector<unsigned> Columns;
+  std::vector<unsigned> Categories;
+  std::vector<unsigned> Flags;
+  std::vector<unsigned> Messages;
+  std::vector<unsigned> Occurrences;
+  std::vector<unsigned> FirstSources;
+
+  std::vector<unsigned> Sources;
+  uint64_t NumDiagnosticsRead;
+};
+
+} // end serialized_diags namespace
+} // end clang namespace
+
+#endif
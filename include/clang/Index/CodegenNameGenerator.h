@@ -25,6 +25,9 @@ namespace clang {
 
 namespace index {
 
+/// Produces the names that declarations of an ASTContext get in generated
+/// code. Names are mangled once per declaration and cached for the lifetime
+/// of the generator.
 class CodegenNameGenerator {
 public:
   explicit CodegenNameGenerator(ASTContext &Ctx);
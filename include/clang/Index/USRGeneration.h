@@ -11,7 +11,9 @@
 #define LLVM_CLANG_INDEX_USRGENERATION_H
 
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
 
 namespace clang {
 class Decl;
@@ -29,6 +31,50 @@ static inline StringRef getUSRSpacePrefix() {
 /// \returns true if the results should be ignored, false otherwise.
 bool generateUSRForDecl(const Decl *D, SmallVectorImpl<char> &Buf);
 
+/// \brief Caches the USRs generated for the declarations of a single
+/// ASTContext.
+///
+/// Clients such as indexers ask for the USR of the same declaration at every
+/// reference to it, and the USR of every declaration starts with the USRs of
+/// its enclosing contexts. The cache keeps both, so that each declaration
+/// context is only walked once.
+class USRCache {
+public:
+  /// \brief Generate a USR for a Decl, including the USR prefix, reusing
+  /// previously generated USRs where possible.
+  /// \returns true if the results should be ignored, false otherwise.
+  bool generateUSRForDecl(const Decl *D, SmallVectorImpl<char> &Buf);
+
+  /// \brief Forget all cached USRs, e.g., because the declarations they
+  /// were generated for are about to be destroyed.
+  void clear();
+
+  /// \brief A cached USR, without the USR space prefix.
+  struct Entry {
+    StringRef USR;
+    /// Whether the USR should be ignored.
+    bool Ignore;
+    /// Whether the USR contains the location of a declaration.
+    bool HasLocation;
+    /// Whether the USR contains type substitutions, which prevents its
+    /// reuse as the prefix of another USR.
+    bool HasSubstitutions;
+  };
+
+  /// \brief Retrieve the cached USR for \p D, if any.
+  const Entry *lookup(const Decl *D) const {
+    auto Known = Entries.find(D);
+    return Known == Entries.end() ? nullptr : &Known->second;
+  }
+
+  /// \brief Cache the USR for \p D.
+  void insert(const Decl *D, const Entry &E);
+
+private:
+  llvm::DenseMap<const Decl *, Entry> Entries;
+  llvm::BumpPtrAllocator Alloc;
+};
+
 /// \brief Generate a USR fragment for an Objective-C class.
 void generateUSRForObjCClass(StringRef Cls, raw_ostream &OS);
 
@@ -0,0 +1,43 @@
+//===--- DependencyDirectivesSourceMinimizer.h - Minimize sources -*- C++ -*-=//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines minimizeSourceToDependencyDirectives, which reduces a
+// source file to the preprocessor directives that can affect what it
+// includes or imports, so that the dependencies of a translation unit can be
+// computed without lexing and macro-expanding all of its code.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_DEPENDENCYDIRECTIVESSOURCEMINIMIZER_H
+#define LLVM_CLANG_LEX_DEPENDENCYDIRECTIVESSOURCEMINIMIZER_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace clang {
+
+/// \brief Minimize \p Input to the preprocessor directives that may affect
+/// the files it includes or the modules it imports.
+///
+/// The output has one directive per line, with comments removed and line
+/// splices joined. It keeps \#define, \#undef, \#include, \#include_next,
+/// \#import, \#__include_macros and the conditional directives, the pragmas
+/// that affect inclusion (once, push_macro, pop_macro, include_alias,
+/// GCC system_header and clang module import) and \@import declarations.
+/// Everything else is dropped, so line numbers are not preserved.
+///
+/// \returns true if \p Input could not be minimized, in which case it should
+/// be used as is.
+bool minimizeSourceToDependencyDirectives(StringRef Input,
+                                          SmallVectorImpl<char> &Output);
+
+} // end namespace clang
+
+#endif
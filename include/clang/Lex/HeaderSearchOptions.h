@@ -173,6 +173,16 @@ public:
   /// \brief Whether to validate system input files when a module is loaded.
   unsigned ModulesValidateSystemHeaders : 1;
 
+  /// \brief Whether module files should store the contents of the files they
+  /// embed in a content-addressed store within the module cache, so that
+  /// the files embedded by many modules are stored and mapped only once.
+  unsigned ModulesContentStore : 1;
+
+  /// \brief Whether AST files should record a hash of the contents of their
+  /// input files, and input files whose modification time changed should be
+  /// considered up to date when their contents still match that hash.
+  unsigned ValidateASTInputFilesContent : 1;
+
   /// Whether the module includes debug information (-gmodules).
   unsigned UseDebugInfo : 1;
 
@@ -186,8 +196,9 @@ public:
         UseBuiltinIncludes(true), UseStandardSystemIncludes(true),
         UseStandardCXXIncludes(true), UseLibcxx(false), Verbose(false),
         ModulesValidateOncePerBuildSession(false),
-        ModulesValidateSystemHeaders(false),
-        UseDebugInfo(false), ModulesValidateDiagnosticOptions(true) {}
+        ModulesValidateSystemHeaders(false), ModulesContentStore(false),
+        ValidateASTInputFilesContent(false), UseDebugInfo(false),
+        ModulesValidateDiagnosticOptions(true) {}
 
   /// AddPath - Add the \p Path path to the specified \p Group list.
   void AddPath(StringRef Path, frontend::IncludeDirGroup Group,
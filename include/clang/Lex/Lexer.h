@@ -207,6 +207,22 @@ public:
   /// uninterpreted string.  This switches the lexer out of directive mode.
   void ReadToEndOfLine(SmallVectorImpl<char> *Result = nullptr);
 
+  /// \brief Skip the rest of a brace-enclosed block of the current buffer
+  /// without forming tokens, then lex the '}' that closes it into \p Result.
+  ///
+  /// This only matches braces, skipping comments and literals, so it is much
+  /// faster than lexing the block. Comments are still reported to the
+  /// preprocessor's comment handlers.
+  ///
+  /// \param Depth The brace nesting depth at the current position; the block
+  /// ends at the '}' that brings it to zero.
+  ///
+  /// \returns false, without consuming anything, if the block might need the
+  /// preprocessor or the full lexer: a directive, an identifier that is a
+  /// macro or needs other special handling, a line splice, a raw string
+  /// literal, a trigraph, a non-ASCII character, or the end of the buffer.
+  bool SkipBalancedBraces(unsigned Depth, Token &Result);
+
 
   /// Diag - Forwarding function for diagnostics.  This translate a source
   /// position in the current buffer into a SourceLocation object for rendering.
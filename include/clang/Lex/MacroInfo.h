@@ -52,7 +52,13 @@ class MacroInfo {
   unsigned NumArguments;
 
   /// \brief This is the list of tokens that the macro is defined to.
-  SmallVector<Token, 8> ReplacementTokens;
+  ///
+  /// ReplacementTokens points to the first of NumReplacementTokens tokens,
+  /// which are allocated in the preprocessor's allocator.
+  Token *ReplacementTokens;
+
+  /// \see ReplacementTokens
+  unsigned NumReplacementTokens;
 
   /// \brief Length in characters of the macro definition.
   mutable unsigned DefinitionLength;
@@ -228,25 +234,40 @@ public:
 
   /// \brief Return the number of tokens that this macro expands to.
   ///
-  unsigned getNumTokens() const { return ReplacementTokens.size(); }
+  unsigned getNumTokens() const { return NumReplacementTokens; }
 
   const Token &getReplacementToken(unsigned Tok) const {
-    assert(Tok < ReplacementTokens.size() && "Invalid token #");
+    assert(Tok < NumReplacementTokens && "Invalid token #");
     return ReplacementTokens[Tok];
   }
 
-  typedef SmallVectorImpl<Token>::const_iterator tokens_iterator;
-  tokens_iterator tokens_begin() const { return ReplacementTokens.begin(); }
-  tokens_iterator tokens_end() const { return ReplacementTokens.end(); }
-  bool tokens_empty() const { return ReplacementTokens.empty(); }
-  ArrayRef<Token> tokens() const { return ReplacementTokens; }
+  typedef const Token *tokens_iterator;
+  tokens_iterator tokens_begin() const { return ReplacementTokens; }
+  tokens_iterator tokens_end() const {
+    return ReplacementTokens + NumReplacementTokens;
+  }
+  bool tokens_empty() const { return NumReplacementTokens == 0; }
+  ArrayRef<Token> tokens() const {
+    return llvm::makeArrayRef(ReplacementTokens, NumReplacementTokens);
+  }
 
-  /// \brief Add the specified token to the replacement text for the macro.
-  void AddTokenToBody(const Token &Tok) {
+  /// \brief Set the replacement text for the macro.
+  ///
+  /// The tokens are copied into storage owned by \p PPAllocator, so that the
+  /// MacroInfo itself stays small and the tokens of all macros are allocated
+  /// contiguously rather than in a heap allocation per macro.
+  void setTokens(ArrayRef<Token> Tokens, llvm::BumpPtrAllocator &PPAllocator) {
     assert(
         !IsDefinitionLengthCached &&
         "Changing replacement tokens after definition length got calculated");
-    ReplacementTokens.push_back(Tok);
+    assert(ReplacementTokens == nullptr && NumReplacementTokens == 0 &&
+           "Replacement tokens already set!");
+    if (Tokens.empty())
+      return;
+
+    NumReplacementTokens = Tokens.size();
+    ReplacementTokens = PPAllocator.Allocate<Token>(Tokens.size());
+    std::copy(Tokens.begin(), Tokens.end(), ReplacementTokens);
   }
 
   /// \brief Return true if this macro is enabled.
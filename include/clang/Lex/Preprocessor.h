@@ -630,22 +630,13 @@ class Preprocessor {
   /// invoked (at which point the last position is popped).
   std::vector<CachedTokensTy::size_type> BacktrackPositions;
 
-  struct MacroInfoChain {
-    MacroInfo MI;
-    MacroInfoChain *Next;
-  };
-
-  /// MacroInfos are managed as a chain for easy disposal.  This is the head
-  /// of that list.
-  MacroInfoChain *MIChainHead;
-
-  struct DeserializedMacroInfoChain {
+  // MacroInfos and their replacement tokens live in BP and are trivially
+  // destructible, so they are released along with it.
+  struct DeserializedMacroInfo {
     MacroInfo MI;
     unsigned OwningModuleID; // MUST be immediately after the MacroInfo object
                      // so it can be accessed by MacroInfo::getOwningModuleID().
-    DeserializedMacroInfoChain *Next;
   };
-  DeserializedMacroInfoChain *DeserialMIChainHead;
 
   void updateOutOfDateIdentifier(IdentifierInfo &II) const;
 
@@ -1106,6 +1097,22 @@ public:
   /// \brief Lex the next token for this preprocessor.
   void Lex(Token &Result);
 
+  /// \brief Skip the rest of a brace-enclosed block without forming tokens,
+  /// then lex the '}' that closes it into \p Result.
+  ///
+  /// \param Depth The brace nesting depth after the last lexed token.
+  ///
+  /// \returns false, without consuming anything, if the block has to be
+  /// lexed normally, e.g. because it contains macros or directives, or
+  /// because the next token does not come directly from a file.
+  bool SkipBalancedBraces(unsigned Depth, Token &Result) {
+    if (CurLexerKind != CLK_Lexer ||
+        !CurLexer->SkipBalancedBraces(Depth, Result))
+      return false;
+    LastTokenWasAt = false;
+    return true;
+  }
+
   void LexAfterModuleImport(Token &Result);
 
   void makeModuleVisible(Module *M, SourceLocation Loc);
@@ -1559,6 +1566,12 @@ public:
   /// updating the token kind accordingly.
   IdentifierInfo *LookUpIdentifierInfo(Token &Identifier) const;
 
+  /// \brief Like LookUpIdentifierInfo(Token &), for a lexer that computed the
+  /// IdentifierTable::getHashValue() of the raw identifier while scanning it.
+  ///
+  /// \p Hash is ignored if the token needs cleaning.
+  IdentifierInfo *LookUpIdentifierInfo(Token &Identifier, unsigned Hash) const;
+
 private:
   llvm::DenseMap<IdentifierInfo*,unsigned> PoisonReasons;
 
@@ -13,6 +13,7 @@
 #include "clang/Basic/LLVM.h"
 #include "clang/Rewrite/Core/DeltaTree.h"
 #include "clang/Rewrite/Core/RewriteRope.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 
 namespace clang {
@@ -30,6 +31,8 @@ class RewriteBuffer {
   /// and deletions.
   DeltaTree Deltas;
   RewriteRope Buffer;
+  /// HasEdits - Whether any change has been made to the original input.
+  bool HasEdits = false;
 public:
   typedef RewriteRope::const_iterator iterator;
   iterator begin() const { return Buffer.begin(); }
@@ -87,8 +90,33 @@ public:
   void ReplaceText(unsigned OrigOffset, unsigned OrigLength,
                    StringRef NewStr);
 
+  /// \brief A single change to the buffer, for use with \c applyEdits().
+  struct Edit {
+    enum EditKind { InsertBefore, InsertAfter, Replace };
+    EditKind Kind;
+    /// The offset of the change, relative to the original SourceBuffer.
+    unsigned OrigOffset;
+    /// The number of original characters replaced; ignored for insertions.
+    unsigned OrigLength;
+    StringRef Text;
+  };
+
+  /// \brief Apply all of \p Edits, with the same result as calling
+  /// InsertTextBefore(), InsertTextAfter() or ReplaceText() for each of them
+  /// in order.
+  ///
+  /// If this buffer has not been changed yet and no edit falls within text
+  /// removed by another, the edits are sorted and the new contents are built
+  /// in a single pass over the original input, instead of splitting the rope
+  /// and updating the deltas once per edit.
+  void applyEdits(ArrayRef<Edit> Edits);
+
 private:  // Methods only usable by Rewriter.
 
+  /// applyEditsInOnePass - Implement applyEdits() by rebuilding the buffer,
+  /// returning false without changing anything if that is not possible.
+  bool applyEditsInOnePass(ArrayRef<Edit> Edits);
+
   /// getMappedOffset - Given an offset into the original SourceBuffer that this
   /// RewriteBuffer is based on, map it into the offset space of the
   /// RewriteBuffer.  If AfterInserts is true and if the OrigOffset indicates a
@@ -97,6 +97,10 @@ namespace clang {
   public:
     // begin iterator.
     RopePieceBTreeIterator(const void /*RopePieceBTreeNode*/ *N);
+    // iterator to the byte at Offset, or end iterator if Offset is the size of
+    // the tree.
+    RopePieceBTreeIterator(const void /*RopePieceBTreeNode*/ *N,
+                           unsigned Offset);
     // end iterator
     RopePieceBTreeIterator()
       : CurNode(nullptr), CurPiece(nullptr), CurChar(0) {}
@@ -123,8 +127,10 @@ namespace clang {
       RopePieceBTreeIterator tmp = *this; ++*this; return tmp;
     }
 
+    /// piece - Return the rest of the current RopePiece, starting at the
+    /// current byte.
     llvm::StringRef piece() const {
-      return llvm::StringRef(&(*CurPiece)[0], CurPiece->size());
+      return llvm::StringRef(&(*CurPiece)[CurChar], CurPiece->size()-CurChar);
     }
 
     void MoveToNextPiece();
@@ -145,6 +151,9 @@ namespace clang {
     typedef RopePieceBTreeIterator iterator;
     iterator begin() const { return iterator(Root); }
     iterator end() const { return iterator(); }
+    /// seek - Return an iterator to the byte at the specified offset, which is
+    /// found by descending the tree rather than by walking the leaves.
+    iterator seek(unsigned Offset) const { return iterator(Root, Offset); }
     unsigned size() const;
     unsigned empty() const { return size() == 0; }
 
@@ -181,6 +190,7 @@ public:
   typedef RopePieceBTree::iterator const_iterator;
   iterator begin() const { return Chunks.begin(); }
   iterator end() const  { return Chunks.end(); }
+  iterator seek(unsigned Offset) const { return Chunks.seek(Offset); }
   unsigned size() const { return Chunks.size(); }
 
   void clear() {
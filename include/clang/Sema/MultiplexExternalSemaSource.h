@@ -189,6 +189,8 @@ public:
   /// by heap-backed versus mmap'ed memory.
   void getMemoryBufferSizes(MemoryBufferSizes &sizes) const override;
 
+  size_t getDataStructureSizes() const override;
+
   //===--------------------------------------------------------------------===//
   // ExternalSemaSource.
   //===--------------------------------------------------------------------===//
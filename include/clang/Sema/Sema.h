@@ -1106,6 +1106,10 @@ public:
 
   void PrintStats() const;
 
+  /// \brief Return the amount of memory used by Sema's allocator and its
+  /// largest side tables.
+  size_t getTotalMemory() const;
+
   /// \brief Helper class that creates diagnostics with optional
   /// template instantiation stacks.
   ///
@@ -1874,6 +1878,22 @@ public:
   /// \c constexpr in C++11 or has an 'auto' return type in C++14).
   bool canSkipFunctionBody(Decl *D);
 
+  /// \brief When function bodies are skipped, whether the bodies of functions
+  /// in the main file are parsed anyway.
+  bool KeepMainFileFunctionBodies;
+
+  /// \brief If not empty, KeepMainFileFunctionBodies only keeps the bodies
+  /// that overlap one of these 1-based, inclusive line ranges of the main file.
+  SmallVector<std::pair<unsigned, unsigned>, 2> KeptFunctionBodyLines;
+
+  /// \brief Determine whether a skippable function body starting at \p Loc
+  /// may have to be parsed anyway, because of KeepMainFileFunctionBodies.
+  bool mayKeepFunctionBody(SourceLocation Loc);
+
+  /// \brief Determine whether the skippable function body spanning \p Body
+  /// has to be parsed anyway, because of KeepMainFileFunctionBodies.
+  bool isKeptFunctionBody(SourceRange Body);
+
   void computeNRVO(Stmt *Body, sema::FunctionScopeInfo *Scope);
   Decl *ActOnFinishFunctionBody(Decl *Decl, Stmt *Body);
   Decl *ActOnFinishFunctionBody(Decl *Decl, Stmt *Body, bool IsInstantiation);
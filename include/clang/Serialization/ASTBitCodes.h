@@ -46,7 +46,7 @@ namespace clang {
     /// for the previous version could still support reading the new
     /// version by ignoring new kinds of subblocks), this number
     /// should be increased.
-    const unsigned VERSION_MINOR = 0;
+    const unsigned VERSION_MINOR = 3;
 
     /// \brief An ID number that refers to an identifier in an AST file.
     /// 
@@ -293,6 +293,11 @@ namespace clang {
 
       /// \brief Record code for the module build directory.
       MODULE_DIRECTORY,
+
+      /// \brief Record code for a file of the content store that holds the
+      /// contents of embedded files, along with the size and hash of those
+      /// contents.
+      CONTENT_STORE_FILE,
     };
 
     /// \brief Record types that occur within the options block inside
@@ -335,7 +340,11 @@ namespace clang {
     /// inside the control block.
     enum InputFileRecordTypes {
       /// \brief An input file.
-      INPUT_FILE = 1
+      INPUT_FILE = 1,
+
+      /// \brief The hash of the contents of the input file described by the
+      /// preceding INPUT_FILE record, or zero if it was not computed.
+      INPUT_FILE_HASH
     };
 
     /// \brief Record types that occur within the AST block itself.
@@ -593,6 +602,14 @@ namespace clang {
       OPENCL_EXTENSION_DECLS = 59,
 
       MODULAR_CODEGEN_DECLS = 60,
+
+      /// \brief Record code for the Bloom filter over the identifiers in the
+      /// identifier table.
+      ///
+      /// The record holds the base-2 logarithm of the number of bits in the
+      /// filter; the blob holds the filter itself. Readers use it to skip
+      /// AST files whose identifier table cannot contain a given identifier.
+      IDENTIFIER_FILTER = 61,
     };
 
     /// \brief Record types used within a source manager block.
@@ -613,7 +630,11 @@ namespace clang {
       SM_SLOC_BUFFER_BLOB_COMPRESSED = 4,
       /// \brief Describes a source location entry (SLocEntry) for a
       /// macro expansion.
-      SM_SLOC_EXPANSION_ENTRY = 5
+      SM_SLOC_EXPANSION_ENTRY = 5,
+      /// \brief Describes the data for a buffer entry that is stored outside
+      /// of the AST file, in a file of a content-addressed store that is
+      /// shared by many AST files.
+      SM_SLOC_BUFFER_BLOB_REF = 6
     };
 
     /// \brief Record types used within a preprocessor block.
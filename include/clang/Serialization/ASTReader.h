@@ -37,6 +37,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/Support/DataTypes.h"
 #include "llvm/Support/Timer.h"
@@ -866,6 +867,16 @@ private:
   /// \brief Whether validate system input files.
   bool ValidateSystemInputs;
 
+  /// \brief The hashes of the contents of the input files that were read to
+  /// validate them against the hashes stored in AST files, shared by all the
+  /// AST files that have the same input files.
+  llvm::DenseMap<const FileEntry *, uint64_t> InputFileContentHashes;
+
+  /// \brief The files of the content store that were found to hold the
+  /// contents that AST files expect of them, so that AST files that share
+  /// them do not read them again.
+  llvm::StringSet<> ValidatedContentStoreFiles;
+
   /// \brief Whether we are allowed to use the global module index.
   bool UseGlobalIndex;
 
@@ -911,6 +922,10 @@ private:
   /// \brief The number of lookups into identifier tables that succeed.
   unsigned NumIdentifierLookupHits = 0;
 
+  /// \brief The number of identifier table lookups that were avoided because
+  /// the table's identifier filter ruled the identifier out.
+  unsigned NumIdentifierLookupsFiltered = 0;
+
   /// \brief The number of selectors that have been read.
   unsigned NumSelectorsRead = 0;
 
@@ -1110,6 +1125,8 @@ private:
     time_t StoredTime;
     bool Overridden;
     bool Transient;
+    /// \brief The hash of the file's contents, or zero if it is not known.
+    uint64_t ContentHash;
   };
 
   /// \brief Reads the stored information about an input file.
@@ -1825,6 +1842,10 @@ public:
   /// by heap-backed versus mmap'ed memory.
   void getMemoryBufferSizes(MemoryBufferSizes &sizes) const override;
 
+  /// Return the amount of memory used by the tables mapping global IDs to
+  /// loaded types, declarations, identifiers, macros and selectors.
+  size_t getDataStructureSizes() const override;
+
   /// \brief Initialize the semantic source with the Sema instance
   /// being used to perform semantic analysis on the abstract syntax
   /// tree.
@@ -142,6 +142,10 @@ private:
   /// offset table where information about that input file is stored.
   llvm::DenseMap<const FileEntry *, uint32_t> InputFileIDs;
 
+  /// \brief Mapping from embedded file entries to the file of the content
+  /// store that holds their contents.
+  llvm::DenseMap<const FileEntry *, std::string> ContentStoreFiles;
+
   /// \brief Stores a declaration or a type to be written to the AST file.
   class DeclOrType {
   public:
@@ -277,6 +277,15 @@ public:
   /// IdentifierHashTable.
   void *IdentifierLookupTable = nullptr;
 
+  /// \brief A Bloom filter over the identifiers in IdentifierLookupTable, or
+  /// null if the file doesn't have one.
+  ///
+  /// This pointer points into a memory buffer.
+  const unsigned char *IdentifierFilter = nullptr;
+
+  /// \brief The base-2 logarithm of the number of bits in IdentifierFilter.
+  unsigned IdentifierFilterLog2Bits = 0;
+
   /// \brief Offsets of identifiers that we're going to preload within
   /// IdentifierTableData.
   std::vector<unsigned> PreloadIdentifierOffsets;
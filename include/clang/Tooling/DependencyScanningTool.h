@@ -0,0 +1,62 @@
+//===--- DependencyScanningTool.h - Scan dependencies of a TU ---*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLING_DEPENDENCYSCANNINGTOOL_H
+#define LLVM_CLANG_TOOLING_DEPENDENCYSCANNINGTOOL_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Basic/VirtualFileSystem.h"
+#include "clang/Frontend/DependencyScanningFileSystem.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace clang {
+
+class DiagnosticConsumer;
+
+namespace tooling {
+
+/// \brief Computes the dependencies of translation units from their compile
+/// commands, by preprocessing their sources minimized to their dependency
+/// directives.
+///
+/// A build system scanning many translation units creates one tool per
+/// thread, all sharing the same DependencyScanningCache, so that each file is
+/// read and minimized only once.
+class DependencyScanningTool {
+public:
+  explicit DependencyScanningTool(
+      std::shared_ptr<DependencyScanningCache> Cache,
+      IntrusiveRefCntPtr<vfs::FileSystem> FS = vfs::getRealFileSystem());
+
+  /// \brief Compute the dependencies of the translation unit compiled by
+  /// \p CommandLine, a driver command line whose first argument is the
+  /// program name, run from \p WorkingDirectory.
+  ///
+  /// \param Dependencies Set to the dependencies, as a Makefile rule like the
+  /// ones written with -M.
+  ///
+  /// \param DiagConsumer The consumer of the diagnostics, or null to print
+  /// them to stderr.
+  ///
+  /// \returns true on success.
+  bool computeDependencies(const std::vector<std::string> &CommandLine,
+                           StringRef WorkingDirectory,
+                           std::string &Dependencies,
+                           DiagnosticConsumer *DiagConsumer = nullptr);
+
+private:
+  IntrusiveRefCntPtr<DependencyScanningFileSystem> FS;
+};
+
+} // end namespace tooling
+} // end namespace clang
+
+#endif // LLVM_CLANG_TOOLING_DEPENDENCYSCANNINGTOOL_H
@@ -26,6 +26,7 @@
 
 namespace clang {
 
+class FileManager;
 class Rewriter;
 
 namespace tooling {
@@ -94,6 +95,28 @@ bool formatAndApplyAllReplacements(
     const std::map<std::string, Replacements> &FileToReplaces,
     Rewriter &Rewrite, StringRef Style = "file");
 
+/// \brief Apply all replacements in \p FileToReplaces and write the changed
+/// files back to disk, without going through a \c Rewriter.
+///
+/// FileToReplaces will be deduplicated with `groupReplacementsByFile` before
+/// application. Each file is read once through the virtual file system of
+/// \p Files, its (sorted) replacements are applied in a single pass over its
+/// contents, and the result is written back in one go. This scales to
+/// codemods with millions of replacements, where applying them one by one to
+/// a \c RewriteBuffer dominates.
+///
+/// \param Style If non-empty, the replacements of each file are formatted
+/// with this style (see `format::getStyle`) before being applied.
+///
+/// \param NumThreads Files are independent of each other, so they are
+/// processed on up to this many threads; 0 means the hardware concurrency.
+///
+/// \returns true if all replacements were applied and all changed files were
+/// saved. false otherwise.
+bool applyAllReplacementsAndSave(
+    const std::map<std::string, Replacements> &FileToReplaces,
+    FileManager &Files, StringRef Style = "", unsigned NumThreads = 0);
+
 } // end namespace tooling
 } // end namespace clang
 
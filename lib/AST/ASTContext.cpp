@@ -55,6 +55,10 @@ unsigned ASTContext::NumImplicitMoveAssignmentOperators;
 unsigned ASTContext::NumImplicitMoveAssignmentOperatorsDeclared;
 unsigned ASTContext::NumImplicitDestructors;
 unsigned ASTContext::NumImplicitDestructorsDeclared;
+unsigned ASTContext::NumFunctionProtoTypeLookups;
+unsigned ASTContext::NumFunctionProtoTypeHits;
+unsigned ASTContext::NumTemplateSpecializationTypeLookups;
+unsigned ASTContext::NumTemplateSpecializationTypeHits;
 
 enum FloatingRank {
   HalfRank, FloatRank, DoubleRank, LongDoubleRank, Float128Rank
@@ -874,6 +878,55 @@ void ASTContext::PrintStats() const {
                << NumImplicitDestructors
                << " implicit destructors created\n";
 
+  // Type uniquing.
+  llvm::errs() << NumFunctionProtoTypeHits << "/"
+               << NumFunctionProtoTypeLookups
+               << " function prototype type lookups found an existing type\n";
+  if (getLangOpts().CPlusPlus)
+    llvm::errs() << NumTemplateSpecializationTypeHits << "/"
+                 << NumTemplateSpecializationTypeLookups
+                 << " template specialization type lookups found an existing "
+                    "type\n";
+
+  // DeclContext lookup tables, by the kind of context that owns them.
+  static const char *const DeclKindNames[] = {
+#define DECL(DERIVED, BASE) #DERIVED,
+#define ABSTRACT_DECL(DECL)
+#include "clang/AST/DeclNodes.inc"
+  };
+  struct LookupTableStats {
+    unsigned Tables = 0, Inline = 0, Entries = 0;
+    size_t Bytes = 0;
+
+    void add(const StoredDeclsMap &Map) {
+      ++Tables;
+      Entries += Map.size();
+      Bytes += sizeof(StoredDeclsMap);
+      if (Map.usesInlineStorage())
+        ++Inline;
+      else
+        Bytes += Map.getMemorySize();
+    }
+  } LookupStats[llvm::array_lengthof(DeclKindNames)], LookupTotal;
+
+  for (StoredDeclsMap *Map = LastSDM.getPointer(); Map;
+       Map = Map->Previous.getPointer()) {
+    LookupStats[Map->OwnerKind].add(*Map);
+    LookupTotal.add(*Map);
+  }
+
+  llvm::errs() << LookupTotal.Tables << " lookup tables ("
+               << LookupTotal.Inline << " inline, " << LookupTotal.Entries
+               << " entries, " << LookupTotal.Bytes << " bytes)\n";
+  for (unsigned I = 0; I != llvm::array_lengthof(DeclKindNames); ++I) {
+    const LookupTableStats &Stats = LookupStats[I];
+    if (Stats.Tables)
+      llvm::errs() << "    " << Stats.Tables << " " << DeclKindNames[I]
+                   << " lookup tables (" << Stats.Inline << " inline, "
+                   << Stats.Entries << " entries, " << Stats.Bytes
+                   << " bytes)\n";
+  }
+
   if (ExternalSource) {
     llvm::errs() << "\n";
     ExternalSource->PrintStats();
@@ -3199,8 +3252,10 @@ QualType ASTContext::getFunctionTypeInternal(
   bool Unique = false;
 
   void *InsertPos = nullptr;
+  ++NumFunctionProtoTypeLookups;
   if (FunctionProtoType *FPT =
         FunctionProtoTypes.FindNodeOrInsertPos(ID, InsertPos)) {
+    ++NumFunctionProtoTypeHits;
     QualType Existing = QualType(FPT, 0);
 
     // If we find a pre-existing equivalent FunctionProtoType, we can just reuse
@@ -3709,10 +3764,13 @@ QualType ASTContext::getCanonicalTemplateSpecializationType(
                                       CanonArgs, *this);
 
   void *InsertPos = nullptr;
+  ++NumTemplateSpecializationTypeLookups;
   TemplateSpecializationType *Spec
     = TemplateSpecializationTypes.FindNodeOrInsertPos(ID, InsertPos);
 
-  if (!Spec) {
+  if (Spec) {
+    ++NumTemplateSpecializationTypeHits;
+  } else {
     // Allocate a new canonical template specialization type.
     void *Mem = Allocate((sizeof(TemplateSpecializationType) +
                           sizeof(TemplateArgument) * NumArgs),
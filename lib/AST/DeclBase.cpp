@@ -30,6 +30,7 @@
 #include "clang/Basic/TargetInfo.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <iterator>
 using namespace clang;
 
 //===----------------------------------------------------------------------===//
@@ -1410,6 +1411,19 @@ StoredDeclsMap *DeclContext::buildLookup() {
       return LookupPtr;
   }
 
+  // When building the table from scratch, size it for all of the
+  // declarations up front instead of rehashing repeatedly as it grows, which
+  // matters for namespaces with tens of thousands of declarations. Small
+  // contexts stay within the map's inline buckets.
+  if (!LookupPtr) {
+    unsigned NumDecls = 0;
+    for (auto *DC : Contexts)
+      NumDecls += std::distance(DC->noload_decls_begin(),
+                                DC->noload_decls_end());
+    if (NumDecls > 4)
+      CreateStoredDeclsMap(getParentASTContext())->reserve(NumDecls);
+  }
+
   for (auto *DC : Contexts)
     buildLookupImpl(DC, hasExternalVisibleStorage());
 
@@ -1754,6 +1768,7 @@ StoredDeclsMap *DeclContext::CreateStoredDeclsMap(ASTContext &C) const {
     M = new DependentStoredDeclsMap();
   else
     M = new StoredDeclsMap();
+  M->OwnerKind = getDeclKind();
   M->Previous = C.LastSDM;
   C.LastSDM = llvm::PointerIntPair<StoredDeclsMap*,1>(M, Dependent);
   LookupPtr = M;
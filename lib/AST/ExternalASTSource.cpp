@@ -116,6 +116,8 @@ void ExternalASTSource::FindExternalLexicalDecls(
 
 void ExternalASTSource::getMemoryBufferSizes(MemoryBufferSizes &sizes) const {}
 
+size_t ExternalASTSource::getDataStructureSizes() const { return 0; }
+
 uint32_t ExternalASTSource::incrementGeneration(ASTContext &C) {
   uint32_t OldGeneration = CurrentGeneration;
 
@@ -2709,7 +2709,8 @@ FunctionProtoType::FunctionProtoType(QualType result, ArrayRef<QualType> params,
       NumExceptions(epi.ExceptionSpec.Exceptions.size()),
       ExceptionSpecType(epi.ExceptionSpec.Type),
       HasExtParameterInfos(epi.ExtParameterInfos != nullptr),
-      Variadic(epi.Variadic), HasTrailingReturn(epi.HasTrailingReturn) {
+      Variadic(epi.Variadic), HasTrailingReturn(epi.HasTrailingReturn),
+      ProfileHash(0) {
   assert(NumParams == params.size() && "function has too many parameters");
 
   FunctionTypeBits.TypeQuals = epi.TypeQuals;
@@ -2929,7 +2930,7 @@ void FunctionProtoType::Profile(llvm::FoldingSetNodeID &ID, QualType Result,
 }
 
 void FunctionProtoType::Profile(llvm::FoldingSetNodeID &ID,
-                                const ASTContext &Ctx) {
+                                const ASTContext &Ctx) const {
   Profile(ID, getReturnType(), param_type_begin(), NumParams, getExtProtoInfo(),
           Ctx, isCanonicalUnqualified());
 }
@@ -3199,7 +3200,8 @@ TemplateSpecializationType(TemplateName T,
          Canon.isNull()? true : Canon->isInstantiationDependentType(),
          false,
          T.containsUnexpandedParameterPack()),
-    Template(T), NumArgs(Args.size()), TypeAlias(!AliasedType.isNull()) {
+    Template(T), NumArgs(Args.size()), TypeAlias(!AliasedType.isNull()),
+    ProfileHash(0) {
   assert(!T.getAsDependentTemplateName() && 
          "Use DependentTemplateSpecializationType for dependent template-name");
   assert((T.getKind() == TemplateName::Template ||
@@ -19,7 +19,9 @@
 #include "clang/AST/StmtVisitor.h"
 #include "clang/Lex/Lexer.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/MD5.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
@@ -676,50 +678,43 @@ static void CollectStmtSequenceData(const StmtSequence &Sequence,
   }
 }
 
-/// \brief Returns true if both sequences are clones of each other.
-static bool areSequencesClones(const StmtSequence &LHS,
-                               const StmtSequence &RHS) {
-  // We collect the data from all statements in the sequence as we did before
-  // when generating a hash value for each sequence. But this time we don't
-  // hash the collected data and compare the whole data set instead. This
-  // prevents any false-positives due to hash code collisions.
-  llvm::FoldingSetNodeID DataLHS, DataRHS;
-  FoldingSetNodeIDWrapper LHSWrapper(DataLHS);
-  FoldingSetNodeIDWrapper RHSWrapper(DataRHS);
-
-  CollectStmtSequenceData(LHS, LHSWrapper);
-  CollectStmtSequenceData(RHS, RHSWrapper);
-
-  return DataLHS == DataRHS;
-}
-
 /// \brief Finds all actual clone groups in a single group of presumed clones.
 /// \param Result Output parameter to which all found groups are added.
 /// \param Group A group of presumed clones. The clones are allowed to have a
 ///              different variable pattern and may not be actual clones of each
 ///              other.
-/// \param CheckVariablePattern If true, every clone in a group that was added
-///              to the output follows the same variable pattern as the other
-///              clones in its group.
+/// \param Data The data collected by CollectStmtSequenceData for each sequence
+///             in \p Group. Unlike the hash codes, comparing this data
+///             prevents any false-positives due to hash code collisions.
+/// \param Patterns The variable pattern of each sequence in \p Group, or an
+///                 empty list if the patterns should not be checked. If
+///                 given, every clone in a group that was added to the output
+///                 follows the same variable pattern as the other clones in
+///                 its group.
+///
+/// This only accesses the AST through \p Data and \p Patterns, so it's safe
+/// to call concurrently for different groups.
 static void createCloneGroups(std::vector<CloneDetector::CloneGroup> &Result,
                               const CloneDetector::CloneGroup &Group,
-                              bool CheckVariablePattern) {
-  // We remove the Sequences one by one, so a list is more appropriate.
-  std::list<StmtSequence> UnassignedSequences(Group.Sequences.begin(),
-                                              Group.Sequences.end());
+                              ArrayRef<llvm::FoldingSetNodeID> Data,
+                              MutableArrayRef<VariablePattern> Patterns) {
+  bool CheckVariablePattern = !Patterns.empty();
+
+  // We remove the Sequences one by one, so a list is more appropriate. The
+  // list holds indexes into Group.Sequences.
+  std::list<unsigned> UnassignedSequences;
+  for (unsigned i = 0; i < Group.Sequences.size(); ++i)
+    UnassignedSequences.push_back(i);
 
   // Search for clones as long as there could be clones in UnassignedSequences.
   while (UnassignedSequences.size() > 1) {
 
     // Pick the first Sequence as a protoype for a new clone group.
-    StmtSequence Prototype = UnassignedSequences.front();
+    unsigned Prototype = UnassignedSequences.front();
     UnassignedSequences.pop_front();
 
-    CloneDetector::CloneGroup FilteredGroup(Prototype, Group.Signature);
-
-    // Analyze the variable pattern of the prototype. Every other StmtSequence
-    // needs to have the same pattern to get into the new clone group.
-    VariablePattern PrototypeFeatures(Prototype);
+    CloneDetector::CloneGroup FilteredGroup(Group.Sequences[Prototype],
+                                            Group.Signature);
 
     // Search all remaining StmtSequences for an identical variable pattern
     // and assign them to our new clone group.
@@ -727,7 +722,7 @@ static void createCloneGroups(std::vector<CloneDetector::CloneGroup> &Result,
     while (I != E) {
       // If the sequence doesn't fit to the prototype, we have encountered
       // an unintended hash code collision and we skip it.
-      if (!areSequencesClones(Prototype, *I)) {
+      if (Data[Prototype] != Data[*I]) {
         ++I;
         continue;
       }
@@ -738,8 +733,8 @@ static void createCloneGroups(std::vector<CloneDetector::CloneGroup> &Result,
       // to check that there are no differences between the two patterns and
       // only proceed if they match.
       if (!CheckVariablePattern ||
-          VariablePattern(*I).countPatternDifferences(PrototypeFeatures) == 0) {
-        FilteredGroup.Sequences.push_back(*I);
+          Patterns[*I].countPatternDifferences(Patterns[Prototype]) == 0) {
+        FilteredGroup.Sequences.push_back(Group.Sequences[*I]);
         I = UnassignedSequences.erase(I);
         continue;
       }
@@ -759,7 +754,7 @@ static void createCloneGroups(std::vector<CloneDetector::CloneGroup> &Result,
 
 void CloneDetector::findClones(std::vector<CloneGroup> &Result,
                                unsigned MinGroupComplexity,
-                               bool CheckPatterns) {
+                               bool CheckPatterns, unsigned NumThreads) {
   // A shortcut (and necessary for the for-loop later in this function).
   if (Sequences.empty())
     return;
@@ -827,11 +822,43 @@ void CloneDetector::findClones(std::vector<CloneGroup> &Result,
     CloneGroups.push_back(Group);
   }
 
-  // Add every valid clone group that fulfills the complexity requirement.
-  for (const CloneGroup &Group : CloneGroups) {
-    createCloneGroups(Result, Group, CheckPatterns);
+  // Collecting the data that verifies the presumed clones walks the AST and
+  // queries the SourceManager, neither of which is thread-safe, so we do it
+  // for all groups here. Every sequence is only visited once, instead of once
+  // for every sequence it is compared with.
+  std::vector<std::vector<llvm::FoldingSetNodeID>> GroupData(CloneGroups.size());
+  std::vector<std::vector<VariablePattern>> GroupPatterns(CloneGroups.size());
+  for (unsigned i = 0; i < CloneGroups.size(); ++i) {
+    for (const StmtSequence &Sequence : CloneGroups[i].Sequences) {
+      GroupData[i].emplace_back();
+      FoldingSetNodeIDWrapper Wrapper(GroupData[i].back());
+      CollectStmtSequenceData(Sequence, Wrapper);
+      if (CheckPatterns)
+        GroupPatterns[i].emplace_back(Sequence);
+    }
   }
 
+  // Add every valid clone group that fulfills the complexity requirement. The
+  // groups are independent of each other, so they can be split into actual
+  // clone groups concurrently. The results are concatenated in the original
+  // order afterwards.
+  std::vector<std::vector<CloneGroup>> GroupResults(CloneGroups.size());
+  auto SplitGroup = [&](unsigned i) {
+    createCloneGroups(GroupResults[i], CloneGroups[i], GroupData[i],
+                      GroupPatterns[i]);
+  };
+  if (NumThreads > 1 && CloneGroups.size() > 1) {
+    llvm::ThreadPool Pool(std::min<size_t>(NumThreads, CloneGroups.size()));
+    for (unsigned i = 0; i < CloneGroups.size(); ++i)
+      Pool.async(SplitGroup, i);
+    Pool.wait();
+  } else {
+    for (unsigned i = 0; i < CloneGroups.size(); ++i)
+      SplitGroup(i);
+  }
+  for (std::vector<CloneGroup> &Groups : GroupResults)
+    Result.insert(Result.end(), Groups.begin(), Groups.end());
+
   std::vector<unsigned> IndexesToRemove;
 
   // Compare every group in the result with the rest. If one groups contains
@@ -892,3 +919,137 @@ void CloneDetector::findSuspiciousClones(
     }
   }
 }
+
+bool CloneDetector::SignatureRecord::contains(
+    const SignatureRecord &Other) const {
+  return File == Other.File &&
+         std::tie(StartLine, StartColumn) <=
+             std::tie(Other.StartLine, Other.StartColumn) &&
+         std::tie(Other.EndLine, Other.EndColumn) <=
+             std::tie(EndLine, EndColumn);
+}
+
+void CloneDetector::writeSignatures(llvm::raw_ostream &OS,
+                                    unsigned MinComplexity) const {
+  for (const auto &Entry : Sequences) {
+    const CloneSignature &Signature = Entry.first;
+    const StmtSequence &Sequence = Entry.second;
+    if (Signature.Complexity < MinComplexity)
+      continue;
+
+    const SourceManager &SM = Sequence.getASTContext().getSourceManager();
+    SourceLocation Start = SM.getExpansionLoc(Sequence.getStartLoc());
+    SourceLocation End = SM.getExpansionLoc(Sequence.getEndLoc());
+    // Skip code that isn't located in a file, e.g. in the predefines.
+    const FileEntry *File = SM.getFileEntryForID(SM.getFileID(Start));
+    if (!File)
+      continue;
+
+    // The file name comes last, so it's allowed to contain spaces.
+    OS << llvm::format_hex_no_prefix(Signature.Hash, 2 * sizeof(size_t)) << ' '
+       << Signature.Complexity << ' ' << SM.getExpansionLineNumber(Start)
+       << ':' << SM.getExpansionColumnNumber(Start) << ' '
+       << SM.getExpansionLineNumber(End) << ':'
+       << SM.getExpansionColumnNumber(End) << ' ' << File->getName() << '\n';
+  }
+}
+
+/// \brief Parses a "line:column" pair.
+static bool parseLineAndColumn(StringRef Str, unsigned &Line,
+                               unsigned &Column) {
+  StringRef LineStr, ColumnStr;
+  std::tie(LineStr, ColumnStr) = Str.split(':');
+  return !LineStr.getAsInteger(10, Line) && !ColumnStr.getAsInteger(10, Column);
+}
+
+bool CloneDetector::readSignatures(StringRef Buffer,
+                                   std::vector<SignatureRecord> &Records) {
+  SmallVector<StringRef, 16> Lines;
+  Buffer.split(Lines, '\n', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  for (StringRef Line : Lines) {
+    SmallVector<StringRef, 5> Fields;
+    Line.split(Fields, ' ', /*MaxSplit=*/4);
+    if (Fields.size() != 5 || Fields[4].empty())
+      return false;
+
+    SignatureRecord Record;
+    unsigned long long Hash;
+    if (Fields[0].getAsInteger(16, Hash) ||
+        Fields[1].getAsInteger(10, Record.Complexity) ||
+        !parseLineAndColumn(Fields[2], Record.StartLine, Record.StartColumn) ||
+        !parseLineAndColumn(Fields[3], Record.EndLine, Record.EndColumn))
+      return false;
+    Record.Hash = Hash;
+    Record.File = Fields[4];
+    Records.push_back(std::move(Record));
+  }
+  return true;
+}
+
+void CloneDetector::groupSignatures(
+    std::vector<SignatureRecord> Records, unsigned MinGroupComplexity,
+    std::vector<std::vector<SignatureRecord>> &Result) {
+  Records.erase(std::remove_if(Records.begin(), Records.end(),
+                               [=](const SignatureRecord &R) {
+                                 return R.Complexity < MinGroupComplexity;
+                               }),
+                Records.end());
+
+  // Sort by hash code so that groups are adjacent, and by location within a
+  // group so that records of code seen by several translation units are
+  // adjacent, too.
+  auto Key = [](const SignatureRecord &R) {
+    return std::tie(R.Hash, R.File, R.StartLine, R.StartColumn, R.EndLine,
+                    R.EndColumn);
+  };
+  std::sort(Records.begin(), Records.end(),
+            [&](const SignatureRecord &LHS, const SignatureRecord &RHS) {
+              return Key(LHS) < Key(RHS);
+            });
+  Records.erase(std::unique(Records.begin(), Records.end(),
+                            [&](const SignatureRecord &LHS,
+                                const SignatureRecord &RHS) {
+                              return Key(LHS) == Key(RHS);
+                            }),
+                Records.end());
+
+  std::vector<std::vector<SignatureRecord>> Groups;
+  for (auto I = Records.begin(), E = Records.end(); I != E;) {
+    auto GroupEnd = std::find_if(I, E, [&](const SignatureRecord &R) {
+      return R.Hash != I->Hash;
+    });
+    if (GroupEnd - I > 1)
+      Groups.emplace_back(I, GroupEnd);
+    I = GroupEnd;
+  }
+
+  // As in findClones, drop every group whose records are all covered by the
+  // records of a bigger group. If two groups cover each other, e.g. because
+  // an implicit expression has the same range as its child, keep the first.
+  auto CoversGroup = [](const std::vector<SignatureRecord> &Group,
+                        const std::vector<SignatureRecord> &OtherGroup) {
+    if (Group.size() < OtherGroup.size())
+      return false;
+    for (const SignatureRecord &Other : OtherGroup) {
+      if (std::none_of(Group.begin(), Group.end(),
+                       [&](const SignatureRecord &R) {
+                         return R.contains(Other);
+                       }))
+        return false;
+    }
+    return true;
+  };
+  std::vector<bool> Covered(Groups.size());
+  for (unsigned i = 0; i < Groups.size(); ++i) {
+    for (unsigned j = 0; j < Groups.size() && !Covered[i]; ++j) {
+      if (i == j || !CoversGroup(Groups[j], Groups[i]))
+        continue;
+      Covered[i] = j < i || !CoversGroup(Groups[i], Groups[j]);
+    }
+  }
+
+  for (unsigned i = 0; i < Groups.size(); ++i) {
+    if (!Covered[i])
+      Result.push_back(std::move(Groups[i]));
+  }
+}
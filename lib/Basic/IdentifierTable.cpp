@@ -22,7 +22,9 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <cstdio>
+#include <iterator>
 
 using namespace clang;
 
@@ -75,7 +77,9 @@ IdentifierIterator *IdentifierInfoLookup::getIdentifiers() {
 IdentifierTable::IdentifierTable(const LangOptions &LangOpts,
                                  IdentifierInfoLookup* externalLookup)
   : HashTable(8192), // Start with space for 8K identifiers.
-    ExternalLookup(externalLookup) {
+    ExternalLookup(externalLookup), NumLookupCacheHits(0),
+    NumLookupCacheMisses(0) {
+  std::fill(std::begin(LookupCache), std::end(LookupCache), nullptr);
 
   // Populate the identifier table with info about keywords for the current
   // language.
@@ -335,6 +339,8 @@ void IdentifierTable::PrintStats() const {
   fprintf(stderr, "Ave identifier length: %f\n",
           (AverageIdentifierSize/(double)NumIdentifiers));
   fprintf(stderr, "Max identifier length: %d\n", MaxIdentifierLength);
+  fprintf(stderr, "Lookup cache: %u hits, %u misses\n", NumLookupCacheHits,
+          NumLookupCacheMisses);
 
   // Compute statistics about the memory allocated for identifiers.
   HashTable.getAllocator().PrintStats();
@@ -78,6 +78,12 @@ void ContentCache::replaceBuffer(llvm::MemoryBuffer *B, bool DoNotFree) {
     delete Buffer.getPointer();
   Buffer.setPointer(B);
   Buffer.setInt(DoNotFree? DoNotFreeFlag : 0);
+
+  // The line table belongs to the previous contents, and goes away with them
+  // when they were pooled.
+  PooledContents.reset();
+  SourceLineCache = nullptr;
+  NumLines = 0;
 }
 
 llvm::MemoryBuffer *ContentCache::getBuffer(DiagnosticsEngine &Diag,
@@ -93,44 +99,55 @@ llvm::MemoryBuffer *ContentCache::getBuffer(DiagnosticsEngine &Diag,
     return Buffer.getPointer();
   }    
 
+  assert(!PooledContents && "Pooled contents without their buffer");
   bool isVolatile = SM.userFilesAreVolatile() && !IsSystemFile;
-  auto BufferOrError =
-      SM.getFileManager().getBufferForFile(ContentsEntry, isVolatile);
-
-  // If we were unable to open the file, then we are in an inconsistent
-  // situation where the content cache referenced a file which no longer
-  // exists. Most likely, we were using a stat cache with an invalid entry but
-  // the file could also have been removed during processing. Since we can't
-  // really deal with this situation, just create an empty buffer.
-  //
-  // FIXME: This is definitely not ideal, but our immediate clients can't
-  // currently handle returning a null entry here. Ideally we should detect
-  // that we are in an inconsistent situation and error out as quickly as
-  // possible.
-  if (!BufferOrError) {
-    StringRef FillStr("<<<MISSING SOURCE FILE>>>\n");
-    Buffer.setPointer(MemoryBuffer::getNewUninitMemBuffer(
-                          ContentsEntry->getSize(), "<invalid>").release());
-    char *Ptr = const_cast<char*>(Buffer.getPointer()->getBufferStart());
-    for (unsigned i = 0, e = ContentsEntry->getSize(); i != e; ++i)
-      Ptr[i] = FillStr[i % FillStr.size()];
-
-    if (Diag.isDiagnosticInFlight())
-      Diag.SetDelayedDiagnostic(diag::err_cannot_open_file,
-                                ContentsEntry->getName(),
-                                BufferOrError.getError().message());
-    else
-      Diag.Report(Loc, diag::err_cannot_open_file)
-          << ContentsEntry->getName() << BufferOrError.getError().message();
+  if (SourceBufferPool *Pool = SM.getBufferPool())
+    if (!isVolatile)
+      PooledContents = Pool->getContents(ContentsEntry, SM.getFileManager());
+
+  if (PooledContents) {
+    // The pooled contents own the buffer.
+    Buffer.setPointer(PooledContents->getBuffer());
+    Buffer.setInt(DoNotFreeFlag);
+  } else {
+    auto BufferOrError =
+        SM.getFileManager().getBufferForFile(ContentsEntry, isVolatile);
+
+    // If we were unable to open the file, then we are in an inconsistent
+    // situation where the content cache referenced a file which no longer
+    // exists. Most likely, we were using a stat cache with an invalid entry
+    // but the file could also have been removed during processing. Since we
+    // can't really deal with this situation, just create an empty buffer.
+    //
+    // FIXME: This is definitely not ideal, but our immediate clients can't
+    // currently handle returning a null entry here. Ideally we should detect
+    // that we are in an inconsistent situation and error out as quickly as
+    // possible.
+    if (!BufferOrError) {
+      StringRef FillStr("<<<MISSING SOURCE FILE>>>\n");
+      Buffer.setPointer(MemoryBuffer::getNewUninitMemBuffer(
+                            ContentsEntry->getSize(), "<invalid>").release());
+      char *Ptr = const_cast<char*>(Buffer.getPointer()->getBufferStart());
+      for (unsigned i = 0, e = ContentsEntry->getSize(); i != e; ++i)
+        Ptr[i] = FillStr[i % FillStr.size()];
+
+      if (Diag.isDiagnosticInFlight())
+        Diag.SetDelayedDiagnostic(diag::err_cannot_open_file,
+                                  ContentsEntry->getName(),
+                                  BufferOrError.getError().message());
+      else
+        Diag.Report(Loc, diag::err_cannot_open_file)
+            << ContentsEntry->getName() << BufferOrError.getError().message();
+
+      Buffer.setInt(Buffer.getInt() | InvalidFlag);
+
+      if (Invalid) *Invalid = true;
+      return Buffer.getPointer();
+    }
 
-    Buffer.setInt(Buffer.getInt() | InvalidFlag);
-    
-    if (Invalid) *Invalid = true;
-    return Buffer.getPointer();
+    Buffer.setPointer(BufferOrError->release());
   }
 
-  Buffer.setPointer(BufferOrError->release());
-
   // Check that the file's size is the same as in the file entry (which may
   // have come from a stat cache).
   if (getRawBuffer()->getBufferSize() != (size_t)ContentsEntry->getSize()) {
@@ -362,7 +379,7 @@ SourceManager::SourceManager(DiagnosticsEngine &Diag, FileManager &FileMgr,
   : Diag(Diag), FileMgr(FileMgr), OverridenFilesKeepOriginalName(true),
     UserFilesAreVolatile(UserFilesAreVolatile), FilesAreTransient(false),
     ExternalSLocEntries(nullptr), LineTable(nullptr), NumLinearScans(0),
-    NumBinaryProbes(0) {
+    NumBinaryProbes(0), NumBinarySearches(0), NumFileIDCacheHits(0) {
   clearIDTables();
   Diag.setSourceManager(this);
 }
@@ -391,11 +408,15 @@ SourceManager::~SourceManager() {
 void SourceManager::clearIDTables() {
   MainFileID = FileID();
   LocalSLocEntryTable.clear();
+  LocalSLocEntryOffsets.clear();
   LoadedSLocEntryTable.clear();
   SLocEntryLoaded.clear();
   LastLineNoFileIDQuery = FileID();
   LastLineNoContentCache = nullptr;
   LastFileIDLookup = FileID();
+  std::fill(std::begin(RecentFileIDLookups), std::end(RecentFileIDLookups),
+            FileID());
+  NextRecentFileIDLookup = 0;
 
   if (LineTable)
     LineTable->clear();
@@ -570,6 +591,7 @@ FileID SourceManager::createFileID(const ContentCache *File,
   LocalSLocEntryTable.push_back(SLocEntry::get(NextLocalOffset,
                                                FileInfo::get(IncludePos, File,
                                                              FileCharacter)));
+  LocalSLocEntryOffsets.push_back(NextLocalOffset);
   unsigned FileSize = File->getSize();
   assert(NextLocalOffset + FileSize + 1 > NextLocalOffset &&
          NextLocalOffset + FileSize + 1 <= CurrentLoadedOffset &&
@@ -620,6 +642,7 @@ SourceManager::createExpansionLocImpl(const ExpansionInfo &Info,
     return SourceLocation::getMacroLoc(LoadedOffset);
   }
   LocalSLocEntryTable.push_back(SLocEntry::get(NextLocalOffset, Info));
+  LocalSLocEntryOffsets.push_back(NextLocalOffset);
   assert(NextLocalOffset + TokLength + 1 > NextLocalOffset &&
          NextLocalOffset + TokLength + 1 <= CurrentLoadedOffset &&
          "Ran out of source locations!");
@@ -643,6 +666,8 @@ void SourceManager::overrideFileContents(const FileEntry *SourceFile,
 
   const_cast<SrcMgr::ContentCache *>(IR)->replaceBuffer(Buffer, DoNotFree);
   const_cast<SrcMgr::ContentCache *>(IR)->BufferOverridden = true;
+  // The last line number query may have used the previous line table.
+  LastLineNoFileIDQuery = FileID();
 
   getOverriddenFilesInfo().OverriddenFilesWithBuffer.insert(SourceFile);
 }
@@ -665,6 +690,7 @@ void SourceManager::disableFileContentsOverride(const FileEntry *File) {
   const SrcMgr::ContentCache *IR = getOrCreateContentCache(File);
   const_cast<SrcMgr::ContentCache *>(IR)->replaceBuffer(nullptr);
   const_cast<SrcMgr::ContentCache *>(IR)->ContentsEntry = IR->OrigEntry;
+  LastLineNoFileIDQuery = FileID();
 
   assert(OverriddenFilesInfo);
   OverriddenFilesInfo->OverriddenFiles.erase(File);
@@ -709,6 +735,15 @@ FileID SourceManager::getFileIDSlow(unsigned SLocOffset) const {
   if (!SLocOffset)
     return FileID::get(0);
 
+  // See if one of the files looked up before the last one contains it.
+  for (FileID &Recent : RecentFileIDLookups) {
+    if (Recent.ID != 0 && isOffsetInFileID(Recent, SLocOffset)) {
+      ++NumFileIDCacheHits;
+      std::swap(Recent, LastFileIDLookup);
+      return LastFileIDLookup;
+    }
+  }
+
   // Now it is time to search for the correct file. See where the SLocOffset
   // sits in the global view and consult local or loaded buffers for it.
   if (SLocOffset < NextLocalOffset)
@@ -729,34 +764,35 @@ FileID SourceManager::getFileIDLocal(unsigned SLocOffset) const {
   // completely random and may be a very long way away.
   //
   // To handle this, we do a linear search for up to 8 steps to catch #1 quickly
-  // then we fall back to a less cache efficient, but more scalable, binary
-  // search to find the location.
+  // then we fall back to a binary search to find the location. Both only look
+  // at LocalSLocEntryOffsets, where the 8 linear steps share a cache line and
+  // the binary search touches far fewer lines than it would by probing the
+  // SLocEntries themselves.
+  const unsigned *Offsets = LocalSLocEntryOffsets.data();
 
   // See if this is near the file point - worst case we start scanning from the
   // most newly created FileID.
-  const SrcMgr::SLocEntry *I;
-
-  if (LastFileIDLookup.ID < 0 ||
-      LocalSLocEntryTable[LastFileIDLookup.ID].getOffset() < SLocOffset) {
+  unsigned GreaterIndex;
+  if (LastFileIDLookup.ID < 0 || Offsets[LastFileIDLookup.ID] < SLocOffset) {
     // Neither loc prunes our search.
-    I = LocalSLocEntryTable.end();
+    GreaterIndex = LocalSLocEntryOffsets.size();
   } else {
     // Perhaps it is near the file point.
-    I = LocalSLocEntryTable.begin()+LastFileIDLookup.ID;
+    GreaterIndex = LastFileIDLookup.ID;
   }
 
-  // Find the FileID that contains this.  "I" is an iterator that points to a
+  // Find the FileID that contains this.  "GreaterIndex" is the index of a
   // FileID whose offset is known to be larger than SLocOffset.
   unsigned NumProbes = 0;
   while (1) {
-    --I;
-    if (I->getOffset() <= SLocOffset) {
-      FileID Res = FileID::get(int(I - LocalSLocEntryTable.begin()));
+    --GreaterIndex;
+    if (Offsets[GreaterIndex] <= SLocOffset) {
+      FileID Res = FileID::get(GreaterIndex);
 
       // If this isn't an expansion, remember it.  We have good locality across
       // FileID lookups.
-      if (!I->isExpansion())
-        LastFileIDLookup = Res;
+      if (!LocalSLocEntryTable[GreaterIndex].isExpansion())
+        setLastFileIDLookup(Res);
       NumLinearScans += NumProbes+1;
       return Res;
     }
@@ -764,47 +800,31 @@ FileID SourceManager::getFileIDLocal(unsigned SLocOffset) const {
       break;
   }
 
-  // Convert "I" back into an index.  We know that it is an entry whose index is
-  // larger than the offset we are looking for.
-  unsigned GreaterIndex = I - LocalSLocEntryTable.begin();
-  // LessIndex - This is the lower bound of the range that we're searching.
-  // We know that the offset corresponding to the FileID is is less than
-  // SLocOffset.
-  unsigned LessIndex = 0;
+  // The offsets are strictly increasing and entry 0 has offset 0, so the entry
+  // we are looking for is the last one below GreaterIndex whose offset is not
+  // greater than SLocOffset. Each step halves the range [Base, Base + Size)
+  // that contains it with a conditional move instead of a hard to predict
+  // branch.
+  const unsigned *Base = Offsets;
+  unsigned Size = GreaterIndex;
   NumProbes = 0;
-  while (1) {
-    bool Invalid = false;
-    unsigned MiddleIndex = (GreaterIndex-LessIndex)/2+LessIndex;
-    unsigned MidOffset = getLocalSLocEntry(MiddleIndex, &Invalid).getOffset();
-    if (Invalid)
-      return FileID::get(0);
-    
+  while (Size > 1) {
+    unsigned Half = Size / 2;
+    Base = Base[Half] <= SLocOffset ? Base + Half : Base;
+    Size -= Half;
     ++NumProbes;
+  }
 
-    // If the offset of the midpoint is too large, chop the high side of the
-    // range to the midpoint.
-    if (MidOffset > SLocOffset) {
-      GreaterIndex = MiddleIndex;
-      continue;
-    }
-
-    // If the middle index contains the value, succeed and return.
-    // FIXME: This could be made faster by using a function that's aware of
-    // being in the local area.
-    if (isOffsetInFileID(FileID::get(MiddleIndex), SLocOffset)) {
-      FileID Res = FileID::get(MiddleIndex);
+  unsigned Index = Base - Offsets;
+  FileID Res = FileID::get(Index);
 
-      // If this isn't a macro expansion, remember it.  We have good locality
-      // across FileID lookups.
-      if (!LocalSLocEntryTable[MiddleIndex].isExpansion())
-        LastFileIDLookup = Res;
-      NumBinaryProbes += NumProbes;
-      return Res;
-    }
-
-    // Otherwise, move the low-side up to the middle index.
-    LessIndex = MiddleIndex;
-  }
+  // If this isn't a macro expansion, remember it.  We have good locality
+  // across FileID lookups.
+  if (!LocalSLocEntryTable[Index].isExpansion())
+    setLastFileIDLookup(Res);
+  NumBinaryProbes += NumProbes;
+  ++NumBinarySearches;
+  return Res;
 }
 
 /// \brief Return the FileID for a SourceLocation with a high offset.
@@ -837,7 +857,7 @@ FileID SourceManager::getFileIDLoaded(unsigned SLocOffset) const {
       FileID Res = FileID::get(-int(I) - 2);
 
       if (!E.isExpansion())
-        LastFileIDLookup = Res;
+        setLastFileIDLookup(Res);
       NumLinearScans += NumProbes + 1;
       return Res;
     }
@@ -871,8 +891,9 @@ FileID SourceManager::getFileIDLoaded(unsigned SLocOffset) const {
     if (isOffsetInFileID(FileID::get(-int(MiddleIndex) - 2), SLocOffset)) {
       FileID Res = FileID::get(-int(MiddleIndex) - 2);
       if (!E.isExpansion())
-        LastFileIDLookup = Res;
+        setLastFileIDLookup(Res);
       NumBinaryProbes += NumProbes;
+      ++NumBinarySearches;
       return Res;
     }
 
@@ -885,6 +906,15 @@ FileID SourceManager::getFileIDLoaded(unsigned SLocOffset) const {
   }
 }
 
+void SourceManager::setLastFileIDLookup(FileID FID) const {
+  if (LastFileIDLookup.ID != 0 && LastFileIDLookup != FID) {
+    RecentFileIDLookups[NextRecentFileIDLookup] = LastFileIDLookup;
+    NextRecentFileIDLookup =
+        (NextRecentFileIDLookup + 1) % FileIDLookupCacheSize;
+  }
+  LastFileIDLookup = FID;
+}
+
 SourceLocation SourceManager::
 getExpansionLocSlowCase(SourceLocation Loc) const {
   do {
@@ -1141,7 +1171,7 @@ unsigned SourceManager::getColumnNumber(FileID FID, unsigned FilePos,
   if (LastLineNoFileIDQuery == FID &&
       LastLineNoContentCache->SourceLineCache != nullptr &&
       LastLineNoResult < LastLineNoContentCache->NumLines) {
-    unsigned *SourceLineCache = LastLineNoContentCache->SourceLineCache;
+    const unsigned *SourceLineCache = LastLineNoContentCache->SourceLineCache;
     unsigned LineStart = SourceLineCache[LastLineNoResult - 1];
     unsigned LineEnd = SourceLineCache[LastLineNoResult];
     if (FilePos >= LineStart && FilePos < LineEnd)
@@ -1190,22 +1220,11 @@ unsigned SourceManager::getPresumedColumnNumber(SourceLocation Loc,
 #include <emmintrin.h>
 #endif
 
-static LLVM_ATTRIBUTE_NOINLINE void
-ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
-                   llvm::BumpPtrAllocator &Alloc,
-                   const SourceManager &SM, bool &Invalid);
-static void ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
-                               llvm::BumpPtrAllocator &Alloc,
-                               const SourceManager &SM, bool &Invalid) {
-  // Note that calling 'getBuffer()' may lazily page in the file.
-  MemoryBuffer *Buffer = FI->getBuffer(Diag, SM, SourceLocation(), &Invalid);
-  if (Invalid)
-    return;
-
-  // Find the file offsets of all of the *physical* source lines.  This does
-  // not look at trigraphs, escaped newlines, or anything else tricky.
-  SmallVector<unsigned, 256> LineOffsets;
-
+/// \brief Find the file offsets of all of the *physical* source lines of
+/// \p Buffer.  This does not look at trigraphs, escaped newlines, or anything
+/// else tricky.
+static void FindLineOffsets(const MemoryBuffer *Buffer,
+                            SmallVectorImpl<unsigned> &LineOffsets) {
   // Line #1 starts at char 0.
   LineOffsets.push_back(0);
 
@@ -1272,11 +1291,97 @@ FoundSpecialChar:
       ++Buf;
     }
   }
+}
+
+static LLVM_ATTRIBUTE_NOINLINE void
+ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
+                   llvm::BumpPtrAllocator &Alloc,
+                   const SourceManager &SM, bool &Invalid);
+static void ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
+                               llvm::BumpPtrAllocator &Alloc,
+                               const SourceManager &SM, bool &Invalid) {
+  // Note that calling 'getBuffer()' may lazily page in the file.
+  MemoryBuffer *Buffer = FI->getBuffer(Diag, SM, SourceLocation(), &Invalid);
+  if (Invalid)
+    return;
+
+  // Pooled contents share their line offsets, unless the buffer was replaced.
+  if (FI->PooledContents && FI->PooledContents->getBuffer() == Buffer) {
+    ArrayRef<unsigned> LineOffsets = FI->PooledContents->getLineOffsets();
+    FI->NumLines = LineOffsets.size();
+    FI->SourceLineCache = LineOffsets.data();
+    return;
+  }
+
+  SmallVector<unsigned, 256> LineOffsets;
+  FindLineOffsets(Buffer, LineOffsets);
 
   // Copy the offsets into the FileInfo structure.
+  unsigned *SourceLineCache = Alloc.Allocate<unsigned>(LineOffsets.size());
+  std::copy(LineOffsets.begin(), LineOffsets.end(), SourceLineCache);
   FI->NumLines = LineOffsets.size();
-  FI->SourceLineCache = Alloc.Allocate<unsigned>(LineOffsets.size());
-  std::copy(LineOffsets.begin(), LineOffsets.end(), FI->SourceLineCache);
+  FI->SourceLineCache = SourceLineCache;
+}
+
+ArrayRef<unsigned> SourceBufferPool::Contents::getLineOffsets() const {
+  std::lock_guard<std::mutex> Lock(LineOffsetsMutex);
+  if (LineOffsets.empty()) {
+    SmallVector<unsigned, 256> Offsets;
+    FindLineOffsets(Buffer.get(), Offsets);
+    LineOffsets.assign(Offsets.begin(), Offsets.end());
+  }
+  return LineOffsets;
+}
+
+std::shared_ptr<const SourceBufferPool::Contents>
+SourceBufferPool::getContents(const FileEntry *File, FileManager &FileMgr) {
+  // Virtual files have no identity on disk.
+  if (!File->isValid() || File->isNamedPipe() ||
+      File->getUniqueID() == llvm::sys::fs::UniqueID(0, 0))
+    return nullptr;
+
+  KeyTy Key(File->getUniqueID(), File->getSize(), File->getModificationTime());
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto Known = Entries.find(Key);
+    if (Known != Entries.end())
+      if (std::shared_ptr<const Contents> Result = Known->second.lock())
+        return Result;
+  }
+
+  // Don't hold the lock while reading the file. If another SourceManager
+  // read it in the meantime, use its contents.
+  auto BufferOrError = FileMgr.getBufferForFile(File);
+  if (!BufferOrError ||
+      (*BufferOrError)->getBufferSize() != (size_t)File->getSize())
+    return nullptr;
+  std::shared_ptr<const Contents> Result =
+      std::make_shared<Contents>(std::move(*BufferOrError));
+
+  std::lock_guard<std::mutex> Lock(Mutex);
+  std::weak_ptr<const Contents> &Entry = Entries[Key];
+  if (std::shared_ptr<const Contents> Existing = Entry.lock())
+    return Existing;
+  Entry = Result;
+
+  if (Entries.size() >= NextPruneSize) {
+    for (auto I = Entries.begin(), E = Entries.end(); I != E;) {
+      if (I->second.expired())
+        I = Entries.erase(I);
+      else
+        ++I;
+    }
+    NextPruneSize = std::max<size_t>(64, 2 * Entries.size());
+  }
+  return Result;
+}
+
+unsigned SourceBufferPool::getNumFiles() const {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  unsigned NumFiles = 0;
+  for (const auto &Entry : Entries)
+    NumFiles += !Entry.second.expired();
+  return NumFiles;
 }
 
 /// getLineNumber - Given a SourceLocation, return the spelling line number
@@ -1320,9 +1425,9 @@ unsigned SourceManager::getLineNumber(FileID FID, unsigned FilePos,
 
   // Okay, we know we have a line number table.  Do a binary search to find the
   // line number that this character position lands on.
-  unsigned *SourceLineCache = Content->SourceLineCache;
-  unsigned *SourceLineCacheStart = SourceLineCache;
-  unsigned *SourceLineCacheEnd = SourceLineCache + Content->NumLines;
+  const unsigned *SourceLineCache = Content->SourceLineCache;
+  const unsigned *SourceLineCacheStart = SourceLineCache;
+  const unsigned *SourceLineCacheEnd = SourceLineCache + Content->NumLines;
 
   unsigned QueriedFilePos = FilePos+1;
 
@@ -1366,7 +1471,7 @@ unsigned SourceManager::getLineNumber(FileID FID, unsigned FilePos,
     }
   }
 
-  unsigned *Pos
+  const unsigned *Pos
     = std::lower_bound(SourceLineCache, SourceLineCacheEnd, QueriedFilePos);
   unsigned LineNo = Pos-SourceLineCacheStart;
 
@@ -2139,17 +2244,23 @@ void SourceManager::PrintStats() const {
   
   unsigned NumLineNumsComputed = 0;
   unsigned NumFileBytesMapped = 0;
+  unsigned NumFileBytesPooled = 0;
   for (fileinfo_iterator I = fileinfo_begin(), E = fileinfo_end(); I != E; ++I){
     NumLineNumsComputed += I->second->SourceLineCache != nullptr;
     NumFileBytesMapped  += I->second->getSizeBytesMapped();
+    if (I->second->PooledContents)
+      NumFileBytesPooled += I->second->getSizeBytesMapped();
   }
   unsigned NumMacroArgsComputed = MacroArgsCacheMap.size();
 
-  llvm::errs() << NumFileBytesMapped << " bytes of files mapped, "
+  llvm::errs() << NumFileBytesMapped << " bytes of files mapped ("
+               << NumFileBytesPooled << " shared through a pool), "
                << NumLineNumsComputed << " files with line #'s computed, "
                << NumMacroArgsComputed << " files with macro args computed.\n";
   llvm::errs() << "FileID scans: " << NumLinearScans << " linear, "
-               << NumBinaryProbes << " binary.\n";
+               << NumBinaryProbes << " binary (in " << NumBinarySearches
+               << " searches), " << NumFileIDCacheHits
+               << " recent lookup cache hits.\n";
 }
 
 LLVM_DUMP_METHOD void SourceManager::dump() const {
@@ -2234,6 +2345,7 @@ SourceManager::MemoryBufferSizes SourceManager::getMemoryBufferSizes() const {
 size_t SourceManager::getDataStructureSizes() const {
   size_t size = llvm::capacity_in_bytes(MemBufferInfos)
     + llvm::capacity_in_bytes(LocalSLocEntryTable)
+    + llvm::capacity_in_bytes(LocalSLocEntryOffsets)
     + llvm::capacity_in_bytes(LoadedSLocEntryTable)
     + llvm::capacity_in_bytes(SLocEntryLoaded)
     + llvm::capacity_in_bytes(FileInfos);
@@ -27,6 +27,7 @@
 #include "llvm/CodeGen/RegAllocRegistry.h"
 #include "llvm/CodeGen/SchedulerRegistry.h"
 #include "llvm/IR/DataLayout.h"
+#include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/IRPrintingPasses.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
@@ -38,9 +39,12 @@
 #include "llvm/Object/ModuleSummaryIndexObjectFile.h"
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
@@ -54,8 +58,12 @@
 #include "llvm/Transforms/ObjCARC.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Scalar/GVN.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "llvm/Transforms/Utils/SymbolRewriter.h"
+#include <atomic>
 #include <memory>
+#include <mutex>
 using namespace clang;
 using namespace llvm;
 
@@ -98,12 +106,22 @@ class EmitAssemblyHelper {
   /// the requested target.
   void CreateTargetMachine(bool MustCreateTM);
 
+  /// Creates a new TargetMachine for the module, or returns null and sets
+  /// \p Error if the target is unknown. This can be called from several
+  /// threads at once.
+  std::unique_ptr<TargetMachine> createTargetMachine(std::string &Error) const;
+
   /// Add passes necessary to emit assembly or LLVM IR.
   ///
   /// \return True on success.
   bool AddEmitPasses(legacy::PassManager &CodeGenPasses, BackendAction Action,
                      raw_pwrite_stream &OS);
 
+  /// Split the module into partitions and emit assembly or an object for each
+  /// of them in parallel, the first to OS and the others to the files named
+  /// by CodeGenOpts.ParallelCodeGenOutputs.
+  void EmitPartitions(BackendAction Action);
+
 public:
   EmitAssemblyHelper(DiagnosticsEngine &_Diags,
                      const HeaderSearchOptions &HeaderSearchOpts,
@@ -484,15 +502,19 @@ void EmitAssemblyHelper::setCommandLineOpts() {
 }
 
 void EmitAssemblyHelper::CreateTargetMachine(bool MustCreateTM) {
-  // Create the TargetMachine for generating code.
   std::string Error;
+  TM = createTargetMachine(Error);
+  if (!TM && MustCreateTM && !Error.empty())
+    Diags.Report(diag::err_fe_unable_to_create_target) << Error;
+}
+
+std::unique_ptr<TargetMachine>
+EmitAssemblyHelper::createTargetMachine(std::string &Error) const {
+  // Create the TargetMachine for generating code.
   std::string Triple = TheModule->getTargetTriple();
   const llvm::Target *TheTarget = TargetRegistry::lookupTarget(Triple, Error);
-  if (!TheTarget) {
-    if (MustCreateTM)
-      Diags.Report(diag::err_fe_unable_to_create_target) << Error;
-    return;
-  }
+  if (!TheTarget)
+    return nullptr;
 
   unsigned CodeModel =
     llvm::StringSwitch<unsigned>(CodeGenOpts.CodeModel)
@@ -614,8 +636,8 @@ void EmitAssemblyHelper::CreateTargetMachine(bool MustCreateTM) {
       Options.MCOptions.IASSearchPaths.push_back(
           Entry.IgnoreSysRoot ? Entry.Path : HSOpts.Sysroot + Entry.Path);
 
-  TM.reset(TheTarget->createTargetMachine(Triple, TargetOpts.CPU, FeaturesStr,
-                                          Options, RM, CM, OptLevel));
+  return std::unique_ptr<TargetMachine>(TheTarget->createTargetMachine(
+      Triple, TargetOpts.CPU, FeaturesStr, Options, RM, CM, OptLevel));
 }
 
 bool EmitAssemblyHelper::AddEmitPasses(legacy::PassManager &CodeGenPasses,
@@ -652,6 +674,116 @@ bool EmitAssemblyHelper::AddEmitPasses(legacy::PassManager &CodeGenPasses,
   return true;
 }
 
+namespace {
+/// Forwards the diagnostics of the contexts that code is generated in for
+/// each partition, on threads of their own, to the handlers that the
+/// frontend installed on the context of the whole module, one at a time.
+class PartitionDiagnosticForwarder {
+  LLVMContext &Ctx;
+  std::mutex Mutex;
+
+  static void diagnose(const DiagnosticInfo &DI, void *Context) {
+    auto *Self = static_cast<PartitionDiagnosticForwarder *>(Context);
+    std::lock_guard<std::mutex> Lock(Self->Mutex);
+    Self->Ctx.diagnose(DI);
+  }
+
+  static void diagnoseInlineAsm(const SMDiagnostic &D, void *Context,
+                                unsigned LocCookie) {
+    auto *Self = static_cast<PartitionDiagnosticForwarder *>(Context);
+    std::lock_guard<std::mutex> Lock(Self->Mutex);
+    Self->Ctx.getInlineAsmDiagnosticHandler()(
+        D, Self->Ctx.getInlineAsmDiagnosticContext(), LocCookie);
+  }
+
+public:
+  explicit PartitionDiagnosticForwarder(LLVMContext &Ctx) : Ctx(Ctx) {}
+
+  void install(LLVMContext &PartitionCtx) {
+    PartitionCtx.setDiagnosticHandler(diagnose, this);
+    if (Ctx.getInlineAsmDiagnosticHandler())
+      PartitionCtx.setInlineAsmDiagnosticHandler(diagnoseInlineAsm, this);
+  }
+};
+} // end anonymous namespace
+
+void EmitAssemblyHelper::EmitPartitions(BackendAction Action) {
+  SmallVector<raw_pwrite_stream *, 8> OSs;
+  OSs.push_back(OS.get());
+  std::vector<std::unique_ptr<raw_fd_ostream>> PartitionOSs;
+  for (const std::string &Path : CodeGenOpts.ParallelCodeGenOutputs) {
+    std::error_code EC;
+    PartitionOSs.emplace_back(new raw_fd_ostream(Path, EC, sys::fs::F_None));
+    if (EC) {
+      Diags.Report(diag::err_fe_unable_to_open_output) << Path << EC.message();
+      return;
+    }
+    OSs.push_back(PartitionOSs.back().get());
+  }
+
+  TargetMachine::CodeGenFileType FileType =
+      Action == Backend_EmitObj ? TargetMachine::CGFT_ObjectFile
+                                : TargetMachine::CGFT_AssemblyFile;
+  PartitionDiagnosticForwarder Forwarder(TheModule->getContext());
+  std::atomic<bool> FailedToSetUpCodeGen(false);
+  {
+    // The threads are joined when the pool is destroyed.
+    ThreadPool Pool(OSs.size());
+    unsigned NumPartitions = 0;
+
+    // The module is given away to be split; keep the original for the
+    // caller. Local symbols are kept local, in the partition of their users,
+    // since externalizing them could clash with other objects.
+    SplitModule(
+        CloneModule(TheModule), OSs.size(),
+        [&](std::unique_ptr<llvm::Module> Partition) {
+          // Each partition is moved to a context of its own through bitcode,
+          // written here so as not to race with the other threads.
+          SmallString<0> BC;
+          raw_svector_ostream BCOS(BC);
+          WriteBitcodeToFile(Partition.get(), BCOS);
+
+          raw_pwrite_stream *PartitionOS = OSs[NumPartitions++];
+          Pool.async(
+              [this, &Forwarder, &FailedToSetUpCodeGen, FileType,
+               PartitionOS](const SmallString<0> &BC) {
+                LLVMContext Ctx;
+                Forwarder.install(Ctx);
+                Expected<std::unique_ptr<llvm::Module>> M = parseBitcodeFile(
+                    MemoryBufferRef(StringRef(BC.data(), BC.size()),
+                                    "<partition>"),
+                    Ctx);
+                if (!M)
+                  report_fatal_error("failed to read a code generation "
+                                     "partition");
+
+                std::string Error;
+                std::unique_ptr<TargetMachine> PartitionTM =
+                    createTargetMachine(Error);
+                llvm::Triple TargetTriple((*M)->getTargetTriple());
+                std::unique_ptr<TargetLibraryInfoImpl> TLII(
+                    createTLII(TargetTriple, CodeGenOpts));
+                legacy::PassManager CodeGenPasses;
+                CodeGenPasses.add(createTargetTransformInfoWrapperPass(
+                    PartitionTM->getTargetIRAnalysis()));
+                CodeGenPasses.add(new TargetLibraryInfoWrapperPass(*TLII));
+                if (PartitionTM->addPassesToEmitFile(
+                        CodeGenPasses, *PartitionOS, FileType,
+                        /*DisableVerify=*/!CodeGenOpts.VerifyModule)) {
+                  FailedToSetUpCodeGen = true;
+                  return;
+                }
+                CodeGenPasses.run(**M);
+              },
+              std::move(BC));
+        },
+        /*PreserveLocals=*/true);
+  }
+
+  if (FailedToSetUpCodeGen)
+    Diags.Report(diag::err_fe_unable_to_interface_with_target);
+}
+
 void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
                                       std::unique_ptr<raw_pwrite_stream> OS) {
   TimeRegion Region(llvm::TimePassesIsEnabled ? &CodeGenerationTime : nullptr);
@@ -682,6 +814,7 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
   CodeGenPasses.add(
       createTargetTransformInfoWrapperPass(getTargetIRAnalysis()));
 
+  bool SplitCodeGen = false;
   switch (Action) {
   case Backend_EmitNothing:
     break;
@@ -700,6 +833,15 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
     break;
 
   default:
+    if (!CodeGenOpts.ParallelCodeGenOutputs.empty() &&
+        Action != Backend_EmitMCNull) {
+      // Code is generated for each partition on its own; run the IR passes
+      // that AddEmitPasses would have added on the whole module first.
+      if (CodeGenOpts.OptimizationLevel > 0)
+        CodeGenPasses.add(createObjCARCContractPass());
+      SplitCodeGen = true;
+      break;
+    }
     if (!AddEmitPasses(CodeGenPasses, Action, *OS))
       return;
   }
@@ -728,6 +870,8 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
   {
     PrettyStackTraceString CrashInfo("Code generation");
     CodeGenPasses.run(*TheModule);
+    if (SplitCodeGen)
+      EmitPartitions(Action);
   }
 }
 
@@ -835,6 +979,7 @@ void EmitAssemblyHelper::EmitAssemblyWithNewPassManager(
   // create that pass manager here and use it as needed below.
   legacy::PassManager CodeGenPasses;
   bool NeedCodeGen = false;
+  bool SplitCodeGen = false;
 
   // Append any output we need to the pass manager.
   switch (Action) {
@@ -857,6 +1002,13 @@ void EmitAssemblyHelper::EmitAssemblyWithNewPassManager(
     NeedCodeGen = true;
     CodeGenPasses.add(
         createTargetTransformInfoWrapperPass(getTargetIRAnalysis()));
+    if (!CodeGenOpts.ParallelCodeGenOutputs.empty() &&
+        Action != Backend_EmitMCNull) {
+      if (CodeGenOpts.OptimizationLevel > 0)
+        CodeGenPasses.add(createObjCARCContractPass());
+      SplitCodeGen = true;
+      break;
+    }
     if (!AddEmitPasses(CodeGenPasses, Action, *OS))
       // FIXME: Should we handle this error differently?
       return;
@@ -876,6 +1028,8 @@ void EmitAssemblyHelper::EmitAssemblyWithNewPassManager(
   if (NeedCodeGen) {
     PrettyStackTraceString CrashInfo("Code generation");
     CodeGenPasses.run(*TheModule);
+    if (SplitCodeGen)
+      EmitPartitions(Action);
   }
 }
 
@@ -1430,6 +1430,17 @@ void CGDebugInfo::CollectCXXMemberFunctions(
     // This situation can arise in the vtable-based debug info reduction where
     // implicit members are emitted in a non-vtable TU.
     auto MI = SPCache.find(Method->getCanonicalDecl());
+
+    // Non-virtual methods don't affect the layout of the class, so they can be
+    // left out until this TU emits a definition for them, at which point
+    // getFunctionDeclaration() creates their declaration within the class.
+    if (CGM.getCodeGenOpts().DebugOmitUnreferencedMethods &&
+        !CGM.getCodeGenOpts().EmitCodeView && !Method->isVirtual() &&
+        MI == SPCache.end()) {
+      ++NumOmittedMethods;
+      continue;
+    }
+
     EltTys.push_back(MI == SPCache.end()
                          ? CreateCXXMemberFunction(Method, Unit, RecordTy)
                          : static_cast<llvm::Metadata *>(MI->second));
@@ -4015,6 +4026,29 @@ void CGDebugInfo::setDwoId(uint64_t Signature) {
 }
 
 
+void CGDebugInfo::PrintStats() const {
+  unsigned NumDefinitions = 0, NumDeclarations = 0;
+  for (const auto &Entry : TypeCache)
+    if (const auto *CT =
+            dyn_cast_or_null<llvm::DICompositeType>(Entry.second.get())) {
+      if (CT->isForwardDecl())
+        ++NumDeclarations;
+      else
+        ++NumDefinitions;
+    }
+
+  llvm::errs() << "\n*** Debug Info Stats:\n";
+  llvm::errs() << "  " << TypeCache.size() << " types referenced.\n";
+  llvm::errs() << "    " << NumDefinitions
+               << " composite types described in full\n";
+  llvm::errs() << "    " << NumDeclarations
+               << " composite types described as declarations only\n";
+  llvm::errs() << "  " << SPCache.size() << " functions described.\n";
+  if (CGM.getCodeGenOpts().DebugOmitUnreferencedMethods)
+    llvm::errs() << "    " << NumOmittedMethods
+                 << " unreferenced methods omitted\n";
+}
+
 void CGDebugInfo::finalize() {
   // Creating types might create further types - invalidating the current
   // element and the size(), so don't cache/reference them.
@@ -128,6 +128,10 @@ class CGDebugInfo {
   llvm::DenseMap<const NamespaceDecl *, llvm::TrackingMDRef> NameSpaceCache;
   llvm::DenseMap<const NamespaceAliasDecl *, llvm::TrackingMDRef>
       NamespaceAliasCache;
+
+  /// The number of methods left out of class descriptions because of
+  /// -debug-omit-unreferenced-methods.
+  unsigned NumOmittedMethods = 0;
   llvm::DenseMap<const Decl *, llvm::TypedTrackingMDRef<llvm::DIDerivedType>>
       StaticDataMemberCache;
 
@@ -299,6 +303,9 @@ public:
 
   void finalize();
 
+  /// Print statistics about the types described so far.
+  void PrintStats() const;
+
   /// Module debugging: Support for building PCMs.
   /// @{
   /// Set the main CU's DwoId field to \p Signature.
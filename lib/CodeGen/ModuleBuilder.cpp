@@ -266,6 +266,12 @@ namespace {
       }
     }
 
+    void PrintStats() override {
+      if (Builder)
+        if (CGDebugInfo *DI = Builder->getModuleDebugInfo())
+          DI->PrintStats();
+    }
+
     void AssignInheritanceModel(CXXRecordDecl *RD) override {
       if (Diags.hasErrorOccurred())
         return;
@@ -0,0 +1,514 @@
+//===--- CompileServer.cpp - Persistent -cc1 compile server ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// A job is sent to the server as a header holding the client's umask and the
+// number of environment variables and arguments that follow, which carries the
+// client's standard input, output and error file descriptors as ancillary
+// data, followed by strings: the client's working directory, its environment,
+// then the job's command line. Each string is a 32-bit length followed by its
+// bytes.
+//
+// Once the server has started the job, it replies with a 32-bit
+// acknowledgement; a connection closed before that means that the server
+// refused the job, which the client may then run itself. Once the job
+// completes, the server replies with its 32-bit exit status; a connection
+// closed after the acknowledgement but without a status means that the job
+// crashed. If the client goes away while the job runs, the job is terminated.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Driver/CompileServer.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+#if LLVM_ON_UNIX
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef __APPLE__
+#include <crt_externs.h>
+#elif LLVM_ON_UNIX
+extern char **environ;
+#endif
+
+using namespace clang;
+using namespace clang::driver;
+using namespace clang::driver::compile_server;
+
+#if LLVM_ON_UNIX
+
+#ifdef MSG_NOSIGNAL
+static const int SendFlags = MSG_NOSIGNAL;
+#else
+static const int SendFlags = 0;
+#endif
+
+// The server only runs jobs for its own user, so it must be able to identify
+// the peer of a connection.
+#if defined(SO_PEERCRED) || defined(__APPLE__) || defined(__FreeBSD__) ||     \
+    defined(__NetBSD__) || defined(__OpenBSD__) || defined(__DragonFly__)
+#define HAVE_PEER_CREDENTIALS 1
+#endif
+
+/// The header of a job.
+struct JobHeader {
+  uint32_t Umask;
+  uint32_t NumEnv;
+  uint32_t NumArgs;
+};
+
+/// The reply sent once the server has started a job.
+static const uint32_t JobAccepted = 0x434c4a41; // 'CLJA'
+
+/// The number of file descriptors sent along with a job: the client's
+/// standard input, output and error.
+static const unsigned NumStdFDs = 3;
+
+/// Upper bound on the number of strings in a job, to reject garbage.
+static const uint32_t MaxStrings = 1 << 20;
+
+static bool setError(std::string *ErrMsg, const Twine &Msg) {
+  if (ErrMsg)
+    *ErrMsg = (Msg + ": " + strerror(errno)).str();
+  return false;
+}
+
+static bool sendAll(int FD, const void *Data, size_t Size) {
+  const char *Ptr = static_cast<const char *>(Data);
+  while (Size) {
+    ssize_t N = ::send(FD, Ptr, Size, SendFlags);
+    if (N < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    Ptr += N;
+    Size -= N;
+  }
+  return true;
+}
+
+static bool receiveAll(int FD, void *Data, size_t Size) {
+  char *Ptr = static_cast<char *>(Data);
+  while (Size) {
+    ssize_t N = ::recv(FD, Ptr, Size, 0);
+    if (N < 0 && errno == EINTR)
+      continue;
+    if (N <= 0)
+      return false;
+    Ptr += N;
+    Size -= N;
+  }
+  return true;
+}
+
+static bool sendString(int FD, StringRef S) {
+  uint32_t Size = S.size();
+  return sendAll(FD, &Size, sizeof(Size)) && sendAll(FD, S.data(), S.size());
+}
+
+static bool receiveString(int FD, std::string &S) {
+  uint32_t Size;
+  if (!receiveAll(FD, &Size, sizeof(Size)))
+    return false;
+  S.resize(Size);
+  return receiveAll(FD, &S[0], Size);
+}
+
+/// \brief Fill in the address of the socket at \p SocketPath.
+static bool getSocketAddress(StringRef SocketPath, sockaddr_un &Addr,
+                             std::string *ErrMsg) {
+  memset(&Addr, 0, sizeof(Addr));
+  Addr.sun_family = AF_UNIX;
+  if (SocketPath.size() >= sizeof(Addr.sun_path)) {
+    if (ErrMsg)
+      *ErrMsg = ("socket path '" + SocketPath + "' is too long").str();
+    return false;
+  }
+  memcpy(Addr.sun_path, SocketPath.data(), SocketPath.size());
+  return true;
+}
+
+/// \brief Send the header of a job, along with the standard file descriptors
+/// of the current process.
+static bool sendHeader(int FD, const JobHeader &Header) {
+  int FDs[NumStdFDs] = {0, 1, 2};
+  char Control[CMSG_SPACE(sizeof(FDs))];
+  memset(Control, 0, sizeof(Control));
+
+  iovec IOV;
+  IOV.iov_base = const_cast<JobHeader *>(&Header);
+  IOV.iov_len = sizeof(Header);
+
+  msghdr Msg;
+  memset(&Msg, 0, sizeof(Msg));
+  Msg.msg_iov = &IOV;
+  Msg.msg_iovlen = 1;
+  Msg.msg_control = Control;
+  Msg.msg_controllen = sizeof(Control);
+
+  cmsghdr *CMsg = CMSG_FIRSTHDR(&Msg);
+  CMsg->cmsg_level = SOL_SOCKET;
+  CMsg->cmsg_type = SCM_RIGHTS;
+  CMsg->cmsg_len = CMSG_LEN(sizeof(FDs));
+  memcpy(CMSG_DATA(CMsg), FDs, sizeof(FDs));
+
+  ssize_t N;
+  do
+    N = ::sendmsg(FD, &Msg, SendFlags);
+  while (N < 0 && errno == EINTR);
+  return N == sizeof(Header);
+}
+
+/// \brief Receive the header of a job, along with the client's standard file
+/// descriptors.
+static bool receiveHeader(int FD, JobHeader &Header, int (&FDs)[NumStdFDs]) {
+  char Control[CMSG_SPACE(sizeof(FDs))];
+
+  iovec IOV;
+  IOV.iov_base = &Header;
+  IOV.iov_len = sizeof(Header);
+
+  msghdr Msg;
+  memset(&Msg, 0, sizeof(Msg));
+  Msg.msg_iov = &IOV;
+  Msg.msg_iovlen = 1;
+  Msg.msg_control = Control;
+  Msg.msg_controllen = sizeof(Control);
+
+  ssize_t N;
+  do
+    N = ::recvmsg(FD, &Msg, 0);
+  while (N < 0 && errno == EINTR);
+  if (N != sizeof(Header) || (Msg.msg_flags & MSG_CTRUNC))
+    return false;
+
+  cmsghdr *CMsg = CMSG_FIRSTHDR(&Msg);
+  if (!CMsg || CMsg->cmsg_level != SOL_SOCKET ||
+      CMsg->cmsg_type != SCM_RIGHTS || CMsg->cmsg_len != CMSG_LEN(sizeof(FDs)))
+    return false;
+  memcpy(FDs, CMSG_DATA(CMsg), sizeof(FDs));
+  return true;
+}
+
+/// \brief The environment of the current process.
+static char **&getEnvironment() {
+#ifdef __APPLE__
+  return *_NSGetEnviron();
+#else
+  return environ;
+#endif
+}
+
+bool compile_server::isSupported() {
+#ifdef HAVE_PEER_CREDENTIALS
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool compile_server::runJob(StringRef SocketPath, ArrayRef<const char *> Argv,
+                            int &Result, std::string *ErrMsg) {
+  if (!isSupported()) {
+    if (ErrMsg)
+      *ErrMsg = "compile servers are not supported on this host";
+    return false;
+  }
+
+  sockaddr_un Addr;
+  if (!getSocketAddress(SocketPath, Addr, ErrMsg))
+    return false;
+
+  SmallString<256> CWD;
+  if (std::error_code EC = llvm::sys::fs::current_path(CWD)) {
+    if (ErrMsg)
+      *ErrMsg = "cannot determine the current directory: " + EC.message();
+    return false;
+  }
+
+  int FD = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (FD < 0)
+    return setError(ErrMsg, "cannot create socket");
+  if (::connect(FD, reinterpret_cast<sockaddr *>(&Addr), sizeof(Addr)) < 0) {
+    setError(ErrMsg, "cannot connect to compile server '" + SocketPath + "'");
+    ::close(FD);
+    return false;
+  }
+
+  SmallVector<const char *, 64> Env;
+  for (char **Var = getEnvironment(); *Var; ++Var)
+    Env.push_back(*Var);
+
+  JobHeader Header;
+  mode_t Mask = ::umask(0);
+  ::umask(Mask);
+  Header.Umask = Mask;
+  Header.NumEnv = Env.size();
+  Header.NumArgs = Argv.size();
+
+  bool Sent = sendHeader(FD, Header) && sendString(FD, CWD);
+  for (const char *Var : Env)
+    Sent = Sent && sendString(FD, Var);
+  for (const char *Arg : Argv)
+    Sent = Sent && sendString(FD, Arg);
+  if (!Sent) {
+    setError(ErrMsg, "cannot send job to compile server '" + SocketPath + "'");
+    ::close(FD);
+    return false;
+  }
+
+  // The server may refuse the job without starting it, in which case the
+  // caller can still run it.
+  uint32_t Ack;
+  if (!receiveAll(FD, &Ack, sizeof(Ack)) || Ack != JobAccepted) {
+    if (ErrMsg)
+      *ErrMsg = ("compile server '" + SocketPath + "' refused the job").str();
+    ::close(FD);
+    return false;
+  }
+
+  // From here on the server owns the job; if it does not report a status, the
+  // job crashed (or the server was killed while running it).
+  int32_t Status;
+  Result = receiveAll(FD, &Status, sizeof(Status)) ? Status : -1;
+  ::close(FD);
+  return true;
+}
+
+/// \brief Wait for the job \p Pid, terminating it if the client closes the
+/// connection \p Conn in the meantime, e.g., because the driver was
+/// interrupted.
+///
+/// \returns whether the job was waited for, with its status in \p Status.
+static bool waitForJob(pid_t Pid, int Conn, int &Status) {
+  bool Terminated = false;
+  while (true) {
+    pid_t Waited = ::waitpid(Pid, &Status, Terminated ? 0 : WNOHANG);
+    if (Waited == Pid)
+      return true;
+    if (Waited < 0 && errno != EINTR)
+      return false;
+    if (Terminated)
+      continue;
+
+    // The client sends nothing once the job has started, so the connection
+    // only becomes readable when it is closed.
+    pollfd PFD;
+    PFD.fd = Conn;
+    PFD.events = POLLIN;
+    PFD.revents = 0;
+    if (::poll(&PFD, 1, /*timeout=*/100) > 0) {
+      ::kill(Pid, SIGTERM);
+      Terminated = true;
+    }
+  }
+}
+
+/// \brief Run the job received on the connection \p Conn in a new process and
+/// report its status. This runs in a process forked for the connection.
+static void handleConnection(int Conn, JobFunc RunJob) {
+  JobHeader Header;
+  int FDs[NumStdFDs];
+  if (!receiveHeader(Conn, Header, FDs))
+    return;
+
+  // Closing the connection without an acknowledgement lets the client run the
+  // job itself.
+  std::vector<std::string> Strings;
+  bool Received = Header.NumArgs >= 1 && Header.NumArgs <= MaxStrings &&
+                  Header.NumEnv <= MaxStrings - Header.NumArgs;
+  if (Received) {
+    Strings.resize(1 + Header.NumEnv + Header.NumArgs);
+    for (std::string &S : Strings)
+      if (!(Received = receiveString(Conn, S)))
+        break;
+  }
+
+  if (Received) {
+    // The server ignores SIGCHLD to reap connection processes; we need to wait
+    // for the job.
+    ::signal(SIGCHLD, SIG_DFL);
+    pid_t Pid = ::fork();
+    if (Pid == 0) {
+      ::close(Conn);
+      for (unsigned I = 0; I != NumStdFDs; ++I) {
+        ::dup2(FDs[I], I);
+        ::close(FDs[I]);
+      }
+      if (::chdir(Strings[0].c_str()) != 0) {
+        llvm::errs() << "error: cannot change to directory '" << Strings[0]
+                     << "': " << strerror(errno) << '\n';
+        ::_exit(1);
+      }
+      ::umask(Header.Umask);
+
+      // Run the job in the client's environment rather than the server's.
+      std::vector<char *> Env;
+      for (unsigned I = 0; I != Header.NumEnv; ++I)
+        Env.push_back(&Strings[1 + I][0]);
+      Env.push_back(nullptr);
+      getEnvironment() = Env.data();
+
+      SmallVector<const char *, 256> Argv;
+      for (unsigned I = 1 + Header.NumEnv; I != Strings.size(); ++I)
+        Argv.push_back(Strings[I].c_str());
+      int Res = RunJob(Argv);
+      llvm::outs().flush();
+      ::fflush(nullptr);
+      ::_exit(Res);
+    }
+
+    // If the client is gone by now, waiting notices and stops the job.
+    int Status;
+    if (Pid > 0) {
+      sendAll(Conn, &JobAccepted, sizeof(JobAccepted));
+      if (waitForJob(Pid, Conn, Status) &&
+          (WIFEXITED(Status) || WIFSIGNALED(Status))) {
+        int32_t Result =
+            WIFEXITED(Status) ? WEXITSTATUS(Status) : -WTERMSIG(Status);
+        sendAll(Conn, &Result, sizeof(Result));
+      }
+    }
+  }
+
+  for (int FD : FDs)
+    ::close(FD);
+}
+
+/// Whether the peer of \p Conn runs as the same user as this process, and
+/// may thus run jobs as that user.
+static bool isPeerTrusted(int Conn) {
+#if !defined(HAVE_PEER_CREDENTIALS)
+  return false;
+#elif defined(SO_PEERCRED)
+  struct ucred Cred;
+  socklen_t Len = sizeof(Cred);
+  if (::getsockopt(Conn, SOL_SOCKET, SO_PEERCRED, &Cred, &Len) < 0)
+    return false;
+  return Cred.uid == ::geteuid();
+#else
+  uid_t UID;
+  gid_t GID;
+  if (::getpeereid(Conn, &UID, &GID) < 0)
+    return false;
+  return UID == ::geteuid();
+#endif
+}
+
+bool compile_server::serve(StringRef SocketPath, JobFunc RunJob,
+                           unsigned MaxJobs, std::string *ErrMsg) {
+  if (!isSupported()) {
+    if (ErrMsg)
+      *ErrMsg = "compile servers are not supported on this host";
+    return false;
+  }
+
+  sockaddr_un Addr;
+  if (!getSocketAddress(SocketPath, Addr, ErrMsg))
+    return false;
+
+  // Replace the socket of a previous server, but nothing else.
+  llvm::sys::fs::file_status Status;
+  if (!llvm::sys::fs::status(SocketPath, Status)) {
+    if (Status.type() != llvm::sys::fs::file_type::socket_file) {
+      if (ErrMsg)
+        *ErrMsg = ("'" + SocketPath + "' exists and is not a socket").str();
+      return false;
+    }
+    // sys::fs::remove refuses to remove sockets.
+    ::unlink(Addr.sun_path);
+  }
+
+  int Listen = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (Listen < 0)
+    return setError(ErrMsg, "cannot create socket");
+  // Only the user running the server may connect to it, since it runs jobs,
+  // which may write any file, as that user.
+  mode_t OldMask = ::umask(077);
+  int Bound =
+      ::bind(Listen, reinterpret_cast<sockaddr *>(&Addr), sizeof(Addr));
+  ::umask(OldMask);
+  if (Bound < 0 || ::listen(Listen, SOMAXCONN) < 0) {
+    setError(ErrMsg, "cannot listen on '" + SocketPath + "'");
+    ::close(Listen);
+    return false;
+  }
+
+  // Let the system reap the processes forked for each connection.
+  auto OldHandler = ::signal(SIGCHLD, SIG_IGN);
+
+  bool Success = true;
+  for (unsigned NumJobs = 0; !MaxJobs || NumJobs != MaxJobs;) {
+    int Conn = ::accept(Listen, nullptr, nullptr);
+    if (Conn < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      Success = setError(ErrMsg, "cannot accept connection");
+      break;
+    }
+    if (!isPeerTrusted(Conn)) {
+      ::close(Conn);
+      continue;
+    }
+
+    pid_t Pid = ::fork();
+    if (Pid == 0) {
+      ::close(Listen);
+      handleConnection(Conn, RunJob);
+      ::_exit(0);
+    }
+    ::close(Conn);
+    if (Pid < 0) {
+      Success = setError(ErrMsg, "cannot fork");
+      break;
+    }
+    ++NumJobs;
+  }
+
+  ::signal(SIGCHLD, OldHandler);
+  ::close(Listen);
+  ::unlink(Addr.sun_path);
+  return Success;
+}
+
+#else
+
+bool compile_server::isSupported() { return false; }
+
+bool compile_server::runJob(StringRef SocketPath, ArrayRef<const char *> Argv,
+                            int &Result, std::string *ErrMsg) {
+  if (ErrMsg)
+    *ErrMsg = "compile servers are not supported on this host";
+  return false;
+}
+
+bool compile_server::serve(StringRef SocketPath, JobFunc RunJob,
+                           unsigned MaxJobs, std::string *ErrMsg) {
+  if (ErrMsg)
+    *ErrMsg = "compile servers are not supported on this host";
+  return false;
+}
+
+#endif
@@ -60,7 +60,8 @@ Driver::Driver(StringRef ClangExecutable, StringRef DefaultTargetTriple,
       DriverTitle("clang LLVM compiler"), CCPrintOptionsFilename(nullptr),
       CCPrintHeadersFilename(nullptr), CCLogDiagnosticsFilename(nullptr),
       CCCPrintBindings(false), CCPrintHeaders(false), CCLogDiagnostics(false),
-      CCGenDiagnostics(false), DefaultTargetTriple(DefaultTargetTriple),
+      CCGenDiagnostics(false), CC1Main(nullptr),
+      DefaultTargetTriple(DefaultTargetTriple),
       CCCGenericGCCName(""), CheckInputsExist(true), CCCUsePCH(true),
       SuppressMissingInputWarning(false) {
 
@@ -2677,6 +2678,87 @@ Action *Driver::ConstructPhaseAction(Compilation &C, const ArgList &Args,
   llvm_unreachable("invalid phase in ConstructPhaseAction");
 }
 
+/// \brief If \p J is a -cc1 -batch-preprocess job with a single input, get
+/// its arguments which are not specific to that input, along with its input
+/// and output file.
+static bool getBatchPreprocessArgs(const Command &J, ArgStringList &SharedArgs,
+                                   const char *&Input, const char *&Output) {
+  const ArgStringList &Args = J.getArguments();
+  if (J.getInputFilenames().size() != 1 ||
+      llvm::none_of(Args, [](const char *A) {
+        return StringRef(A).startswith("-batch-preprocess=");
+      }))
+    return false;
+
+  Input = J.getInputFilenames().front();
+  Output = "-";
+  for (size_t I = 0, E = Args.size(); I != E; ++I) {
+    StringRef Arg = Args[I];
+    if (Args[I] == Input)
+      continue;
+    if ((Arg == "-o" || Arg == "-main-file-name") && I + 1 != E) {
+      if (Arg == "-o")
+        Output = Args[I + 1];
+      ++I;
+      continue;
+    }
+    SharedArgs.push_back(Args[I]);
+  }
+  return true;
+}
+
+/// \brief Merge the -batch-preprocess jobs that only differ by their input and
+/// output into a single job, which preprocesses all those inputs in parallel.
+static void mergeBatchPreprocessJobs(Compilation &C) {
+  auto SameArgs = [](const ArgStringList &A, const ArgStringList &B) {
+    return A.size() == B.size() &&
+           std::equal(A.begin(), A.end(), B.begin(),
+                      [](const char *X, const char *Y) {
+                        return StringRef(X) == Y;
+                      });
+  };
+
+  JobList::list_type &Jobs = C.getJobs().getJobs();
+  for (size_t I = 0; I != Jobs.size(); ++I) {
+    ArgStringList SharedArgs;
+    const char *Input, *Output;
+    if (!getBatchPreprocessArgs(*Jobs[I], SharedArgs, Input, Output))
+      continue;
+
+    ArgStringList Inputs(1, Input), Outputs(1, Output);
+    for (size_t J = I + 1; J != Jobs.size();) {
+      ArgStringList OtherArgs;
+      if (StringRef(Jobs[J]->getExecutable()) != Jobs[I]->getExecutable() ||
+          !getBatchPreprocessArgs(*Jobs[J], OtherArgs, Input, Output) ||
+          !SameArgs(SharedArgs, OtherArgs)) {
+        ++J;
+        continue;
+      }
+      // Preprocessing does not depend on any other job, so it can be moved
+      // ahead of the jobs in between.
+      Inputs.push_back(Input);
+      Outputs.push_back(Output);
+      Jobs.erase(Jobs.begin() + J);
+    }
+    // A job left on its own preprocesses its input as usual.
+    if (Inputs.size() == 1) {
+      ArgStringList Args;
+      for (const char *Arg : Jobs[I]->getArguments())
+        if (!StringRef(Arg).startswith("-batch-preprocess="))
+          Args.push_back(Arg);
+      Jobs[I]->replaceArguments(std::move(Args), std::move(Inputs));
+      continue;
+    }
+
+    for (const char *Output : Outputs) {
+      SharedArgs.push_back("-batch-output");
+      SharedArgs.push_back(Output);
+    }
+    SharedArgs.append(Inputs.begin(), Inputs.end());
+    Jobs[I]->replaceArguments(std::move(SharedArgs), std::move(Inputs));
+  }
+}
+
 void Driver::BuildJobs(Compilation &C) const {
   llvm::PrettyStackTraceString CrashInfo("Building compilation jobs");
 
@@ -2728,6 +2810,15 @@ void Driver::BuildJobs(Compilation &C) const {
                        /*TargetDeviceOffloadKind*/ Action::OFK_None);
   }
 
+  mergeBatchPreprocessJobs(C);
+
+  // Jobs run in-process share global state, such as LLVM's command line
+  // options, so only run a single job in-process.
+  if (llvm::count_if(C.getJobs(),
+                     [](const Command &J) { return J.InProcess; }) > 1)
+    for (Command &J : C.getJobs())
+      J.InProcess = false;
+
   // If the user passed -Qunused-arguments or there were errors, don't warn
   // about any unused arguments.
   if (Diags.hasErrorOccurred() ||
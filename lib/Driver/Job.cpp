@@ -9,6 +9,7 @@
 
 #include "clang/Driver/Job.h"
 #include "InputInfo.h"
+#include "clang/Driver/CompileServer.h"
 #include "clang/Driver/Driver.h"
 #include "clang/Driver/DriverDiagnostic.h"
 #include "clang/Driver/Tool.h"
@@ -19,9 +20,11 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
+#include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cassert>
 using namespace clang::driver;
@@ -33,7 +36,7 @@ Command::Command(const Action &Source, const Tool &Creator,
                  const char *Executable, const ArgStringList &Arguments,
                  ArrayRef<InputInfo> Inputs)
     : Source(Source), Creator(Creator), Executable(Executable),
-      Arguments(Arguments), ResponseFile(nullptr) {
+      Arguments(Arguments), ResponseFile(nullptr), InProcess(false) {
   for (const auto &II : Inputs)
     if (II.isFilename())
       InputFilenames.push_back(II.getFilename());
@@ -342,6 +345,65 @@ int Command::Execute(const StringRef **Redirects, std::string *ErrMsg,
                                    /*memoryLimit*/ 0, ErrMsg, ExecutionFailed);
 }
 
+CC1Command::CC1Command(const Action &Source, const Tool &Creator,
+                       const char *Executable,
+                       const ArgStringList &Arguments,
+                       ArrayRef<InputInfo> Inputs, bool InProcess)
+    : Command(Source, Creator, Executable, Arguments, Inputs),
+      CompileServer(nullptr) {
+  this->InProcess = InProcess;
+}
+
+void CC1Command::Print(raw_ostream &OS, const char *Terminator, bool Quote,
+                       CrashReportInfo *CrashInfo) const {
+  // Crash reproducer scripts always spawn the job.
+  if (InProcess && !CrashInfo)
+    OS << " (in-process)\n";
+  Command::Print(OS, Terminator, Quote, CrashInfo);
+}
+
+int CC1Command::Execute(const StringRef **Redirects, std::string *ErrMsg,
+                        bool *ExecutionFailed) const {
+  // Redirections are only used when rerunning jobs to generate crash
+  // diagnostics; spawn a process for those.
+  if (Redirects)
+    return Command::Execute(Redirects, ErrMsg, ExecutionFailed);
+
+  SmallVector<const char *, 128> Argv;
+  Argv.push_back(getExecutable());
+  Argv.append(getArguments().begin(), getArguments().end());
+
+  // If the compile server cannot be reached or refuses the job, run it here
+  // instead.
+  int Res;
+  if (CompileServer && compile_server::runJob(CompileServer, Argv, Res)) {
+    if (ExecutionFailed)
+      *ExecutionFailed = false;
+    return Res;
+  }
+
+  const Driver &D = getCreator().getToolChain().getDriver();
+  if (!InProcess || !D.CC1Main)
+    return Command::Execute(Redirects, ErrMsg, ExecutionFailed);
+
+  if (ExecutionFailed)
+    *ExecutionFailed = false;
+
+  // Report a crash in the frontend the way a crashed process would be
+  // reported, with a negative status, so that the driver still generates
+  // crash diagnostics.
+  llvm::CrashRecoveryContext::Enable();
+  llvm::CrashRecoveryContext CRC;
+  Res = 0;
+  if (!CRC.RunSafely([&] { Res = D.CC1Main(Argv); })) {
+    // The signal handlers of a crashed process would have removed the
+    // temporary and output files registered with RemoveFileOnSignal.
+    llvm::sys::RunInterruptHandlers();
+    return -1;
+  }
+  return Res;
+}
+
 FallbackCommand::FallbackCommand(const Action &Source_, const Tool &Creator_,
                                  const char *Executable_,
                                  const ArgStringList &Arguments_,
@@ -2899,6 +2899,8 @@ void Clang::DumpCompilationDatabase(Compilation &C, StringRef Filename,
   CDB << ", \"" << escape(Buf) << "\"]},\n";
 }
 
+static const char *getLDMOption(const llvm::Triple &T, const ArgList &Args);
+
 void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                          const InputInfo &Output, const InputInfoList &Inputs,
                          const ArgList &Args, const char *LinkingOutput) const {
@@ -3006,6 +3008,18 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
       if (Args.hasArg(options::OPT_rewrite_objc) &&
           !Args.hasArg(options::OPT_g_Group))
         CmdArgs.push_back("-P");
+
+      // With -fparallel-preprocess=N, the driver merges the -E jobs of all
+      // inputs into one that preprocesses them on N threads.
+      if (Arg *A = Args.getLastArg(options::OPT_fparallel_preprocess_EQ)) {
+        unsigned NumThreads;
+        if (StringRef(A->getValue()).getAsInteger(10, NumThreads))
+          D.Diag(diag::err_drv_invalid_int_value) << A->getAsString(Args)
+                                                  << A->getValue();
+        else if (NumThreads != 1)
+          CmdArgs.push_back(
+              Args.MakeArgString("-batch-preprocess=" + Twine(NumThreads)));
+      }
     }
   } else if (isa<AssembleJobAction>(JA)) {
     CmdArgs.push_back("-emit-obj");
@@ -3026,6 +3040,11 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
       CmdArgs.push_back("-emit-pch");
     else
       CmdArgs.push_back("-emit-pth");
+
+    if (UsePCH && JA.getType() == types::TY_PCH &&
+        Args.hasFlag(options::OPT_fpch_instantiate_templates,
+                     options::OPT_fno_pch_instantiate_templates, false))
+      CmdArgs.push_back("-fpch-instantiate-templates");
   } else if (isa<VerifyPCHJobAction>(JA)) {
     CmdArgs.push_back("-verify-pch");
   } else {
@@ -3783,6 +3802,13 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   RenderDebugEnablingArgs(Args, CmdArgs, DebugInfoKind, DwarfVersion,
                           DebuggerTuning);
 
+  // -gomit-unreferenced-methods only matters when types are described.
+  if ((DebugInfoKind == codegenoptions::LimitedDebugInfo ||
+       DebugInfoKind == codegenoptions::FullDebugInfo) &&
+      Args.hasFlag(options::OPT_gomit_unreferenced_methods,
+                   options::OPT_gno_omit_unreferenced_methods, false))
+    CmdArgs.push_back("-debug-omit-unreferenced-methods");
+
   // -fdebug-macro turns on macro debug info generation.
   if (Args.hasFlag(options::OPT_fdebug_macro, options::OPT_fno_debug_macro,
                    false))
@@ -4660,6 +4686,8 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   }
 
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_validate_system_headers);
+  Args.AddLastArg(CmdArgs, options::OPT_fmodules_content_store);
+  Args.AddLastArg(CmdArgs, options::OPT_fvalidate_ast_input_files_content);
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_disable_diagnostic_validation);
 
   // -faccess-control is default.
@@ -5312,8 +5340,38 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
       isa<CompileJobAction>(JA))
     CmdArgs.push_back("-disable-llvm-passes");
 
+  // With -fparallel-codegen=N, the backend splits the module into N
+  // partitions, generates an object for each of them in parallel, and a
+  // relocatable link merges them into the output.
+  SmallVector<const char *, 8> CodeGenPartitions;
+  if (Arg *A = Args.getLastArg(options::OPT_fparallel_codegen_EQ)) {
+    unsigned NumPartitions;
+    if (StringRef(A->getValue()).getAsInteger(10, NumPartitions) ||
+        NumPartitions == 0)
+      D.Diag(diag::err_drv_invalid_int_value) << A->getAsString(Args)
+                                              << A->getValue();
+    else if (NumPartitions > 1 && Output.isFilename() &&
+             Output.getType() == types::TY_Object && !SplitDwarfArg) {
+      if (!Triple.isOSBinFormatELF())
+        D.Diag(diag::err_drv_unsupported_opt_for_target)
+            << A->getAsString(Args) << TripleStr;
+      else
+        for (unsigned I = 0; I != NumPartitions; ++I)
+          CodeGenPartitions.push_back(C.addTempFile(Args.MakeArgString(
+              D.GetTemporaryPath(llvm::sys::path::stem(Output.getFilename()),
+                                 "o"))));
+    }
+  }
+
   if (Output.getType() == types::TY_Dependencies) {
     // Handled with other dependency code.
+  } else if (!CodeGenPartitions.empty()) {
+    CmdArgs.push_back("-o");
+    CmdArgs.push_back(CodeGenPartitions.front());
+    for (const char *Partition : makeArrayRef(CodeGenPartitions).drop_front()) {
+      CmdArgs.push_back("-parallel-codegen-output");
+      CmdArgs.push_back(Partition);
+    }
   } else if (Output.isFilename()) {
     CmdArgs.push_back("-o");
     CmdArgs.push_back(Output.getFilename());
@@ -5427,7 +5485,32 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     C.addCommand(llvm::make_unique<ForceSuccessCommand>(JA, *this, Exec,
                                                         CmdArgs, Inputs));
   } else {
-    C.addCommand(llvm::make_unique<Command>(JA, *this, Exec, CmdArgs, Inputs));
+    bool InProcess = Args.hasFlag(options::OPT_fintegrated_cc1,
+                                  options::OPT_fno_integrated_cc1, false);
+    auto Cmd = llvm::make_unique<CC1Command>(JA, *this, Exec, CmdArgs, Inputs,
+                                             InProcess);
+    if (Arg *A = Args.getLastArg(options::OPT_fcompile_server_EQ))
+      Cmd->setCompileServer(A->getValue());
+    C.addCommand(std::move(Cmd));
+  }
+
+  if (!CodeGenPartitions.empty()) {
+    ArgStringList LinkArgs;
+    LinkArgs.push_back("-r");
+    // Select the same emulation as the final link would, so the partial link
+    // of e.g. -m32 objects doesn't default to the host's format.
+    const llvm::Triple &LinkTriple = getToolChain().getTriple();
+    if (LinkTriple.isOSLinux())
+      if (const char *LDMOption = getLDMOption(LinkTriple, Args)) {
+        LinkArgs.push_back("-m");
+        LinkArgs.push_back(LDMOption);
+      }
+    LinkArgs.push_back("-o");
+    LinkArgs.push_back(Output.getFilename());
+    LinkArgs.append(CodeGenPartitions.begin(), CodeGenPartitions.end());
+    const char *Linker = Args.MakeArgString(getToolChain().GetLinkerPath());
+    C.addCommand(
+        llvm::make_unique<Command>(JA, *this, Linker, LinkArgs, Inputs));
   }
 
   // Handle the debug info splitting at object creation time if we're
@@ -36,6 +36,7 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSet.h"
+#include "llvm/Support/Capacity.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -623,6 +624,27 @@ IntrusiveRefCntPtr<ASTReader> ASTUnit::getASTReader() const {
   return Reader;
 }
 
+size_t ASTUnit::getPreambleMemory() const {
+  size_t Size = Preamble.size()
+    + llvm::capacity_in_bytes(TopLevelDeclsInPreamble)
+    + llvm::capacity_in_bytes(PreambleDiagnostics)
+    + FilesInPreamble.getAllocator().getTotalMemory();
+  if (PreambleBuffer)
+    Size += PreambleBuffer->getBufferSize();
+  return Size;
+}
+
+size_t ASTUnit::releaseCachedCompletionResults() {
+  size_t Size = llvm::capacity_in_bytes(CachedCompletionResults);
+  if (CachedCompletionAllocator)
+    Size += CachedCompletionAllocator->getTotalMemory();
+  ClearCachedCompletionResults();
+
+  // Make sure the next reparse repopulates the cache.
+  CompletionCacheTopLevelHashValue = 0;
+  return Size;
+}
+
 ASTMutationListener *ASTUnit::getASTMutationListener() {
   if (WriterData)
     return &WriterData->Writer;
@@ -660,7 +682,7 @@ std::unique_ptr<ASTUnit> ASTUnit::LoadFromASTFile(
     const FileSystemOptions &FileSystemOpts, bool UseDebugInfo,
     bool OnlyLocalDecls, ArrayRef<RemappedFile> RemappedFiles,
     bool CaptureDiagnostics, bool AllowPCHWithCompilerErrors,
-    bool UserFilesAreVolatile) {
+    bool UserFilesAreVolatile, std::shared_ptr<SourceBufferPool> BufferPool) {
   std::unique_ptr<ASTUnit> AST(new ASTUnit(true));
 
   // Recover resources if we crash before exiting this method.
@@ -678,9 +700,11 @@ std::unique_ptr<ASTUnit> ASTUnit::LoadFromASTFile(
   IntrusiveRefCntPtr<vfs::FileSystem> VFS = vfs::getRealFileSystem();
   AST->FileMgr = new FileManager(FileSystemOpts, VFS);
   AST->UserFilesAreVolatile = UserFilesAreVolatile;
+  AST->BufferPool = std::move(BufferPool);
   AST->SourceMgr = new SourceManager(AST->getDiagnostics(),
                                      AST->getFileManager(),
                                      UserFilesAreVolatile);
+  AST->SourceMgr->setBufferPool(AST->BufferPool);
   AST->HSOpts = std::make_shared<HeaderSearchOptions>();
   AST->HSOpts->ModuleFormat = PCHContainerRdr.getFormat();
   AST->HeaderInfo.reset(new HeaderSearch(AST->HSOpts,
@@ -1087,6 +1111,7 @@ bool ASTUnit::Parse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
   }
   SourceMgr = new SourceManager(getDiagnostics(), *FileMgr,
                                 UserFilesAreVolatile);
+  SourceMgr->setBufferPool(BufferPool);
   TheSema.reset();
   Ctx = nullptr;
   PP = nullptr;
@@ -1573,6 +1598,7 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
   // Create the source manager.
   Clang->setSourceManager(new SourceManager(getDiagnostics(),
                                             Clang->getFileManager()));
+  Clang->getSourceManager().setBufferPool(BufferPool);
 
   auto PreambleDepCollector = std::make_shared<DependencyCollector>();
   Clang->addDependencyCollector(PreambleDepCollector);
@@ -1713,7 +1739,8 @@ StringRef ASTUnit::getASTFileName() const {
 std::unique_ptr<ASTUnit>
 ASTUnit::create(std::shared_ptr<CompilerInvocation> CI,
                 IntrusiveRefCntPtr<DiagnosticsEngine> Diags,
-                bool CaptureDiagnostics, bool UserFilesAreVolatile) {
+                bool CaptureDiagnostics, bool UserFilesAreVolatile,
+                std::shared_ptr<SourceBufferPool> BufferPool) {
   std::unique_ptr<ASTUnit> AST(new ASTUnit(false));
   ConfigureDiags(Diags, *AST, CaptureDiagnostics);
   IntrusiveRefCntPtr<vfs::FileSystem> VFS =
@@ -1725,8 +1752,10 @@ ASTUnit::create(std::shared_ptr<CompilerInvocation> CI,
   AST->Invocation = std::move(CI);
   AST->FileMgr = new FileManager(AST->FileSystemOpts, VFS);
   AST->UserFilesAreVolatile = UserFilesAreVolatile;
+  AST->BufferPool = std::move(BufferPool);
   AST->SourceMgr = new SourceManager(AST->getDiagnostics(), *AST->FileMgr,
                                      UserFilesAreVolatile);
+  AST->SourceMgr->setBufferPool(AST->BufferPool);
 
   return AST;
 }
@@ -1950,8 +1979,10 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
     unsigned PrecompilePreambleAfterNParses, TranslationUnitKind TUKind,
     bool CacheCodeCompletionResults, bool IncludeBriefCommentsInCodeCompletion,
     bool AllowPCHWithCompilerErrors, bool SkipFunctionBodies,
-    bool UserFilesAreVolatile, bool ForSerialization,
-    llvm::Optional<StringRef> ModuleFormat, std::unique_ptr<ASTUnit> *ErrAST) {
+    bool KeepMainFileFunctionBodies, bool UserFilesAreVolatile,
+    bool ForSerialization,
+    llvm::Optional<StringRef> ModuleFormat, std::unique_ptr<ASTUnit> *ErrAST,
+    std::shared_ptr<SourceBufferPool> BufferPool) {
   assert(Diags.get() && "no DiagnosticsEngine was provided");
 
   SmallVector<StoredDiagnostic, 4> StoredDiagnostics;
@@ -1982,6 +2013,8 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
   CI->getHeaderSearchOpts().ResourceDir = ResourceFilesPath;
 
   CI->getFrontendOpts().SkipFunctionBodies = SkipFunctionBodies;
+  CI->getFrontendOpts().KeepMainFileFunctionBodies =
+      KeepMainFileFunctionBodies;
 
   if (ModuleFormat)
     CI->getHeaderSearchOpts().ModuleFormat = ModuleFormat.getValue();
@@ -2004,6 +2037,7 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
   AST->IncludeBriefCommentsInCodeCompletion
     = IncludeBriefCommentsInCodeCompletion;
   AST->UserFilesAreVolatile = UserFilesAreVolatile;
+  AST->BufferPool = std::move(BufferPool);
   AST->NumStoredDiagnosticsFromDriver = StoredDiagnostics.size();
   AST->StoredDiagnostics.swap(StoredDiagnostics);
   AST->Invocation = CI;
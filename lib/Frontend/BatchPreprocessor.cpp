@@ -0,0 +1,272 @@
+//===--- BatchPreprocessor.cpp - Parallel preprocessing of inputs ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/BatchPreprocessor.h"
+#include "clang/Basic/VirtualFileSystem.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <future>
+#include <mutex>
+#include <thread>
+
+using namespace clang;
+
+namespace {
+
+/// \brief A file system that caches the status and the contents of the files
+/// of another file system, so that the compiler instances of a batch, which
+/// each have their own FileManager, only stat and read each file once.
+///
+/// Unlike FileManager, this cache is thread-safe. It assumes that the files
+/// do not change while the batch is running.
+class SharedFileSystemCache : public vfs::FileSystem {
+  IntrusiveRefCntPtr<vfs::FileSystem> FS;
+
+  std::mutex Mutex;
+
+  /// \brief The results of status(), including the paths that do not exist.
+  llvm::StringMap<llvm::ErrorOr<vfs::Status>> Stats;
+
+  /// \brief The status of the files opened with openFileForRead(), including
+  /// the ones that could not be opened.
+  llvm::StringMap<llvm::ErrorOr<vfs::Status>> OpenedFiles;
+
+  /// \brief The contents of the files that were read.
+  llvm::StringMap<std::unique_ptr<llvm::MemoryBuffer>> Contents;
+
+public:
+  explicit SharedFileSystemCache(IntrusiveRefCntPtr<vfs::FileSystem> FS)
+      : FS(std::move(FS)) {}
+
+  llvm::ErrorOr<vfs::Status> status(const Twine &Path) override {
+    SmallString<256> Storage;
+    StringRef P = Path.toStringRef(Storage);
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      auto Known = Stats.find(P);
+      if (Known != Stats.end())
+        return Known->second;
+    }
+
+    // Don't hold the lock while going to the file system. If another thread
+    // got there first, keep its result.
+    llvm::ErrorOr<vfs::Status> Status = FS->status(P);
+    std::lock_guard<std::mutex> Lock(Mutex);
+    return Stats.insert(std::make_pair(P, std::move(Status))).first->second;
+  }
+
+  llvm::ErrorOr<std::unique_ptr<vfs::File>>
+  openFileForRead(const Twine &Path) override;
+
+  vfs::directory_iterator dir_begin(const Twine &Dir,
+                                    std::error_code &EC) override {
+    return FS->dir_begin(Dir, EC);
+  }
+
+  std::error_code setCurrentWorkingDirectory(const Twine &Path) override {
+    // The working directory is shared by all the instances of the batch.
+    return std::make_error_code(std::errc::operation_not_permitted);
+  }
+
+  llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override {
+    return FS->getCurrentWorkingDirectory();
+  }
+
+  /// \brief Get the contents of the file at \p Path, reading it if no other
+  /// instance did yet.
+  llvm::ErrorOr<StringRef> getContents(StringRef Path) {
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      auto Known = Contents.find(Path);
+      if (Known != Contents.end())
+        return Known->second->getBuffer();
+    }
+
+    auto Buffer = FS->getBufferForFile(Path);
+    if (!Buffer)
+      return Buffer.getError();
+    std::lock_guard<std::mutex> Lock(Mutex);
+    return Contents.insert(std::make_pair(Path, std::move(*Buffer)))
+        .first->second->getBuffer();
+  }
+};
+
+/// \brief A file opened through a SharedFileSystemCache.
+class SharedFile : public vfs::File {
+  SharedFileSystemCache &Cache;
+  vfs::Status Status;
+  std::string Path;
+
+public:
+  SharedFile(SharedFileSystemCache &Cache, vfs::Status Status, StringRef Path)
+      : Cache(Cache), Status(std::move(Status)), Path(Path) {}
+  ~SharedFile() override { close(); }
+
+  llvm::ErrorOr<vfs::Status> status() override { return Status; }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+  getBuffer(const Twine &Name, int64_t FileSize, bool RequiresNullTerminator,
+            bool IsVolatile) override {
+    llvm::ErrorOr<StringRef> Contents = Cache.getContents(Path);
+    if (!Contents)
+      return Contents.getError();
+    // The cached buffer is always null terminated.
+    return llvm::MemoryBuffer::getMemBuffer(*Contents, Name.str(),
+                                            RequiresNullTerminator);
+  }
+
+  std::error_code close() override { return std::error_code(); }
+};
+
+} // end anonymous namespace
+
+llvm::ErrorOr<std::unique_ptr<vfs::File>>
+SharedFileSystemCache::openFileForRead(const Twine &Path) {
+  SmallString<256> Storage;
+  StringRef P = Path.toStringRef(Storage);
+  Optional<llvm::ErrorOr<vfs::Status>> Status;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto Known = OpenedFiles.find(P);
+    if (Known != OpenedFiles.end())
+      Status = Known->second;
+  }
+
+  if (!Status) {
+    // Only open the file to get its status; the contents are read on demand,
+    // as the file may be a directory or a header that is skipped entirely.
+    auto File = FS->openFileForRead(P);
+    llvm::ErrorOr<vfs::Status> Opened =
+        File ? (*File)->status() : llvm::ErrorOr<vfs::Status>(File.getError());
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Status = OpenedFiles.insert(std::make_pair(P, std::move(Opened)))
+                 .first->second;
+  }
+
+  if (!*Status)
+    return Status->getError();
+  return std::unique_ptr<vfs::File>(new SharedFile(*this, **Status, P));
+}
+
+/// \brief Preprocess \p Input with the options of \p Invocation, writing the
+/// result to \p OutputFile and the diagnostics to \p DiagText.
+static bool preprocessInput(const CompilerInvocation &Invocation,
+                            const FrontendInputFile &Input,
+                            StringRef OutputFile,
+                            IntrusiveRefCntPtr<vfs::FileSystem> FS,
+                            std::string &DiagText) {
+  auto Inv = std::make_shared<CompilerInvocation>(Invocation);
+  FrontendOptions &FEOpts = Inv->getFrontendOpts();
+  FEOpts.Inputs.assign(1, Input);
+  FEOpts.OutputFile = OutputFile;
+  FEOpts.BatchPreprocess = false;
+  FEOpts.BatchOutputFiles.clear();
+  // There may be many instances in the process, so free each one.
+  FEOpts.DisableFree = false;
+
+  llvm::raw_string_ostream OS(DiagText);
+  CompilerInstance Clang;
+  Clang.setInvocation(std::move(Inv));
+  Clang.createDiagnostics(
+      new TextDiagnosticPrinter(OS, &Clang.getDiagnosticOpts()));
+  Clang.setVerboseOutputStream(OS);
+  Clang.setVirtualFileSystem(std::move(FS));
+
+  PrintPreprocessedAction Act;
+  bool Success = Clang.ExecuteAction(Act);
+  OS.flush();
+  return Success;
+}
+
+namespace {
+/// \brief The state of one input of the batch.
+struct BatchJob {
+  /// \brief If not empty, the temporary file that the output is written to
+  /// before it is copied to standard output.
+  SmallString<128> TempFile;
+  std::string Diagnostics;
+  std::shared_future<void> Done;
+  bool Success = false;
+};
+} // end anonymous namespace
+
+bool clang::preprocessBatch(const CompilerInvocation &Invocation,
+                            DiagnosticsEngine &Diags) {
+  const FrontendOptions &FEOpts = Invocation.getFrontendOpts();
+  IntrusiveRefCntPtr<vfs::FileSystem> BaseFS =
+      createVFSFromCompilerInvocation(Invocation, Diags);
+  if (!BaseFS)
+    return false;
+  IntrusiveRefCntPtr<vfs::FileSystem> FS(new SharedFileSystemCache(BaseFS));
+
+  unsigned NumThreads = FEOpts.BatchPreprocessThreads;
+  if (NumThreads == 0)
+    NumThreads = std::max(1U, std::thread::hardware_concurrency());
+
+  std::vector<BatchJob> Jobs(FEOpts.Inputs.size());
+  llvm::ThreadPool Pool(NumThreads);
+  for (size_t I = 0, N = Jobs.size(); I != N; ++I) {
+    BatchJob &Job = Jobs[I];
+    StringRef OutputFile = "-";
+    if (I < FEOpts.BatchOutputFiles.size())
+      OutputFile = FEOpts.BatchOutputFiles[I];
+    else if (N == 1 && !FEOpts.OutputFile.empty())
+      OutputFile = FEOpts.OutputFile;
+
+    // Outputs to standard output would be interleaved, so write them to a
+    // temporary file and copy them to standard output in input order.
+    if (OutputFile == "-") {
+      if (std::error_code EC = llvm::sys::fs::createTemporaryFile(
+              "preprocessed", "i", Job.TempFile)) {
+        Diags.Report(diag::err_fe_unable_to_open_output) << "-"
+                                                         << EC.message();
+        continue;
+      }
+      OutputFile = Job.TempFile;
+    }
+
+    const FrontendInputFile &Input = FEOpts.Inputs[I];
+    Job.Done = Pool.async([&Invocation, &Input, OutputFile, FS, &Job] {
+      Job.Success =
+          preprocessInput(Invocation, Input, OutputFile, FS, Job.Diagnostics);
+    });
+  }
+
+  // Emit the results of each input as soon as it and those before it are
+  // done.
+  bool Success = true;
+  for (BatchJob &Job : Jobs) {
+    if (!Job.Done.valid()) {
+      Success = false;
+      continue;
+    }
+    Job.Done.wait();
+    Success &= Job.Success;
+    llvm::errs() << Job.Diagnostics;
+    if (Job.TempFile.empty())
+      continue;
+
+    if (auto Buffer = llvm::MemoryBuffer::getFile(Job.TempFile))
+      llvm::outs() << (*Buffer)->getBuffer();
+    llvm::outs().flush();
+    llvm::sys::fs::remove(Job.TempFile);
+  }
+  return Success;
+}
@@ -0,0 +1,165 @@
+//===--- DependencyScanningFileSystem.cpp - Minimized sources -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/DependencyScanningFileSystem.h"
+#include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/Path.h"
+
+using namespace clang;
+
+static vfs::Status getStatusWithSize(const vfs::Status &Status,
+                                     uint64_t Size) {
+  return vfs::Status(Status.getName(), Status.getUniqueID(),
+                     Status.getLastModificationTime(), Status.getUser(),
+                     Status.getGroup(), Size, Status.getType(),
+                     Status.getPermissions());
+}
+
+static std::unique_ptr<DependencyScanningCache::Entry>
+createEntry(StringRef Path, vfs::FileSystem &FS) {
+  auto Result = llvm::make_unique<DependencyScanningCache::Entry>(
+      FS.status(Path));
+  llvm::ErrorOr<vfs::Status> &Status = Result->Status;
+  if (!Status || !Status->isRegularFile() ||
+      !DependencyScanningCache::shouldMinimize(Path))
+    return Result;
+
+  auto Buffer = FS.getBufferForFile(Path);
+  if (!Buffer) {
+    Status = Buffer.getError();
+    return Result;
+  }
+
+  SmallString<0> Minimized;
+  if (minimizeSourceToDependencyDirectives((*Buffer)->getBuffer(), Minimized))
+    Result->Contents = std::move(*Buffer);
+  else
+    Result->Contents = llvm::MemoryBuffer::getMemBufferCopy(
+        Minimized, (*Buffer)->getBufferIdentifier());
+  Status = getStatusWithSize(*Status, Result->Contents->getBufferSize());
+  return Result;
+}
+
+const DependencyScanningCache::Entry &
+DependencyScanningCache::getEntry(StringRef Path, vfs::FileSystem &FS) {
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto Known = Entries.find(Path);
+    if (Known != Entries.end())
+      return *Known->second;
+  }
+
+  // Don't hold the lock while reading and minimizing the file. If another
+  // scan got there first, keep its entry.
+  std::unique_ptr<Entry> Created = createEntry(Path, FS);
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return *Entries.insert(std::make_pair(Path, std::move(Created)))
+              .first->second;
+}
+
+bool DependencyScanningCache::shouldMinimize(StringRef Path) {
+  return !llvm::StringSwitch<bool>(llvm::sys::path::extension(Path))
+              .Cases(".modulemap", ".map", ".hmap", true)
+              .Cases(".pch", ".gch", ".pcm", ".pth", true)
+              .Cases(".yaml", ".json", true)
+              .Default(false);
+}
+
+namespace {
+/// \brief A file whose contents are cached by a DependencyScanningCache.
+class CachedFile : public vfs::File {
+  vfs::Status Status;
+  const llvm::MemoryBuffer &Contents;
+
+public:
+  CachedFile(vfs::Status Status, const llvm::MemoryBuffer &Contents)
+      : Status(std::move(Status)), Contents(Contents) {}
+  ~CachedFile() override { close(); }
+
+  llvm::ErrorOr<vfs::Status> status() override { return Status; }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+  getBuffer(const Twine &Name, int64_t FileSize, bool RequiresNullTerminator,
+            bool IsVolatile) override {
+    return llvm::MemoryBuffer::getMemBuffer(Contents.getBuffer(), Name.str(),
+                                            RequiresNullTerminator);
+  }
+
+  std::error_code close() override { return std::error_code(); }
+};
+} // end anonymous namespace
+
+DependencyScanningFileSystem::DependencyScanningFileSystem(
+    std::shared_ptr<DependencyScanningCache> Cache,
+    IntrusiveRefCntPtr<vfs::FileSystem> FS)
+    : Cache(std::move(Cache)), FS(std::move(FS)) {
+  if (llvm::ErrorOr<std::string> CWD = this->FS->getCurrentWorkingDirectory())
+    WorkingDirectory = *CWD;
+}
+
+const DependencyScanningCache::Entry &
+DependencyScanningFileSystem::getEntry(const Twine &Path) {
+  // The cache is shared by scans in different working directories.
+  SmallString<256> AbsolutePath;
+  Path.toVector(AbsolutePath);
+  makeAbsolute(AbsolutePath);
+  llvm::sys::path::remove_dots(AbsolutePath, /*remove_dot_dot=*/false);
+  return Cache->getEntry(AbsolutePath, *FS);
+}
+
+llvm::ErrorOr<vfs::Status>
+DependencyScanningFileSystem::status(const Twine &Path) {
+  const DependencyScanningCache::Entry &Entry = getEntry(Path);
+  if (!Entry.Status)
+    return Entry.Status.getError();
+  // Keep the name as it was spelled, as the file manager uses it.
+  return vfs::Status::copyWithNewName(*Entry.Status, Path.str());
+}
+
+llvm::ErrorOr<std::unique_ptr<vfs::File>>
+DependencyScanningFileSystem::openFileForRead(const Twine &Path) {
+  const DependencyScanningCache::Entry &Entry = getEntry(Path);
+  if (!Entry.Status)
+    return Entry.Status.getError();
+  if (!Entry.Contents) {
+    SmallString<256> AbsolutePath;
+    Path.toVector(AbsolutePath);
+    makeAbsolute(AbsolutePath);
+    return FS->openFileForRead(AbsolutePath);
+  }
+  return std::unique_ptr<vfs::File>(new CachedFile(
+      vfs::Status::copyWithNewName(*Entry.Status, Path.str()),
+      *Entry.Contents));
+}
+
+vfs::directory_iterator
+DependencyScanningFileSystem::dir_begin(const Twine &Dir,
+                                        std::error_code &EC) {
+  SmallString<256> AbsoluteDir;
+  Dir.toVector(AbsoluteDir);
+  makeAbsolute(AbsoluteDir);
+  return FS->dir_begin(AbsoluteDir, EC);
+}
+
+std::error_code
+DependencyScanningFileSystem::setCurrentWorkingDirectory(const Twine &Path) {
+  SmallString<256> AbsolutePath;
+  Path.toVector(AbsolutePath);
+  if (std::error_code EC = makeAbsolute(AbsolutePath))
+    return EC;
+  WorkingDirectory = AbsolutePath.str();
+  return std::error_code();
+}
+
+llvm::ErrorOr<std::string>
+DependencyScanningFileSystem::getCurrentWorkingDirectory() const {
+  return WorkingDirectory;
+}
@@ -22,6 +22,7 @@
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Parse/ParseAST.h"
+#include "clang/Sema/Sema.h"
 #include "clang/Serialization/ASTDeserializationListener.h"
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
@@ -564,8 +565,13 @@ void ASTFrontendAction::ExecuteAction() {
   if (!CI.hasSema())
     CI.createSema(getTranslationUnitKind(), CompletionConsumer);
 
-  ParseAST(CI.getSema(), CI.getFrontendOpts().ShowStats,
-           CI.getFrontendOpts().SkipFunctionBodies);
+  const FrontendOptions &FEOpts = CI.getFrontendOpts();
+  Sema &S = CI.getSema();
+  S.KeepMainFileFunctionBodies = FEOpts.KeepMainFileFunctionBodies;
+  S.KeptFunctionBodyLines.assign(FEOpts.KeptFunctionBodyLines.begin(),
+                                 FEOpts.KeptFunctionBodyLines.end());
+
+  ParseAST(S, FEOpts.ShowStats, FEOpts.SkipFunctionBodies);
 }
 
 void PluginASTAction::anchor() { }
@@ -12,6 +12,7 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Frontend/ASTConsumers.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/DependencyScanningFileSystem.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/MultiplexConsumer.h"
 #include "clang/Frontend/Utils.h"
@@ -723,6 +724,34 @@ void PreprocessOnlyAction::ExecuteAction() {
   } while (Tok.isNot(tok::eof));
 }
 
+bool ScanDependenciesAction::BeginInvocation(CompilerInstance &CI) {
+  // The sizes of the minimized sources don't match the ones recorded in
+  // precompiled files, and modules built from them only contain macros, so
+  // keep those modules apart from the ones of regular compiles.
+  CI.getPreprocessorOpts().DisablePCHValidation = true;
+  std::string &ModuleCachePath = CI.getHeaderSearchOpts().ModuleCachePath;
+  if (!ModuleCachePath.empty() &&
+      llvm::sys::path::filename(ModuleCachePath) != "dependency-scan") {
+    SmallString<128> Path(ModuleCachePath);
+    llvm::sys::path::append(Path, "dependency-scan");
+    ModuleCachePath = Path.str();
+  }
+
+  if (CI.hasFileManager())
+    return true;
+  IntrusiveRefCntPtr<vfs::FileSystem> FS;
+  if (CI.hasVirtualFileSystem())
+    FS = &CI.getVirtualFileSystem();
+  else
+    FS = createVFSFromCompilerInvocation(CI.getInvocation(),
+                                         CI.getDiagnostics());
+  if (!FS)
+    return false;
+  CI.setVirtualFileSystem(new DependencyScanningFileSystem(
+      std::make_shared<DependencyScanningCache>(), std::move(FS)));
+  return true;
+}
+
 void PrintPreprocessedAction::ExecuteAction() {
   CompilerInstance &CI = getCompilerInstance();
   // Output file may need to be set to 'Binary', to avoid converting Unix style
@@ -8,7 +8,6 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Frontend/SerializedDiagnosticReader.h"
-#include "clang/Basic/FileManager.h"
 #include "clang/Frontend/SerializedDiagnostics.h"
 #include "llvm/Support/ManagedStatic.h"
 
@@ -16,15 +15,19 @@ using namespace clang;
 using namespace clang::serialized_diags;
 
 std::error_code SerializedDiagnosticReader::readDiagnostics(StringRef File) {
-  // Open the diagnostics file.
-  FileSystemOptions FO;
-  FileManager FileMgr(FO);
-
-  auto Buffer = FileMgr.getBufferForFile(File);
+  // Open the diagnostics file. The bitstream reader does not need a null
+  // terminator, which lets large files be mapped rather than copied.
+  auto Buffer = llvm::MemoryBuffer::getFile(File, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
   if (!Buffer)
     return SDError::CouldNotLoad;
 
-  llvm::BitstreamCursor Stream(**Buffer);
+  return readDiagnostics((*Buffer)->getMemBufferRef());
+}
+
+std::error_code
+SerializedDiagnosticReader::readDiagnostics(llvm::MemoryBufferRef Buffer) {
+  llvm::BitstreamCursor Stream(Buffer);
   Optional<llvm::BitstreamBlockInfo> BlockInfo;
 
   // Sniff for the signature.
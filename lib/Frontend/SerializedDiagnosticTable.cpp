@@ -0,0 +1,200 @@
+//===--- SerializedDiagnosticTable.cpp - Aggregated diagnostics -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/SerializedDiagnosticTable.h"
+#include "clang/Frontend/SerializedDiagnosticReader.h"
+#include "llvm/Support/ThreadPool.h"
+#include <algorithm>
+#include <thread>
+
+using namespace clang;
+using namespace clang::serialized_diags;
+
+/// \brief A diagnostic decoded from a single source, whose strings still
+/// point into that source's buffer.
+struct SerializedDiagnosticTable::PendingDiagnostic {
+  unsigned Severity;
+  StringRef File;
+  unsigned Line;
+  unsigned Column;
+  StringRef Category;
+  StringRef Flag;
+  StringRef Message;
+};
+
+/// \brief Decodes the top-level diagnostics of a single source, resolving the
+/// file, flag and category IDs that are local to that source.
+class SerializedDiagnosticTable::DiagnosticCollector
+    : public SerializedDiagnosticReader {
+  llvm::DenseMap<unsigned, StringRef> FileNames;
+  llvm::DenseMap<unsigned, StringRef> FlagNames;
+  llvm::DenseMap<unsigned, StringRef> CategoryNames;
+  unsigned Depth = 0;
+
+public:
+  std::vector<PendingDiagnostic> Diags;
+
+protected:
+  std::error_code visitStartOfDiagnostic() override {
+    ++Depth;
+    return std::error_code();
+  }
+
+  std::error_code visitEndOfDiagnostic() override {
+    --Depth;
+    return std::error_code();
+  }
+
+  std::error_code visitCategoryRecord(unsigned ID, StringRef Name) override {
+    CategoryNames[ID] = Name;
+    return std::error_code();
+  }
+
+  std::error_code visitDiagFlagRecord(unsigned ID, StringRef Name) override {
+    FlagNames[ID] = Name;
+    return std::error_code();
+  }
+
+  std::error_code visitFilenameRecord(unsigned ID, unsigned Size,
+                                      unsigned Timestamp,
+                                      StringRef Name) override {
+    FileNames[ID] = Name;
+    return std::error_code();
+  }
+
+  std::error_code visitDiagnosticRecord(unsigned Severity,
+                                        const Location &Location,
+                                        unsigned Category, unsigned Flag,
+                                        StringRef Message) override {
+    // Notes are nested within the diagnostic they are attached to.
+    if (Depth != 1)
+      return std::error_code();
+
+    PendingDiagnostic Diag;
+    Diag.Severity = Severity;
+    Diag.File = FileNames.lookup(Location.FileID);
+    Diag.Line = Location.Line;
+    Diag.Column = Location.Col;
+    Diag.Category = CategoryNames.lookup(Category);
+    Diag.Flag = FlagNames.lookup(Flag);
+    Diag.Message = Message;
+    Diags.push_back(Diag);
+    return std::error_code();
+  }
+};
+
+SerializedDiagnosticTable::SerializedDiagnosticTable() : NumDiagnosticsRead(0) {
+  // The empty string always has ID 0.
+  intern("");
+}
+
+unsigned SerializedDiagnosticTable::intern(StringRef S) {
+  auto Known = StringIDs.insert(std::make_pair(S, Strings.size()));
+  if (Known.second)
+    Strings.push_back(Known.first->getKey());
+  return Known.first->second;
+}
+
+void SerializedDiagnosticTable::merge(StringRef SourceName,
+                                      ArrayRef<PendingDiagnostic> Diags) {
+  unsigned Source = Sources.size();
+  Sources.push_back(intern(SourceName));
+  NumDiagnosticsRead += Diags.size();
+
+  for (const PendingDiagnostic &Diag : Diags) {
+    DiagnosticKey Key = {Diag.Severity, intern(Diag.File),
+                         Diag.Line,     Diag.Column,
+                         intern(Diag.Flag), intern(Diag.Message)};
+    auto Known = Rows.insert(std::make_pair(Key, (unsigned)Severities.size()));
+    if (!Known.second) {
+      ++Occurrences[Known.first->second];
+      continue;
+    }
+
+    Severities.push_back(Key.Severity);
+    Files.push_back(Key.File);
+    Lines.push_back(Key.Line);
+    Columns.push_back(Key.Column);
+    Categories.push_back(intern(Diag.Category));
+    Flags.push_back(Key.Flag);
+    Messages.push_back(Key.Message);
+    Occurrences.push_back(1);
+    FirstSources.push_back(Source);
+  }
+}
+
+std::error_code
+SerializedDiagnosticTable::addBuffer(llvm::MemoryBufferRef Buffer,
+                                     StringRef SourceName) {
+  DiagnosticCollector Collector;
+  if (std::error_code EC = Collector.readDiagnostics(Buffer))
+    return EC;
+
+  merge(SourceName, Collector.Diags);
+  return std::error_code();
+}
+
+std::error_code SerializedDiagnosticTable::addFile(StringRef File) {
+  auto Buffer = llvm::MemoryBuffer::getFile(File, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
+  if (!Buffer)
+    return SDError::CouldNotLoad;
+
+  return addBuffer((*Buffer)->getMemBufferRef(), File);
+}
+
+unsigned SerializedDiagnosticTable::addFiles(ArrayRef<std::string> Paths,
+                                             unsigned NumThreads) {
+  if (NumThreads == 0)
+    NumThreads = std::max(1U, std::thread::hardware_concurrency());
+
+  // Decode a bounded batch of files concurrently, then merge that batch
+  // serially in order, so that only a batch worth of buffers is live at once.
+  struct DecodedFile {
+    std::unique_ptr<llvm::MemoryBuffer> Buffer;
+    DiagnosticCollector Collector;
+    bool Failed = false;
+  };
+  const size_t BatchSize = 8 * NumThreads;
+
+  llvm::ThreadPool Pool(NumThreads);
+  unsigned NumFailed = 0;
+  for (size_t Begin = 0, N = Paths.size(); Begin < N; Begin += BatchSize) {
+    size_t End = std::min(N, Begin + BatchSize);
+    std::vector<DecodedFile> Batch(End - Begin);
+
+    for (size_t I = Begin; I != End; ++I) {
+      Pool.async([&Paths, &Batch, Begin, I] {
+        DecodedFile &Decoded = Batch[I - Begin];
+        auto Buffer = llvm::MemoryBuffer::getFile(
+            Paths[I], /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
+        if (!Buffer) {
+          Decoded.Failed = true;
+          return;
+        }
+        Decoded.Buffer = std::move(*Buffer);
+        if (Decoded.Collector.readDiagnostics(
+                Decoded.Buffer->getMemBufferRef()))
+          Decoded.Failed = true;
+      });
+    }
+    Pool.wait();
+
+    for (size_t I = Begin; I != End; ++I) {
+      DecodedFile &Decoded = Batch[I - Begin];
+      if (Decoded.Failed) {
+        ++NumFailed;
+        continue;
+      }
+      merge(Paths[I], Decoded.Collector.Diags);
+    }
+  }
+
+  return NumFailed;
+}
@@ -16,6 +16,7 @@
 #include "clang/ARCMigrate/ARCMTActions.h"
 #include "clang/CodeGen/CodeGenAction.h"
 #include "clang/Driver/Options.h"
+#include "clang/Frontend/BatchPreprocessor.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/CompilerInvocation.h"
 #include "clang/Frontend/FrontendActions.h"
@@ -109,6 +110,7 @@ CreateFrontendBaseAction(CompilerInstance &CI) {
   case RunAnalysis:            Action = "RunAnalysis"; break;
 #endif
   case RunPreprocessorOnly:    return llvm::make_unique<PreprocessOnlyAction>();
+  case ScanDependencies:       return llvm::make_unique<ScanDependenciesAction>();
   }
 
 #if !defined(CLANG_ENABLE_ARCMT) || !defined(CLANG_ENABLE_STATIC_ANALYZER) \
@@ -242,6 +244,11 @@ bool clang::ExecuteCompilerInvocation(CompilerInstance *Clang) {
   // If there were errors in processing arguments, don't do anything else.
   if (Clang->getDiagnostics().hasErrorOccurred())
     return false;
+
+  // Preprocess each input as its own translation unit.
+  if (Clang->getFrontendOpts().BatchPreprocess)
+    return preprocessBatch(Clang->getInvocation(), Clang->getDiagnostics());
+
   // Create and execute the frontend action.
   std::unique_ptr<FrontendAction> Act(CreateFrontendAction(*Clang));
   if (!Act)
@@ -18,8 +18,11 @@
 #include "clang/AST/Mangle.h"
 #include "clang/AST/VTableBuilder.h"
 #include "clang/Basic/TargetInfo.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Mangler.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
@@ -29,11 +32,29 @@ struct CodegenNameGenerator::Implementation {
   std::unique_ptr<MangleContext> MC;
   llvm::DataLayout DL;
 
+  /// The names written so far, along with whether writing them failed.
+  llvm::DenseMap<const Decl *, std::pair<StringRef, bool>> Names;
+  llvm::BumpPtrAllocator NameAlloc;
+
   Implementation(ASTContext &Ctx)
     : MC(Ctx.createMangleContext()),
       DL(Ctx.getTargetInfo().getDataLayout()) {}
 
   bool writeName(const Decl *D, raw_ostream &OS) {
+    // Indexers ask for the name of a declaration at each of its occurrences,
+    // so only mangle each declaration once.
+    auto Known = Names.find(D);
+    if (Known == Names.end()) {
+      SmallString<128> Buf;
+      llvm::raw_svector_ostream BufOS(Buf);
+      bool Failed = writeUncachedName(D, BufOS);
+      Known = Names.insert({D, {Buf.str().copy(NameAlloc), Failed}}).first;
+    }
+    OS << Known->second.first;
+    return Known->second.second;
+  }
+
+  bool writeUncachedName(const Decl *D, raw_ostream &OS) {
     // First apply frontend mangling.
     SmallString<128> FrontendBuf;
     llvm::raw_svector_ostream FrontendBufOS(FrontendBuf);
@@ -53,16 +53,19 @@ class USRGenerator : public ConstDeclVisitor<USRGenerator> {
   bool IgnoreResults;
   ASTContext *Context;
   bool generatedLoc;
+  USRCache *Cache;
   
   llvm::DenseMap<const Type *, unsigned> TypeSubstitutions;
   
 public:
-  explicit USRGenerator(ASTContext *Ctx, SmallVectorImpl<char> &Buf)
+  explicit USRGenerator(ASTContext *Ctx, SmallVectorImpl<char> &Buf,
+                        USRCache *Cache = nullptr)
   : Buf(Buf),
     Out(Buf),
     IgnoreResults(false),
     Context(Ctx),
-    generatedLoc(false)
+    generatedLoc(false),
+    Cache(Cache)
   {
     // Add the USR space prefix.
     Out << getUSRSpacePrefix();
@@ -70,6 +73,11 @@ public:
 
   bool ignoreResults() const { return IgnoreResults; }
 
+  /// Visit \p D, reusing or populating the USR cache when the generator is
+  /// in its initial state, where the fragment for \p D is the same as the
+  /// USR of \p D itself.
+  void VisitCached(const Decl *D);
+
   // Visitation methods from generating USRs from AST elements.
   void VisitDeclContext(const DeclContext *D);
   void VisitFieldDecl(const FieldDecl *D);
@@ -180,9 +188,30 @@ bool USRGenerator::ShouldGenerateLocation(const NamedDecl *D) {
   return !SM.isInSystemHeader(Loc);
 }
 
+void USRGenerator::VisitCached(const Decl *D) {
+  if (!Cache || IgnoreResults || generatedLoc || !TypeSubstitutions.empty()) {
+    Visit(D);
+    return;
+  }
+
+  if (const USRCache::Entry *E = Cache->lookup(D)) {
+    if (!E->HasSubstitutions) {
+      Out << E->USR;
+      IgnoreResults = E->Ignore;
+      generatedLoc = E->HasLocation;
+      return;
+    }
+  }
+
+  const unsigned Start = Buf.size();
+  Visit(D);
+  Cache->insert(D, {StringRef(Buf.data() + Start, Buf.size() - Start),
+                    IgnoreResults, generatedLoc, !TypeSubstitutions.empty()});
+}
+
 void USRGenerator::VisitDeclContext(const DeclContext *DC) {
   if (const NamedDecl *D = dyn_cast<NamedDecl>(DC))
-    Visit(D);
+    VisitCached(D);
 }
 
 void USRGenerator::VisitFieldDecl(const FieldDecl *D) {
@@ -907,6 +936,26 @@ bool clang::index::generateUSRForDecl(const Decl *D,
   return UG.ignoreResults();
 }
 
+bool USRCache::generateUSRForDecl(const Decl *D, SmallVectorImpl<char> &Buf) {
+  if (!D)
+    return true;
+
+  USRGenerator UG(&D->getASTContext(), Buf, this);
+  UG.VisitCached(D);
+  return UG.ignoreResults();
+}
+
+void USRCache::clear() {
+  Entries.clear();
+  Alloc.Reset();
+}
+
+void USRCache::insert(const Decl *D, const Entry &E) {
+  Entry &Stored = Entries[D];
+  Stored = E;
+  Stored.USR = E.USR.copy(Alloc);
+}
+
 bool clang::index::generateUSRForMacro(const MacroDefinitionRecord *MD,
                                        const SourceManager &SM,
                                        SmallVectorImpl<char> &Buf) {
@@ -0,0 +1,345 @@
+//===--- DependencyDirectivesSourceMinimizer.cpp - Minimize sources -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The minimizer is a simple scanner rather than a Lexer: it only needs to
+// tell directives apart from the rest of the source, which means recognizing
+// the start of a line, comments, and the literals that may hide either.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
+#include "clang/Basic/CharInfo.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringSwitch.h"
+
+using namespace clang;
+
+namespace {
+
+class Minimizer {
+  const char *Cur;
+  const char *const End;
+  SmallVectorImpl<char> &Out;
+
+public:
+  Minimizer(StringRef Input, SmallVectorImpl<char> &Out)
+      : Cur(Input.begin()), End(Input.end()), Out(Out) {}
+
+  bool minimize();
+
+private:
+  bool atNewline() const {
+    return Cur != End && isVerticalWhitespace(*Cur);
+  }
+  bool startsWith(const char *S) const {
+    return StringRef(Cur, End - Cur).startswith(S);
+  }
+  void print(StringRef S) { Out.append(S.begin(), S.end()); }
+
+  void skipNewline();
+  void skipToNewline();
+  void skipBlockComment();
+  void skipQuoted();
+  void skipRawString();
+  StringRef lexIdentifierOrNumber();
+
+  void skipWhitespaceAndComments(bool AcrossLines);
+  void skipLine();
+
+  void lexDirective();
+  bool lexAtImport();
+  bool isKeptPragma();
+  void printDirectiveBody();
+};
+
+} // end anonymous namespace
+
+void Minimizer::skipNewline() {
+  assert(atNewline() && "not at a newline");
+  if (*Cur == '\r' && Cur + 1 != End && Cur[1] == '\n')
+    ++Cur;
+  ++Cur;
+}
+
+void Minimizer::skipToNewline() {
+  while (Cur != End && !isVerticalWhitespace(*Cur))
+    ++Cur;
+}
+
+void Minimizer::skipBlockComment() {
+  assert(startsWith("/*") && "not at a block comment");
+  StringRef Rest(Cur + 2, End - Cur - 2);
+  size_t Close = Rest.find("*/");
+  Cur = Close == StringRef::npos ? End : Rest.begin() + Close + 2;
+}
+
+/// An unterminated literal ends at the end of the line, as it does when the
+/// lexer skips it, e.g., an apostrophe within '#if 0'.
+void Minimizer::skipQuoted() {
+  char Quote = *Cur++;
+  while (Cur != End && *Cur != Quote && !isVerticalWhitespace(*Cur)) {
+    if (*Cur == '\\' && Cur + 1 != End && !isVerticalWhitespace(Cur[1]))
+      ++Cur;
+    ++Cur;
+  }
+  if (Cur != End && *Cur == Quote)
+    ++Cur;
+}
+
+void Minimizer::skipRawString() {
+  assert(*Cur == '"' && "not at a raw string");
+  const char *Delim = Cur + 1;
+  const char *Paren = Delim;
+  while (Paren != End && Paren - Delim <= 16 && isRawStringDelimBody(*Paren))
+    ++Paren;
+  if (Paren == End || *Paren != '(' || Paren - Delim > 16)
+    return skipQuoted();
+
+  SmallString<20> Terminator(")");
+  Terminator.append(Delim, Paren);
+  Terminator.push_back('"');
+  StringRef Rest(Paren + 1, End - Paren - 1);
+  size_t Close = Rest.find(Terminator);
+  Cur = Close == StringRef::npos ? End
+                                 : Rest.begin() + Close + Terminator.size();
+}
+
+/// Lex an identifier or a preprocessing number, along with the string
+/// literal that follows it if the identifier is a raw string prefix.
+StringRef Minimizer::lexIdentifierOrNumber() {
+  const char *Start = Cur;
+  if (isDigit(*Cur)) {
+    ++Cur;
+    while (Cur != End) {
+      if (isPreprocessingNumberBody(*Cur)) {
+        ++Cur;
+      } else if ((*Cur == '+' || *Cur == '-') &&
+                 (Cur[-1] == 'e' || Cur[-1] == 'E' || Cur[-1] == 'p' ||
+                  Cur[-1] == 'P')) {
+        ++Cur;
+      } else if (*Cur == '\'' && Cur + 1 != End &&
+                 isIdentifierBody(Cur[1])) {
+        // A digit separator.
+        Cur += 2;
+      } else {
+        break;
+      }
+    }
+    return StringRef(Start, Cur - Start);
+  }
+
+  // Treat the bytes of UTF-8 sequences as part of the identifier.
+  while (Cur != End && (isIdentifierBody(*Cur, /*AllowDollar=*/true) ||
+                        (unsigned char)*Cur >= 0x80))
+    ++Cur;
+  StringRef Identifier(Start, Cur - Start);
+  if (Cur != End && *Cur == '"' &&
+      llvm::StringSwitch<bool>(Identifier)
+          .Cases("R", "LR", "uR", "UR", "u8R", true)
+          .Default(false))
+    skipRawString();
+  return Identifier;
+}
+
+/// Skip whitespace and comments, which may span lines when \p AcrossLines is
+/// set, e.g., before the first token of a line.
+void Minimizer::skipWhitespaceAndComments(bool AcrossLines) {
+  while (Cur != End) {
+    if (isHorizontalWhitespace(*Cur) || (AcrossLines && atNewline()))
+      ++Cur;
+    else if (startsWith("/*"))
+      skipBlockComment();
+    else if (startsWith("//"))
+      skipToNewline();
+    else
+      return;
+  }
+}
+
+/// Skip the rest of a line that is not a directive.
+void Minimizer::skipLine() {
+  while (Cur != End) {
+    char C = *Cur;
+    if (isVerticalWhitespace(C))
+      return skipNewline();
+    if (startsWith("/*"))
+      skipBlockComment();
+    else if (startsWith("//"))
+      skipToNewline();
+    else if (C == '"' || C == '\'')
+      skipQuoted();
+    else if (isIdentifierHead(C, /*AllowDollar=*/true) || isDigit(C) ||
+             (unsigned char)C >= 0x80)
+      lexIdentifierOrNumber();
+    else
+      ++Cur;
+  }
+}
+
+bool Minimizer::isKeptPragma() {
+  const char *Start = Cur;
+  auto NextIdentifier = [this]() -> StringRef {
+    skipWhitespaceAndComments(/*AcrossLines=*/false);
+    if (Cur == End || !isIdentifierHead(*Cur))
+      return StringRef();
+    return lexIdentifierOrNumber();
+  };
+
+  StringRef Name = NextIdentifier();
+  bool Kept = llvm::StringSwitch<bool>(Name)
+                  .Cases("once", "push_macro", "pop_macro", "include_alias",
+                         true)
+                  .Default(false);
+  if (Name == "GCC")
+    Kept = NextIdentifier() == "system_header";
+  else if (Name == "clang")
+    Kept = NextIdentifier() == "module" && NextIdentifier() == "import";
+  Cur = Start;
+  return Kept;
+}
+
+/// Copy the rest of the directive's line to the output, replacing each run of
+/// whitespace and comments with a single space.
+void Minimizer::printDirectiveBody() {
+  while (Cur != End && !atNewline()) {
+    const char *Start = Cur;
+    char C = *Cur;
+    if (isHorizontalWhitespace(C) || startsWith("/*") || startsWith("//")) {
+      skipWhitespaceAndComments(/*AcrossLines=*/false);
+      Out.push_back(' ');
+      continue;
+    }
+    if (C == '"' || C == '\'')
+      skipQuoted();
+    else if (isIdentifierHead(C, /*AllowDollar=*/true) || isDigit(C) ||
+             (unsigned char)C >= 0x80)
+      lexIdentifierOrNumber();
+    else
+      ++Cur;
+    Out.append(Start, Cur);
+  }
+
+  while (!Out.empty() && isHorizontalWhitespace(Out.back()))
+    Out.pop_back();
+  Out.push_back('\n');
+  if (Cur != End)
+    skipNewline();
+}
+
+/// Lex the directive whose '#' was just consumed, printing it if it is kept.
+void Minimizer::lexDirective() {
+  skipWhitespaceAndComments(/*AcrossLines=*/false);
+  if (Cur == End || atNewline() || !isIdentifierHead(*Cur)) {
+    // The null directive, or one we don't care about.
+    return skipLine();
+  }
+
+  StringRef Name = lexIdentifierOrNumber();
+  bool Kept = Name == "pragma"
+                  ? isKeptPragma()
+                  : llvm::StringSwitch<bool>(Name)
+                        .Cases("include", "include_next", "import",
+                               "__include_macros", true)
+                        .Cases("define", "undef", true)
+                        .Cases("if", "ifdef", "ifndef", "elif", "else",
+                               "endif", true)
+                        .Default(false);
+  if (!Kept)
+    return skipLine();
+
+  Out.push_back('#');
+  print(Name);
+  printDirectiveBody();
+}
+
+/// Lex an Objective-C '@import', which ends at its semicolon.
+bool Minimizer::lexAtImport() {
+  assert(*Cur == '@' && "not at an '@'");
+  const char *Start = Cur++;
+  skipWhitespaceAndComments(/*AcrossLines=*/false);
+  if (Cur == End || lexIdentifierOrNumber() != "import") {
+    Cur = Start + 1;
+    skipLine();
+    return false;
+  }
+
+  print("@import ");
+  while (true) {
+    skipWhitespaceAndComments(/*AcrossLines=*/true);
+    if (Cur == End)
+      return true;
+    if (*Cur == ';')
+      break;
+    const char *Name = Cur;
+    if (isIdentifierHead(*Cur))
+      lexIdentifierOrNumber();
+    else if (*Cur == '.')
+      ++Cur;
+    else
+      return true;
+    Out.append(Name, Cur);
+  }
+  print(";\n");
+  ++Cur;
+  skipLine();
+  return false;
+}
+
+bool Minimizer::minimize() {
+  while (true) {
+    skipWhitespaceAndComments(/*AcrossLines=*/true);
+    if (Cur == End)
+      return false;
+
+    if (*Cur == '#') {
+      ++Cur;
+      lexDirective();
+    } else if (startsWith("%:")) {
+      Cur += 2;
+      lexDirective();
+    } else if (*Cur == '@') {
+      if (lexAtImport())
+        return true;
+    } else {
+      skipLine();
+    }
+  }
+}
+
+/// Join the lines that are spliced with a backslash, so that the minimizer
+/// doesn't need to handle splices within tokens.
+static StringRef removeLineSplices(StringRef Input,
+                                   SmallVectorImpl<char> &Storage) {
+  if (Input.find('\\') == StringRef::npos)
+    return Input;
+
+  Storage.reserve(Input.size());
+  for (const char *P = Input.begin(), *E = Input.end(); P != E;) {
+    if (*P == '\\') {
+      const char *Q = P + 1;
+      while (Q != E && isHorizontalWhitespace(*Q))
+        ++Q;
+      if (Q != E && isVerticalWhitespace(*Q)) {
+        if (*Q == '\r' && Q + 1 != E && Q[1] == '\n')
+          ++Q;
+        P = Q + 1;
+        continue;
+      }
+    }
+    Storage.push_back(*P++);
+  }
+  return StringRef(Storage.data(), Storage.size());
+}
+
+bool clang::minimizeSourceToDependencyDirectives(
+    StringRef Input, SmallVectorImpl<char> &Output) {
+  SmallString<0> Storage;
+  Output.clear();
+  return Minimizer(removeLineSplices(Input, Storage), Output).minimize();
+}
@@ -1505,11 +1505,20 @@ bool Lexer::tryConsumeIdentifierUTF8Char(const char *&CurPtr) {
 }
 
 bool Lexer::LexIdentifier(Token &Result, const char *CurPtr) {
-  // Match [_A-Za-z0-9]*, we have already matched [_A-Za-z$]
+  // Match [_A-Za-z0-9]*, we have already matched [_A-Za-z$]. Hash the
+  // identifier while we scan it, so that the identifier table doesn't have to
+  // scan it again. The hash covers the raw characters from BufferPtr, so it
+  // is only used if the identifier doesn't need cleaning.
   unsigned Size;
+  unsigned Hash = 0;
+  for (const char *Start = BufferPtr; Start != CurPtr; ++Start)
+    Hash = IdentifierTable::updateHashValue(Hash, *Start);
+  bool HashIsValid = true;
   unsigned char C = *CurPtr++;
-  while (isIdentifierBody(C))
+  while (isIdentifierBody(C)) {
+    Hash = IdentifierTable::updateHashValue(Hash, C);
     C = *CurPtr++;
+  }
 
   --CurPtr;   // Back up over the skipped character.
 
@@ -1532,7 +1541,8 @@ FinishIdentifier:
 
     // Fill in Result.IdentifierInfo and update the token kind,
     // looking up the identifier in the identifier table.
-    IdentifierInfo *II = PP->LookUpIdentifierInfo(Result);
+    IdentifierInfo *II = HashIsValid ? PP->LookUpIdentifierInfo(Result, Hash)
+                                     : PP->LookUpIdentifierInfo(Result);
 
     // Finally, now that we know we have an identifier, pass this off to the
     // preprocessor, which may macro expand it or something.
@@ -1551,6 +1561,7 @@ FinishIdentifier:
   }
 
   // Otherwise, $,\,? in identifier found.  Enter slower path.
+  HashIsValid = false;
 
   C = getCharAndSize(CurPtr, Size);
   while (true) {
@@ -2455,6 +2466,240 @@ bool Lexer::SkipBlockComment(Token &Result, const char *CurPtr,
   return false;
 }
 
+/// \brief Return a pointer to the first character in [Ptr, End) that is one of
+/// \p Chars, counting its terminating null character, or End if there is none.
+template <size_t N>
+static const char *findFirstOf(const char *Ptr, const char *End,
+                               const char (&Chars)[N]) {
+#ifdef __SSE2__
+  for (; Ptr + 16 <= End; Ptr += 16) {
+    __m128i Bytes = _mm_loadu_si128((const __m128i *)Ptr);
+    __m128i Matches = _mm_setzero_si128();
+    for (char C : Chars)
+      Matches = _mm_or_si128(Matches, _mm_cmpeq_epi8(Bytes, _mm_set1_epi8(C)));
+    if (int Mask = _mm_movemask_epi8(Matches))
+      return Ptr + llvm::countTrailingZeros<unsigned>(Mask);
+  }
+#endif
+  for (; Ptr != End; ++Ptr)
+    if (std::memchr(Chars, *Ptr, N))
+      return Ptr;
+  return End;
+}
+
+/// \brief Whether \p Ptr, which is not at the start of the buffer, might start
+/// a version control conflict marker, which the lexer diagnoses.
+static bool mightStartConflictMarker(const char *Ptr) {
+  return (Ptr[-1] == '\n' || Ptr[-1] == '\r') && Ptr[1] == Ptr[0] &&
+         Ptr[2] == Ptr[0] && Ptr[3] == Ptr[0];
+}
+
+bool Lexer::SkipBalancedBraces(unsigned Depth, Token &Result) {
+  assert(Depth && "Not within a block");
+
+  // Comments that are returned as tokens, and the code-completion point, need
+  // the full lexer.
+  if (!PP || isLexingRawMode() || ParsingPreprocessorDirective ||
+      inKeepCommentMode() || HasLeadingEmptyMacro ||
+      PP->getCodeCompletionFileLoc() == FileLoc)
+    return false;
+
+  bool AtStartOfLine = IsAtStartOfLine;
+  bool LeadingSpace = HasLeadingSpace;
+  SmallVector<std::pair<const char *, const char *>, 8> Comments;
+  const char *CurPtr = BufferPtr;
+  const char *TokStart;
+  while (true) {
+    TokStart = CurPtr;
+    char C = *CurPtr++;
+    switch (C) {
+    case '\n':
+    case '\r':
+      AtStartOfLine = true;
+      LeadingSpace = false;
+      continue;
+
+    case ' ':
+    case '\t':
+    case '\f':
+    case '\v':
+      LeadingSpace = true;
+      continue;
+
+    case '{':
+      ++Depth;
+      break;
+
+    case '}':
+      if (--Depth == 0)
+        goto FoundBrace;
+      break;
+
+    case '/':
+      // Without line comments, "//" is still lexed as one unless followed by
+      // '*'; leave that to the lexer.
+      if (*CurPtr == '/' && !LangOpts.LineComment)
+        return false;
+      if (*CurPtr == '/') {
+        // An escaped newline would continue the comment on the next line, and
+        // so would "??/" followed by a newline with trigraphs.
+        while (true) {
+          CurPtr = findFirstOf(CurPtr, BufferEnd, "\n\r\\?");
+          if (*CurPtr != '?')
+            break;
+          if (CurPtr[1] == '?')
+            return false;
+          ++CurPtr;
+        }
+        if (*CurPtr != '\n' && *CurPtr != '\r')
+          return false;
+        Comments.push_back(std::make_pair(TokStart, CurPtr));
+        LeadingSpace = true;
+        continue;
+      }
+      if (*CurPtr == '*') {
+        // The '/' right after "/*" does not end the comment. Leave anything
+        // the lexer warns about, and "*/" split by an escaped newline, to it.
+        const char *Slash = CurPtr + 1;
+        if (*Slash == '\0')
+          return false;
+        do {
+          Slash = findFirstOf(Slash + 1, BufferEnd, "/");
+          if (*Slash == '\0')
+            return false;
+          if (Slash[-1] != '*' && (Slash[1] == '*' || Slash[-1] == '\n' ||
+                                   Slash[-1] == '\r'))
+            return false;
+        } while (Slash[-1] != '*');
+        CurPtr = Slash + 1;
+        Comments.push_back(std::make_pair(TokStart, CurPtr));
+        LeadingSpace = true;
+        continue;
+      }
+      break;
+
+    case '"':
+    case '\'':
+      // Digit separators are consumed with their number, so this starts a
+      // literal. It must end on the same line. Leave trigraphs, such as the
+      // "??/" escape, and the warnings about ignored ones to the lexer.
+      while (true) {
+        CurPtr = C == '"' ? findFirstOf(CurPtr, BufferEnd, "\"\\\n\r?")
+                          : findFirstOf(CurPtr, BufferEnd, "'\\\n\r?");
+        if (*CurPtr == C) {
+          ++CurPtr;
+          break;
+        }
+        if (*CurPtr == '?') {
+          if (CurPtr[1] == '?')
+            return false;
+          ++CurPtr;
+          continue;
+        }
+        if (*CurPtr != '\\' || CurPtr[1] == '\0')
+          return false;
+        CurPtr += 2;
+      }
+      break;
+
+    case '<':
+      if (mightStartConflictMarker(TokStart))
+        return false;
+      if (*CurPtr == '<')
+        ++CurPtr;
+      else if (*CurPtr == '%' && LangOpts.Digraphs) {
+        ++CurPtr;
+        ++Depth;
+      }
+      break;
+
+    case '%':
+      if (*CurPtr == '>' && LangOpts.Digraphs) {
+        ++CurPtr;
+        if (--Depth == 0)
+          goto FoundBrace;
+      } else if (*CurPtr == ':' && LangOpts.Digraphs) {
+        return false;
+      }
+      break;
+
+    case '>':
+    case '=':
+    case '|':
+      if (mightStartConflictMarker(TokStart))
+        return false;
+      break;
+
+    case '?':
+      // A trigraph, or something the lexer warns might have been one.
+      if (*CurPtr == '?')
+        return false;
+      break;
+
+    case '#':
+    case '\\':
+      // A directive, a line splice or a universal character name.
+      return false;
+
+    default:
+      if (isIdentifierHead(C, LangOpts.DollarIdents)) {
+        while (isIdentifierBody(*CurPtr, LangOpts.DollarIdents))
+          ++CurPtr;
+        // Raw string literals may contain anything up to their delimiter.
+        if (*CurPtr == '"' && CurPtr[-1] == 'R')
+          return false;
+        IdentifierInfo *II =
+            PP->getIdentifierInfo(StringRef(TokStart, CurPtr - TokStart));
+        if (II->isHandleIdentifierCase())
+          return false;
+        break;
+      }
+      if (isDigit(C) || (C == '.' && isDigit(*CurPtr))) {
+        while (true) {
+          if (isPreprocessingNumberBody(*CurPtr))
+            ++CurPtr;
+          else if (*CurPtr == '\'' && LangOpts.CPlusPlus14 &&
+                   isIdentifierBody(CurPtr[1]))
+            CurPtr += 2;
+          else
+            break;
+        }
+        break;
+      }
+      // Any other punctuator; leave NUL, control characters and non-ASCII
+      // characters to the lexer.
+      if (!isPrintable(C))
+        return false;
+      break;
+    }
+
+    AtStartOfLine = false;
+    LeadingSpace = false;
+  }
+
+FoundBrace:
+  // Notify comment handlers about the skipped comments.
+  for (const auto &Comment : Comments) {
+    Token CommentTok;
+    PP->HandleComment(CommentTok,
+                      SourceRange(getSourceLocation(Comment.first),
+                                  getSourceLocation(Comment.second)));
+  }
+
+  Result.startToken();
+  if (AtStartOfLine)
+    Result.setFlag(Token::StartOfLine);
+  if (LeadingSpace)
+    Result.setFlag(Token::LeadingSpace);
+  MIOpt.ReadToken();
+  BufferPtr = TokStart;
+  FormTokenWithChars(Result, CurPtr, tok::r_brace);
+  IsAtStartOfLine = false;
+  IsAtPhysicalStartOfLine = false;
+  HasLeadingSpace = false;
+  return true;
+}
+
 //===----------------------------------------------------------------------===//
 // Primary Lexing Entry Points
 //===----------------------------------------------------------------------===//
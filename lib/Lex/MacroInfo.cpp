@@ -19,6 +19,8 @@ MacroInfo::MacroInfo(SourceLocation DefLoc)
   : Location(DefLoc),
     ArgumentList(nullptr),
     NumArguments(0),
+    ReplacementTokens(nullptr),
+    NumReplacementTokens(0),
     IsDefinitionLengthCached(false),
     IsFunctionLike(false),
     IsC99Varargs(false),
@@ -37,11 +39,11 @@ unsigned MacroInfo::getDefinitionLengthSlow(SourceManager &SM) const {
   assert(!IsDefinitionLengthCached);
   IsDefinitionLengthCached = true;
 
-  if (ReplacementTokens.empty())
+  if (tokens_empty())
     return (DefinitionLength = 0);
 
-  const Token &firstToken = ReplacementTokens.front();
-  const Token &lastToken = ReplacementTokens.back();
+  const Token &firstToken = tokens().front();
+  const Token &lastToken = tokens().back();
   SourceLocation macroStart = firstToken.getLocation();
   SourceLocation macroEnd = lastToken.getLocation();
   assert(macroStart.isValid() && macroEnd.isValid());
@@ -74,7 +76,7 @@ bool MacroInfo::isIdenticalTo(const MacroInfo &Other, Preprocessor &PP,
   bool Lexically = !Syntactically;
 
   // Check # tokens in replacement, number of args, and various flags all match.
-  if (ReplacementTokens.size() != Other.ReplacementTokens.size() ||
+  if (NumReplacementTokens != Other.NumReplacementTokens ||
       getNumArgs() != Other.getNumArgs() ||
       isFunctionLike() != Other.isFunctionLike() ||
       isC99Varargs() != Other.isC99Varargs() ||
@@ -89,7 +91,7 @@ bool MacroInfo::isIdenticalTo(const MacroInfo &Other, Preprocessor &PP,
   }
 
   // Check all the tokens.
-  for (unsigned i = 0, e = ReplacementTokens.size(); i != e; ++i) {
+  for (unsigned i = 0, e = NumReplacementTokens; i != e; ++i) {
     const Token &A = ReplacementTokens[i];
     const Token &B = Other.ReplacementTokens[i];
     if (A.getKind() != B.getKind())
@@ -155,7 +157,7 @@ LLVM_DUMP_METHOD void MacroInfo::dump() const {
   }
 
   bool First = true;
-  for (const Token &Tok : ReplacementTokens) {
+  for (const Token &Tok : tokens()) {
     // Leading space is semantically meaningful in a macro definition,
     // so preserve it in the dump output.
     if (First || Tok.hasLeadingSpace())
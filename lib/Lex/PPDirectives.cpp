@@ -55,10 +55,7 @@ using namespace clang;
 //===----------------------------------------------------------------------===//
 
 MacroInfo *Preprocessor::AllocateMacroInfo() {
-  MacroInfoChain *MIChain = BP.Allocate<MacroInfoChain>();
-  MIChain->Next = MIChainHead;
-  MIChainHead = MIChain;
-  return &MIChain->MI;
+  return BP.Allocate<MacroInfo>();
 }
 
 MacroInfo *Preprocessor::AllocateMacroInfo(SourceLocation L) {
@@ -71,12 +68,7 @@ MacroInfo *Preprocessor::AllocateDeserializedMacroInfo(SourceLocation L,
                                                        unsigned SubModuleID) {
   static_assert(alignof(MacroInfo) >= sizeof(SubModuleID),
                 "alignment for MacroInfo is less than the ID");
-  DeserializedMacroInfoChain *MIChain =
-      BP.Allocate<DeserializedMacroInfoChain>();
-  MIChain->Next = DeserialMIChainHead;
-  DeserialMIChainHead = MIChain;
-
-  MacroInfo *MI = &MIChain->MI;
+  MacroInfo *MI = &BP.Allocate<DeserializedMacroInfo>()->MI;
   new (MI) MacroInfo(L);
   MI->FromASTFile = true;
   MI->setOwningModuleID(SubModuleID);
@@ -2387,12 +2379,14 @@ void Preprocessor::HandleDefineDirective(Token &DefineTok,
   if (!Tok.is(tok::eod))
     LastTok = Tok;
 
-  // Read the rest of the macro body.
+  // Read the rest of the macro body.  The tokens are collected here and then
+  // copied into the preprocessor's allocator in one go.
+  SmallVector<Token, 32> Tokens;
   if (MI->isObjectLike()) {
     // Object-like macros are very simple, just read their body.
     while (Tok.isNot(tok::eod)) {
       LastTok = Tok;
-      MI->AddTokenToBody(Tok);
+      Tokens.push_back(Tok);
       // Get the next token of the macro.
       LexUnexpandedToken(Tok);
     }
@@ -2404,7 +2398,7 @@ void Preprocessor::HandleDefineDirective(Token &DefineTok,
       LastTok = Tok;
 
       if (!Tok.isOneOf(tok::hash, tok::hashat, tok::hashhash)) {
-        MI->AddTokenToBody(Tok);
+        Tokens.push_back(Tok);
 
         // Get the next token of the macro.
         LexUnexpandedToken(Tok);
@@ -2416,7 +2410,7 @@ void Preprocessor::HandleDefineDirective(Token &DefineTok,
       // things.
       if (getLangOpts().TraditionalCPP) {
         Tok.setKind(tok::unknown);
-        MI->AddTokenToBody(Tok);
+        Tokens.push_back(Tok);
 
         // Get the next token of the macro.
         LexUnexpandedToken(Tok);
@@ -2432,17 +2426,16 @@ void Preprocessor::HandleDefineDirective(Token &DefineTok,
         LexUnexpandedToken(Tok);
 
         if (Tok.is(tok::eod)) {
-          MI->AddTokenToBody(LastTok);
+          Tokens.push_back(LastTok);
           break;
         }
 
-        unsigned NumTokens = MI->getNumTokens();
-        if (NumTokens && Tok.getIdentifierInfo() == Ident__VA_ARGS__ &&
-            MI->getReplacementToken(NumTokens-1).is(tok::comma))
+        if (!Tokens.empty() && Tok.getIdentifierInfo() == Ident__VA_ARGS__ &&
+            Tokens.back().is(tok::comma))
           MI->setHasCommaPasting();
 
         // Things look ok, add the '##' token to the macro.
-        MI->AddTokenToBody(LastTok);
+        Tokens.push_back(LastTok);
         continue;
       }
 
@@ -2459,7 +2452,7 @@ void Preprocessor::HandleDefineDirective(Token &DefineTok,
         // confused.
         if (getLangOpts().AsmPreprocessor && Tok.isNot(tok::eod)) {
           LastTok.setKind(tok::unknown);
-          MI->AddTokenToBody(LastTok);
+          Tokens.push_back(LastTok);
           continue;
         } else {
           Diag(Tok, diag::err_pp_stringize_not_parameter)
@@ -2472,8 +2465,8 @@ void Preprocessor::HandleDefineDirective(Token &DefineTok,
       }
 
       // Things look ok, add the '#' and param name tokens to the macro.
-      MI->AddTokenToBody(LastTok);
-      MI->AddTokenToBody(Tok);
+      Tokens.push_back(LastTok);
+      Tokens.push_back(Tok);
       LastTok = Tok;
 
       // Get the next token of the macro.
@@ -2481,6 +2474,8 @@ void Preprocessor::HandleDefineDirective(Token &DefineTok,
     }
   }
 
+  MI->setTokens(Tokens, BP);
+
   if (MacroShadowsKeyword &&
       !isConfigurationPattern(MacroNameTok, MI, getLangOpts())) {
     Diag(MacroNameTok, diag::warn_pp_macro_hides_keyword);
@@ -87,8 +87,7 @@ Preprocessor::Preprocessor(std::shared_ptr<PreprocessorOptions> PPOpts,
       MainFileDir(nullptr), SkipMainFilePreamble(0, true), CurPPLexer(nullptr),
       CurDirLookup(nullptr), CurLexerKind(CLK_Lexer), CurSubmodule(nullptr),
       Callbacks(nullptr), CurSubmoduleState(&NullSubmoduleState),
-      MacroArgCache(nullptr), Record(nullptr), MIChainHead(nullptr),
-      DeserialMIChainHead(nullptr) {
+      MacroArgCache(nullptr), Record(nullptr) {
   OwnsHeaderSearch = OwnsHeaders;
   
   CounterValue = 0; // __COUNTER__ starts at 0.
@@ -157,23 +156,12 @@ Preprocessor::~Preprocessor() {
 
   IncludeMacroStack.clear();
 
-  // Destroy any macro definitions.
-  while (MacroInfoChain *I = MIChainHead) {
-    MIChainHead = I->Next;
-    I->~MacroInfoChain();
-  }
-
   // Free any cached macro expanders.
   // This populates MacroArgCache, so all TokenLexers need to be destroyed
   // before the code below that frees up the MacroArgCache list.
   std::fill(TokenLexerCache, TokenLexerCache + NumCachedTokenLexers, nullptr);
   CurTokenLexer.reset();
 
-  while (DeserializedMacroInfoChain *I = DeserialMIChainHead) {
-    DeserialMIChainHead = I->Next;
-    I->~DeserializedMacroInfoChain();
-  }
-
   // Free any cached MacroArgs.
   for (MacroArgs *ArgList = MacroArgCache; ArgList;)
     ArgList = ArgList->deallocate();
@@ -315,8 +303,8 @@ size_t Preprocessor::getTotalMemory() const {
   return BP.getTotalMemory()
     + llvm::capacity_in_bytes(MacroExpandedTokens)
     + Predefines.capacity() /* Predefines buffer. */
-    // FIXME: Include sizes from all submodules, and include MacroInfo sizes,
-    // and ModuleMacros.
+    // FIXME: Include sizes from all submodules, and ModuleMacros.  MacroInfos
+    // and their tokens are allocated in BP.
     + llvm::capacity_in_bytes(CurSubmoduleState->Macros)
     + llvm::capacity_in_bytes(PragmaPushMacroInfo)
     + llvm::capacity_in_bytes(PoisonReasons)
@@ -581,6 +569,19 @@ IdentifierInfo *Preprocessor::LookUpIdentifierInfo(Token &Identifier) const {
   return II;
 }
 
+IdentifierInfo *Preprocessor::LookUpIdentifierInfo(Token &Identifier,
+                                                   unsigned Hash) const {
+  // The hash only covers the raw characters.
+  if (Identifier.needsCleaning() || Identifier.hasUCN())
+    return LookUpIdentifierInfo(Identifier);
+
+  IdentifierInfo *II =
+      &Identifiers.getWithHash(Identifier.getRawIdentifier(), Hash);
+  Identifier.setIdentifierInfo(II);
+  Identifier.setKind(II->getTokenID());
+  return II;
+}
+
 void Preprocessor::SetPoisonReason(IdentifierInfo *II, unsigned DiagID) {
   PoisonReasons[II] = DiagID;
 }
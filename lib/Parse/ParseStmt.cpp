@@ -2000,13 +2000,21 @@ Decl *Parser::ParseFunctionTryBlock(Decl *Decl, ParseScope &BodyScope) {
 bool Parser::trySkippingFunctionBody() {
   assert(SkipFunctionBodies &&
          "Should only be called when SkipFunctionBodies is enabled");
-  if (!PP.isCodeCompletionEnabled()) {
+  // Bodies in the main file may have to be parsed anyway. Unless that depends
+  // on the lines they span, we know before looking at them.
+  SourceLocation BodyStart = Tok.getLocation();
+  bool MayKeepBody = Actions.mayKeepFunctionBody(BodyStart);
+  if (MayKeepBody && Actions.KeptFunctionBodyLines.empty())
+    return false;
+
+  if (!PP.isCodeCompletionEnabled() && !MayKeepBody) {
     SkipFunctionBody();
     return true;
   }
 
-  // We're in code-completion mode. Skip parsing for all function bodies unless
-  // the body contains the code-completion point.
+  // We're in code-completion mode, or the body is only kept if it overlaps the
+  // requested lines. Skip parsing for all function bodies unless the body
+  // contains the code-completion point or overlaps those lines.
   TentativeParsingAction PA(*this);
   bool IsTryCatch = Tok.is(tok::kw_try);
   CachedTokens Toks;
@@ -2033,6 +2041,11 @@ bool Parser::trySkippingFunctionBody() {
       return false;
     }
   }
+  if (MayKeepBody &&
+      Actions.isKeptFunctionBody(SourceRange(BodyStart, PrevTokLocation))) {
+    PA.Revert();
+    return false;
+  }
   PA.Commit();
   return true;
 }
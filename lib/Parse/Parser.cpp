@@ -1234,7 +1234,17 @@ void Parser::SkipFunctionBody() {
   if (ConsumeAndStoreFunctionPrologue(Skipped))
     SkipMalformedDecl();
   else {
-    SkipUntil(tok::r_brace);
+    // The opening brace has been consumed. If the body continues directly in
+    // the file, look for its closing brace without lexing the body.
+    Token RBrace;
+    if (!Tok.isOneOf(tok::r_brace, tok::eof) && !Tok.isAnnotation() &&
+        Tok.getLocation().isFileID() &&
+        PP.SkipBalancedBraces(Tok.is(tok::l_brace) ? 2 : 1, RBrace)) {
+      Tok = RBrace;
+      ConsumeBrace();
+    } else {
+      SkipUntil(tok::r_brace);
+    }
     while (IsFunctionTryBlock && Tok.is(tok::kw_catch)) {
       SkipUntil(tok::l_brace);
       SkipUntil(tok::r_brace);
@@ -687,6 +687,35 @@ RopePieceBTreeIterator::RopePieceBTreeIterator(const void *n) {
   CurChar = 0;
 }
 
+RopePieceBTreeIterator::RopePieceBTreeIterator(const void *n,
+                                               unsigned Offset) {
+  const RopePieceBTreeNode *N = static_cast<const RopePieceBTreeNode*>(n);
+  assert(Offset <= N->size() && "Invalid offset to seek to!");
+  CurNode = nullptr;
+  CurPiece = nullptr;
+  CurChar = 0;
+  if (Offset == N->size())
+    return;
+
+  // Walk down the tree to the leaf that contains the offset, skipping over
+  // whole subtrees before it.
+  while (const RopePieceBTreeInterior *IN =
+             dyn_cast<RopePieceBTreeInterior>(N)) {
+    unsigned i = 0;
+    for (; Offset >= IN->getChild(i)->size(); ++i)
+      Offset -= IN->getChild(i)->size();
+    N = IN->getChild(i);
+  }
+
+  const RopePieceBTreeLeaf *Leaf = cast<RopePieceBTreeLeaf>(N);
+  unsigned i = 0;
+  for (; Offset >= Leaf->getPiece(i).size(); ++i)
+    Offset -= Leaf->getPiece(i).size();
+  CurNode = Leaf;
+  CurPiece = &Leaf->getPiece(i);
+  CurChar = Offset;
+}
+
 void RopePieceBTreeIterator::MoveToNextPiece() {
   if (CurPiece != &getCN(CurNode)->getPiece(getCN(CurNode)->getNumPieces()-1)) {
     CurChar = 0;
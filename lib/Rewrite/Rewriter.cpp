@@ -20,6 +20,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 using namespace clang;
 
 raw_ostream &RewriteBuffer::write(raw_ostream &os) const {
@@ -59,30 +60,51 @@ void RewriteBuffer::RemoveText(unsigned OrigOffset, unsigned Size,
 
   // Add a delta so that future changes are offset correctly.
   AddReplaceDelta(OrigOffset, -Size);
+  HasEdits = true;
 
   if (removeLineIfEmpty) {
     // Find the line that the remove occurred and if it is completely empty
-    // remove the line as well.
-
-    iterator curLineStart = begin();
+    // remove the line as well. Look for the start of the line in windows that
+    // grow backwards from the removal, seeking to each through the rope, so
+    // that the cost depends on the length of the line rather than on where it
+    // is in the buffer.
     unsigned curLineStartOffs = 0;
-    iterator posI = begin();
-    for (unsigned i = 0; i != RealOffset; ++i) {
-      if (*posI == '\n') {
-        curLineStart = posI;
-        ++curLineStart;
-        curLineStartOffs = i + 1;
+    unsigned windowEnd = RealOffset;
+    for (uint64_t windowSize = 256; windowEnd != 0; windowSize *= 2) {
+      unsigned windowStart =
+          windowEnd > windowSize ? windowEnd - windowSize : 0;
+      bool foundLineStart = false;
+      unsigned pieceOffs = windowStart;
+      for (iterator I = Buffer.seek(windowStart), E = end();
+           I != E && pieceOffs < windowEnd; I.MoveToNextPiece()) {
+        StringRef piece = I.piece().substr(0, windowEnd - pieceOffs);
+        size_t NL = piece.rfind('\n');
+        if (NL != StringRef::npos) {
+          curLineStartOffs = pieceOffs + NL + 1;
+          foundLineStart = true;
+        }
+        pieceOffs += piece.size();
       }
-      ++posI;
+      if (foundLineStart)
+        break;
+      windowEnd = windowStart;
     }
-  
+
     unsigned lineSize = 0;
-    posI = curLineStart;
-    while (posI != end() && isWhitespaceExceptNL(*posI)) {
-      ++posI;
-      ++lineSize;
+    bool lineIsEmpty = false;
+    for (iterator I = Buffer.seek(curLineStartOffs), E = end(); I != E;
+         I.MoveToNextPiece()) {
+      StringRef piece = I.piece();
+      size_t nonWS = 0;
+      while (nonWS != piece.size() && isWhitespaceExceptNL(piece[nonWS]))
+        ++nonWS;
+      lineSize += nonWS;
+      if (nonWS != piece.size()) {
+        lineIsEmpty = piece[nonWS] == '\n';
+        break;
+      }
     }
-    if (posI != end() && *posI == '\n') {
+    if (lineIsEmpty) {
       Buffer.erase(curLineStartOffs, lineSize + 1/* + '\n'*/);
       AddReplaceDelta(curLineStartOffs, -(lineSize + 1/* + '\n'*/));
     }
@@ -100,6 +122,7 @@ void RewriteBuffer::InsertText(unsigned OrigOffset, StringRef Str,
 
   // Add a delta so that future changes are offset correctly.
   AddInsertDelta(OrigOffset, Str.size());
+  HasEdits = true;
 }
 
 /// ReplaceText - This method replaces a range of characters in the input
@@ -112,6 +135,122 @@ void RewriteBuffer::ReplaceText(unsigned OrigOffset, unsigned OrigLength,
   Buffer.insert(RealOffset, NewStr.begin(), NewStr.end());
   if (OrigLength != NewStr.size())
     AddReplaceDelta(OrigOffset, NewStr.size() - OrigLength);
+  if (OrigLength != 0 || !NewStr.empty())
+    HasEdits = true;
+}
+
+void RewriteBuffer::applyEdits(ArrayRef<Edit> Edits) {
+  if (Edits.empty())
+    return;
+  if (!HasEdits && applyEditsInOnePass(Edits))
+    return;
+
+  for (const Edit &E : Edits) {
+    switch (E.Kind) {
+    case Edit::InsertBefore:
+      InsertTextBefore(E.OrigOffset, E.Text);
+      break;
+    case Edit::InsertAfter:
+      InsertTextAfter(E.OrigOffset, E.Text);
+      break;
+    case Edit::Replace:
+      ReplaceText(E.OrigOffset, E.OrigLength, E.Text);
+      break;
+    }
+  }
+}
+
+bool RewriteBuffer::applyEditsInOnePass(ArrayRef<Edit> Edits) {
+  // Order the edits by offset, keeping the edits at each offset in the order
+  // they were issued.
+  std::vector<const Edit *> Sorted;
+  Sorted.reserve(Edits.size());
+  for (const Edit &E : Edits)
+    Sorted.push_back(&E);
+  std::stable_sort(Sorted.begin(), Sorted.end(),
+                   [](const Edit *LHS, const Edit *RHS) {
+                     return LHS->OrigOffset < RHS->OrigOffset;
+                   });
+
+  // The edits are independent of each other if every original character is
+  // removed at most once, nothing is inserted within removed text, and at
+  // each offset the only replacement that removes text comes first (later
+  // ones would otherwise remove text inserted by earlier ones).
+  unsigned Size = Buffer.size();
+  size_t NewSize = Size;
+  unsigned EndOfRemoved = 0;
+  for (size_t I = 0, N = Sorted.size(); I != N;) {
+    unsigned Offset = Sorted[I]->OrigOffset;
+    if (Offset < EndOfRemoved || Offset > Size)
+      return false;
+    bool SeenReplace = false;
+    for (; I != N && Sorted[I]->OrigOffset == Offset; ++I) {
+      const Edit &E = *Sorted[I];
+      NewSize += E.Text.size();
+      if (E.Kind != Edit::Replace)
+        continue;
+      if (E.OrigLength != 0) {
+        if (SeenReplace || E.OrigLength > Size - Offset)
+          return false;
+        EndOfRemoved = Offset + E.OrigLength;
+        NewSize -= E.OrigLength;
+      }
+      SeenReplace = true;
+    }
+  }
+
+  // Nothing has been changed yet, so the buffer holds the original input.
+  std::string Original;
+  Original.reserve(Size);
+  for (iterator I = begin(), E = end(); I != E; I.MoveToNextPiece())
+    Original.append(I.piece().begin(), I.piece().end());
+
+  std::string Result;
+  Result.reserve(NewSize);
+  unsigned Pos = 0;
+  for (size_t I = 0, N = Sorted.size(); I != N;) {
+    unsigned Offset = Sorted[I]->OrigOffset;
+    size_t GroupEnd = I;
+    while (GroupEnd != N && Sorted[GroupEnd]->OrigOffset == Offset)
+      ++GroupEnd;
+
+    Result.append(Original, Pos, Offset - Pos);
+    Pos = Offset;
+
+    // Text inserted before the offset goes first, the most recent insertion
+    // first, followed by text inserted after it, in order, and then the
+    // replacement text, the most recent replacement first.
+    size_t InsertStart = Result.size();
+    for (size_t J = GroupEnd; J != I; --J)
+      if (Sorted[J - 1]->Kind == Edit::InsertBefore)
+        Result.append(Sorted[J - 1]->Text.begin(), Sorted[J - 1]->Text.end());
+    for (size_t J = I; J != GroupEnd; ++J)
+      if (Sorted[J]->Kind == Edit::InsertAfter)
+        Result.append(Sorted[J]->Text.begin(), Sorted[J]->Text.end());
+    size_t ReplaceStart = Result.size();
+    unsigned Removed = 0;
+    for (size_t J = GroupEnd; J != I; --J) {
+      if (Sorted[J - 1]->Kind != Edit::Replace)
+        continue;
+      Result.append(Sorted[J - 1]->Text.begin(), Sorted[J - 1]->Text.end());
+      Removed += Sorted[J - 1]->OrigLength;
+    }
+    Pos += Removed;
+
+    // Record the combined deltas of the edits at this offset.
+    if (unsigned Inserted = ReplaceStart - InsertStart)
+      AddInsertDelta(Offset, Inserted);
+    unsigned Replaced = Result.size() - ReplaceStart;
+    if (Replaced != Removed)
+      AddReplaceDelta(Offset, Replaced - Removed);
+
+    I = GroupEnd;
+  }
+  Result.append(Original, Pos, std::string::npos);
+
+  Buffer.assign(Result.data(), Result.data() + Result.size());
+  HasEdits = true;
+  return true;
 }
 
 
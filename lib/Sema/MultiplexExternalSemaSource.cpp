@@ -186,6 +186,13 @@ getMemoryBufferSizes(MemoryBufferSizes &sizes) const {
 
 }
 
+size_t MultiplexExternalSemaSource::getDataStructureSizes() const {
+  size_t size = 0;
+  for(size_t i = 0; i < Sources.size(); ++i)
+    size += Sources[i]->getDataStructureSizes();
+  return size;
+}
+
 //===----------------------------------------------------------------------===//
 // ExternalSemaSource.
 //===----------------------------------------------------------------------===//
@@ -110,6 +110,7 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
   TUScope = nullptr;
 
   LoadedExternalKnownNamespaces = false;
+  KeepMainFileFunctionBodies = false;
   for (unsigned I = 0; I != NSAPI::NumNSNumberLiteralMethods; ++I)
     NSNumberLiteralMethods[I] = nullptr;
 
@@ -375,6 +376,16 @@ void Sema::PrintStats() const {
   AnalysisWarnings.PrintStats();
 }
 
+size_t Sema::getTotalMemory() const {
+  return BumpAlloc.getTotalMemory()
+    + llvm::capacity_in_bytes(ExtnameUndeclaredIdentifiers)
+    + llvm::capacity_in_bytes(UnparsedDefaultArgLocs)
+    + llvm::capacity_in_bytes(ShadowingDecls)
+    + llvm::capacity_in_bytes(VTableUses)
+    + llvm::capacity_in_bytes(VTablesUsed)
+    + llvm::capacity_in_bytes(VisibleNamespaceCache);
+}
+
 void Sema::diagnoseNullableToNonnullConversion(QualType DstType,
                                                QualType SrcType,
                                                SourceLocation Loc) {
@@ -728,6 +739,14 @@ void Sema::ActOnEndOfTranslationUnit() {
       LateTemplateParserCleanup(OpaqueParser);
 
     CheckDelayedMemberExceptionSpecs();
+  } else if (LangOpts.PCHInstantiateTemplates) {
+    // Perform the instantiations that this prefix needs now, so that their
+    // definitions are written out with it and every user of the PCH loads
+    // them instead of instantiating them again. This is opt-in: the
+    // instantiations happen at the end of the prefix rather than at the end
+    // of each user's translation unit, so they cannot see declarations that
+    // follow the inclusion of the PCH.
+    PerformPendingInstantiations();
   }
 
   // All delayed member exception specs should be checked or we end up accepting
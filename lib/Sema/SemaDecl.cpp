@@ -11970,6 +11970,26 @@ bool Sema::canSkipFunctionBody(Decl *D) {
   return Consumer.shouldSkipFunctionBody(D);
 }
 
+bool Sema::mayKeepFunctionBody(SourceLocation Loc) {
+  return KeepMainFileFunctionBodies &&
+         SourceMgr.isInMainFile(SourceMgr.getExpansionLoc(Loc));
+}
+
+bool Sema::isKeptFunctionBody(SourceRange Body) {
+  if (!mayKeepFunctionBody(Body.getBegin()))
+    return false;
+  if (KeptFunctionBodyLines.empty())
+    return true;
+
+  unsigned BeginLine = SourceMgr.getExpansionLineNumber(Body.getBegin());
+  unsigned EndLine = SourceMgr.getExpansionLineNumber(Body.getEnd());
+  return llvm::any_of(KeptFunctionBodyLines,
+                      [=](const std::pair<unsigned, unsigned> &Lines) {
+                        return Lines.first <= EndLine &&
+                               BeginLine <= Lines.second;
+                      });
+}
+
 Decl *Sema::ActOnSkippedFunctionBody(Decl *Decl) {
   if (FunctionDecl *FD = dyn_cast_or_null<FunctionDecl>(Decl))
     FD->setHasSkippedBody();
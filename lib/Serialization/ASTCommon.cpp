@@ -17,6 +17,8 @@
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Serialization/ASTDeserializationListener.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/MD5.h"
 
 using namespace clang;
 
@@ -172,6 +174,16 @@ unsigned serialization::ComputeHash(Selector Sel) {
   return R;
 }
 
+uint64_t serialization::ComputeInputFileHash(StringRef Contents) {
+  llvm::MD5 Hash;
+  Hash.update(Contents);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  using namespace llvm::support;
+  uint64_t Value = endian::read<uint64_t, little, unaligned>(Result);
+  return Value ? Value : 1;
+}
+
 const DeclContext *
 serialization::getDefinitiveDeclContext(const DeclContext *DC) {
   switch (DC->getDeclKind()) {
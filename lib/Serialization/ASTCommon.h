@@ -71,6 +71,29 @@ TypeID MakeTypeID(ASTContext &Context, QualType T, IdxForTypeTy IdxForType) {
 
 unsigned ComputeHash(Selector Sel);
 
+/// \brief Compute the hash of the contents of an input file that is stored
+/// in its INPUT_FILE_HASH record. Zero is reserved for unknown contents.
+uint64_t ComputeInputFileHash(StringRef Contents);
+
+/// \brief Compute the two bits that an identifier with the given hash sets in
+/// an IDENTIFIER_FILTER of 2^\p Log2NumBits bits.
+inline std::pair<unsigned, unsigned>
+getIdentifierFilterBits(unsigned Hash, unsigned Log2NumBits) {
+  unsigned Mask = (1U << Log2NumBits) - 1;
+  return std::make_pair(Hash & Mask,
+                        ((Hash * 0x9E3779B1U) >> (32 - Log2NumBits)) & Mask);
+}
+
+/// \brief Determine whether an identifier with the given hash may be in the
+/// identifier table that \p Filter was built for.
+inline bool identifierFilterMayContain(const unsigned char *Filter,
+                                       unsigned Log2NumBits, unsigned Hash) {
+  std::pair<unsigned, unsigned> Bits =
+      getIdentifierFilterBits(Hash, Log2NumBits);
+  return (Filter[Bits.first / 8] & (1U << (Bits.first % 8))) &&
+         (Filter[Bits.second / 8] & (1U << (Bits.second % 8)));
+}
+
 /// \brief Retrieve the "definitive" declaration that provides all of the
 /// visible entries for the given declaration context, if there is one.
 ///
@@ -71,6 +71,7 @@
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Bitcode/BitstreamReader.h"
+#include "llvm/Support/Capacity.h"
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Error.h"
@@ -1297,6 +1298,18 @@ bool ASTReader::ReadSLocEntry(int ID) {
       return llvm::MemoryBuffer::getMemBufferCopy(Uncompressed, Name);
     } else if (RecCode == SM_SLOC_BUFFER_BLOB) {
       return llvm::MemoryBuffer::getMemBuffer(Blob.drop_back(1), Name, true);
+    } else if (RecCode == SM_SLOC_BUFFER_BLOB_REF) {
+      // The contents live in a content store shared with other AST files;
+      // map them from there. The file was validated along with the input
+      // files, so it can only be damaged if that was disabled or the file was
+      // modified since.
+      auto Buffer = llvm::MemoryBuffer::getFile(Blob);
+      if (!Buffer || (*Buffer)->getBufferSize() != Record[0]) {
+        Error(("could not read embedded file contents from '" + Blob + "'")
+                  .str());
+        return nullptr;
+      }
+      return std::move(*Buffer);
     } else {
       Error("AST record has invalid code");
       return nullptr;
@@ -1484,8 +1497,16 @@ MacroInfo *ASTReader::ReadMacroRecord(ModuleFile &F, uint64_t Offset) {
   Stream.JumpToBit(Offset);
   RecordData Record;
   SmallVector<IdentifierInfo*, 16> MacroArgs;
+  SmallVector<Token, 16> MacroTokens;
   MacroInfo *Macro = nullptr;
 
+  // Install the tokens read for the macro before handing it out.
+  auto FinishMacro = [&]() -> MacroInfo * {
+    if (Macro)
+      Macro->setTokens(MacroTokens, PP.getPreprocessorAllocator());
+    return Macro;
+  };
+
   while (true) {
     // Advance to the next record, but if we get to the end of the block, don't
     // pop it (removing all the abbreviations from the cursor) since we want to
@@ -1497,9 +1518,9 @@ MacroInfo *ASTReader::ReadMacroRecord(ModuleFile &F, uint64_t Offset) {
     case llvm::BitstreamEntry::SubBlock: // Handled for us already.
     case llvm::BitstreamEntry::Error:
       Error("malformed block record in AST file");
-      return Macro;
+      return FinishMacro();
     case llvm::BitstreamEntry::EndBlock:
-      return Macro;
+      return FinishMacro();
     case llvm::BitstreamEntry::Record:
       // The interesting case.
       break;
@@ -1512,7 +1533,7 @@ MacroInfo *ASTReader::ReadMacroRecord(ModuleFile &F, uint64_t Offset) {
     switch (RecType) {
     case PP_MODULE_MACRO:
     case PP_MACRO_DIRECTIVE_HISTORY:
-      return Macro;
+      return FinishMacro();
 
     case PP_MACRO_OBJECT_LIKE:
     case PP_MACRO_FUNCTION_LIKE: {
@@ -1520,7 +1541,7 @@ MacroInfo *ASTReader::ReadMacroRecord(ModuleFile &F, uint64_t Offset) {
       // of the definition of the macro we were looking for. We're
       // done.
       if (Macro)
-        return Macro;
+        return FinishMacro();
 
       unsigned NextIndex = 1; // Skip identifier ID.
       SubmoduleID SubModID = getGlobalSubmoduleID(F, Record[NextIndex++]);
@@ -1577,7 +1598,7 @@ MacroInfo *ASTReader::ReadMacroRecord(ModuleFile &F, uint64_t Offset) {
 
       unsigned Idx = 0;
       Token Tok = ReadToken(F, Record, Idx);
-      Macro->AddTokenToBody(Tok);
+      MacroTokens.push_back(Tok);
       break;
     }
     }
@@ -1777,16 +1798,19 @@ namespace {
     unsigned PriorGeneration;
     unsigned &NumIdentifierLookups;
     unsigned &NumIdentifierLookupHits;
+    unsigned &NumIdentifierLookupsFiltered;
     IdentifierInfo *Found;
 
   public:
     IdentifierLookupVisitor(StringRef Name, unsigned PriorGeneration,
                             unsigned &NumIdentifierLookups,
-                            unsigned &NumIdentifierLookupHits)
+                            unsigned &NumIdentifierLookupHits,
+                            unsigned &NumIdentifierLookupsFiltered)
       : Name(Name), NameHash(ASTIdentifierLookupTrait::ComputeHash(Name)),
         PriorGeneration(PriorGeneration),
         NumIdentifierLookups(NumIdentifierLookups),
         NumIdentifierLookupHits(NumIdentifierLookupHits),
+        NumIdentifierLookupsFiltered(NumIdentifierLookupsFiltered),
         Found()
     {
     }
@@ -1801,6 +1825,14 @@ namespace {
       if (!IdTable)
         return false;
 
+      // Don't probe the table if its filter says the identifier isn't there.
+      if (M.IdentifierFilter &&
+          !identifierFilterMayContain(M.IdentifierFilter,
+                                      M.IdentifierFilterLog2Bits, NameHash)) {
+        ++NumIdentifierLookupsFiltered;
+        return false;
+      }
+
       ASTIdentifierLookupTrait Trait(IdTable->getInfoObj().getReader(), M,
                                      Found);
       ++NumIdentifierLookups;
@@ -1844,7 +1876,8 @@ void ASTReader::updateOutOfDateIdentifier(IdentifierInfo &II) {
 
   IdentifierLookupVisitor Visitor(II.getName(), PriorGeneration,
                                   NumIdentifierLookups,
-                                  NumIdentifierLookupHits);
+                                  NumIdentifierLookupHits,
+                                  NumIdentifierLookupsFiltered);
   ModuleMgr.visit(Visitor, HitsPtr);
   markIdentifierUpToDate(&II);
 }
@@ -1994,6 +2027,20 @@ ASTReader::readInputFileInfo(ModuleFile &F, unsigned ID) {
   R.Transient = static_cast<bool>(Record[4]);
   R.Filename = Blob;
   ResolveImportedPath(F, R.Filename);
+
+  // The hash of the contents follows each input file in AST files written
+  // since version 6.2. Without it, the file is validated by its size and
+  // modification time only.
+  R.ContentHash = 0;
+  llvm::BitstreamEntry Entry =
+      Cursor.advance(BitstreamCursor::AF_DontPopBlockAtEnd);
+  if (Entry.Kind != llvm::BitstreamEntry::Record)
+    return R;
+  Record.clear();
+  Result = Cursor.readRecord(Entry.ID, Record);
+  if (static_cast<InputFileRecordTypes>(Result) == INPUT_FILE_HASH &&
+      Record.size() == 2)
+    R.ContentHash = Record[0] | (Record[1] << 32);
   return R;
 }
 
@@ -2078,13 +2125,31 @@ InputFile ASTReader::getInputFile(ModuleFile &F, unsigned ID, bool Complain) {
                             StoredSize, StoredTime);
   }
 
+  // A file whose modification time changed, e.g., by a checkout, is still up
+  // to date if its contents match the hash stored in the AST file. Only read
+  // them when the timestamps differ.
+  auto HasStoredContents = [&]() -> bool {
+    const HeaderSearchOptions &HSOpts =
+        PP.getHeaderSearchInfo().getHeaderSearchOpts();
+    if (!FI.ContentHash || !HSOpts.ValidateASTInputFilesContent)
+      return false;
+    uint64_t &Hash = InputFileContentHashes[File];
+    if (!Hash) {
+      auto Buffer = FileMgr.getBufferForFile(File);
+      if (!Buffer)
+        return false;
+      Hash = ComputeInputFileHash((*Buffer)->getBuffer());
+    }
+    return Hash == FI.ContentHash;
+  };
+
   bool IsOutOfDate = false;
 
   // For an overridden file, there is nothing to validate.
   if (!Overridden && //
       (StoredSize != File->getSize() ||
        (StoredTime && StoredTime != File->getModificationTime() &&
-        !DisableValidation)
+        !DisableValidation && !HasStoredContents())
        )) {
     if (Complain) {
       // Build a list of the PCH imports that got us here (in reverse).
@@ -2529,6 +2594,31 @@ ASTReader::ReadControlBlock(ModuleFile &F,
       F.InputFilesLoaded.resize(NumInputs);
       F.NumUserInputFiles = NumUserInputs;
       break;
+
+    case CONTENT_STORE_FILE: {
+      // A content store file that went missing or was damaged makes the AST
+      // file out of date, like a modified input file, so that a module is
+      // rebuilt instead of failing once the contents are needed.
+      if (DisableValidation || ValidatedContentStoreFiles.count(Blob))
+        break;
+      uint64_t ContentHash = Record[1] | (uint64_t(Record[2]) << 32);
+      auto Buffer = llvm::MemoryBuffer::getFile(Blob);
+      if (!Buffer || (*Buffer)->getBufferSize() != Record[0] ||
+          ComputeInputFileHash((*Buffer)->getBuffer()) != ContentHash) {
+        if ((ClientLoadCapabilities & ARR_OutOfDate) == 0) {
+          unsigned DiagnosticKind = moduleKindForDiagnostic(F.Kind);
+          if (DiagnosticKind == 0)
+            Error(diag::err_fe_pch_file_modified, Blob, F.FileName);
+          else if (DiagnosticKind == 1)
+            Error(diag::err_fe_module_file_modified, Blob, F.FileName);
+          else
+            Error(diag::err_fe_ast_file_modified, Blob, F.FileName);
+        }
+        return OutOfDate;
+      }
+      ValidatedContentStoreFiles.insert(Blob);
+      break;
+    }
     }
   }
 }
@@ -2743,6 +2833,16 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
       }
       break;
 
+    case IDENTIFIER_FILTER:
+      // Ignore filters we can't interpret rather than risk skipping a table
+      // that has the identifier.
+      if (Record[0] >= 6 && Record[0] < 32 &&
+          Blob.size() == (size_t(1) << Record[0]) / 8) {
+        F.IdentifierFilter = (const unsigned char *)Blob.data();
+        F.IdentifierFilterLog2Bits = Record[0];
+      }
+      break;
+
     case IDENTIFIER_OFFSET: {
       if (F.LocalNumIdentifiers != 0) {
         Error("duplicate IDENTIFIER_OFFSET record in AST file");
@@ -4497,6 +4597,8 @@ bool ASTReader::readASTFileControlBlock(
         StringRef Blob;
         bool shouldContinue = false;
         switch ((InputFileRecordTypes)Cursor.readRecord(Code, Record, &Blob)) {
+        case INPUT_FILE_HASH:
+          llvm_unreachable("input file offset refers to a hash record");
         case INPUT_FILE:
           bool Overridden = static_cast<bool>(Record[3]);
           std::string Filename = Blob;
@@ -7133,6 +7235,14 @@ void ASTReader::PrintStats() {
                  NumIdentifierLookupHits, NumIdentifierLookups,
                  (double)NumIdentifierLookupHits*100.0/NumIdentifierLookups);
   }
+  if (NumIdentifierLookupsFiltered) {
+    unsigned NumAttempts = NumIdentifierLookups + NumIdentifierLookupsFiltered;
+    std::fprintf(stderr,
+                 "  %u / %u identifier table lookups skipped by filters "
+                 "(%f%%)\n",
+                 NumIdentifierLookupsFiltered, NumAttempts,
+                 (double)NumIdentifierLookupsFiltered * 100.0 / NumAttempts);
+  }
 
   if (GlobalIndex) {
     std::fprintf(stderr, "\n");
@@ -7197,6 +7307,17 @@ void ASTReader::getMemoryBufferSizes(MemoryBufferSizes &sizes) const {
   }
 }
 
+size_t ASTReader::getDataStructureSizes() const {
+  return llvm::capacity_in_bytes(TypesLoaded)
+    + llvm::capacity_in_bytes(DeclsLoaded)
+    + llvm::capacity_in_bytes(IdentifiersLoaded)
+    + llvm::capacity_in_bytes(MacrosLoaded)
+    + llvm::capacity_in_bytes(SubmodulesLoaded)
+    + llvm::capacity_in_bytes(SelectorsLoaded)
+    + llvm::capacity_in_bytes(Lookups)
+    + llvm::capacity_in_bytes(PendingVisibleUpdates);
+}
+
 void ASTReader::InitializeSema(Sema &S) {
   SemaObj = &S;
   S.addExternalSource(this);
@@ -7261,7 +7382,8 @@ IdentifierInfo *ASTReader::get(StringRef Name) {
 
   IdentifierLookupVisitor Visitor(Name, /*PriorGeneration=*/0,
                                   NumIdentifierLookups,
-                                  NumIdentifierLookupHits);
+                                  NumIdentifierLookupHits,
+                                  NumIdentifierLookupsFiltered);
 
   // We don't need to do identifier table lookups in C++ modules (we preload
   // all interesting declarations, and don't need to use the scope for name
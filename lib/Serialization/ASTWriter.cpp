@@ -75,6 +75,8 @@
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/OnDiskHashTable.h"
 #include "llvm/Support/Path.h"
@@ -1025,6 +1027,7 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(ORIGINAL_PCH_DIR);
   RECORD(ORIGINAL_FILE_ID);
   RECORD(INPUT_FILE_OFFSETS);
+  RECORD(CONTENT_STORE_FILE);
 
   BLOCK(OPTIONS_BLOCK);
   RECORD(LANGUAGE_OPTIONS);
@@ -1036,6 +1039,7 @@ void ASTWriter::WriteBlockInfoBlock() {
 
   BLOCK(INPUT_FILES_BLOCK);
   RECORD(INPUT_FILE);
+  RECORD(INPUT_FILE_HASH);
 
   // AST Top-Level Block.
   BLOCK(AST_BLOCK);
@@ -1043,6 +1047,7 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(DECL_OFFSET);
   RECORD(IDENTIFIER_OFFSET);
   RECORD(IDENTIFIER_TABLE);
+  RECORD(IDENTIFIER_FILTER);
   RECORD(EAGERLY_DESERIALIZED_DECLS);
   RECORD(MODULAR_CODEGEN_DECLS);
   RECORD(SPECIAL_TYPES);
@@ -1097,6 +1102,7 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(SM_SLOC_BUFFER_ENTRY);
   RECORD(SM_SLOC_BUFFER_BLOB);
   RECORD(SM_SLOC_BUFFER_BLOB_COMPRESSED);
+  RECORD(SM_SLOC_BUFFER_BLOB_REF);
   RECORD(SM_SLOC_EXPANSION_ENTRY);
 
   // Preprocessor Block.
@@ -1650,10 +1656,63 @@ namespace  {
     bool IsSystemFile;
     bool IsTransient;
     bool BufferOverridden;
+    uint64_t ContentHash;
   };
 
 } // end anonymous namespace
 
+/// \brief Store \p Contents in the content-addressed store in \p StoreDir.
+///
+/// The file is named after a hash of its contents, so AST files that embed
+/// the same contents share a single copy, which readers map rather than
+/// decompress. Files are written to a temporary and renamed into place, so
+/// an existing file is always complete; one whose contents were damaged is
+/// replaced.
+///
+/// \returns true and sets \p Path to the stored file on success.
+static bool storeInContentStore(StringRef StoreDir, StringRef Contents,
+                                SmallVectorImpl<char> &Path) {
+  llvm::MD5 Hash;
+  Hash.update(Contents);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> HashString;
+  llvm::MD5::stringifyResult(Result, HashString);
+
+  Path.assign(StoreDir.begin(), StoreDir.end());
+  llvm::sys::path::append(Path, HashString);
+  if (auto Existing = llvm::MemoryBuffer::getFile(Path))
+    if ((*Existing)->getBuffer() == Contents)
+      return true;
+
+  if (llvm::sys::fs::create_directories(StoreDir))
+    return false;
+
+  int FD;
+  SmallString<128> TempPath;
+  if (llvm::sys::fs::createUniqueFile(
+          Twine(StringRef(Path.data(), Path.size())) + "-%%%%%%%%.tmp", FD,
+          TempPath))
+    return false;
+
+  {
+    llvm::raw_fd_ostream Out(FD, /*shouldClose=*/true);
+    Out << Contents;
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return false;
+    }
+  }
+
+  if (llvm::sys::fs::rename(TempPath, Path)) {
+    llvm::sys::fs::remove(TempPath);
+    return false;
+  }
+  return true;
+}
+
 void ASTWriter::WriteInputFiles(SourceManager &SourceMgr,
                                 HeaderSearchOptions &HSOpts,
                                 bool Modules) {
@@ -1671,6 +1730,30 @@ void ASTWriter::WriteInputFiles(SourceManager &SourceMgr,
   IFAbbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob)); // File name
   unsigned IFAbbrevCode = Stream.EmitAbbrev(std::move(IFAbbrev));
 
+  // Create input-file hash abbreviation.
+  auto IFHAbbrev = std::make_shared<BitCodeAbbrev>();
+  IFHAbbrev->Add(BitCodeAbbrevOp(INPUT_FILE_HASH));
+  IFHAbbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32)); // Lower bits
+  IFHAbbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32)); // Upper bits
+  unsigned IFHAbbrevCode = Stream.EmitAbbrev(std::move(IFHAbbrev));
+
+  // When writing a module into a module cache that has a content store, the
+  // contents of embedded files go into the store rather than into the module
+  // file.
+  SmallString<128> ContentStoreDir;
+  if (WritingModule && HSOpts.ModulesContentStore &&
+      !HSOpts.ModuleCachePath.empty()) {
+    ContentStoreDir = HSOpts.ModuleCachePath;
+    llvm::sys::path::append(ContentStoreDir, "content");
+    llvm::sys::fs::make_absolute(ContentStoreDir);
+  }
+  struct StoredFile {
+    std::string Path;
+    uint64_t Size;
+    uint64_t ContentHash;
+  };
+  std::vector<StoredFile> StoredFiles;
+
   // Get all ContentCache objects for files, sorted by whether the file is a
   // system one or not. System files go at the back, users files at the front.
   std::deque<InputFileEntry> SortedFiles;
@@ -1691,6 +1774,29 @@ void ASTWriter::WriteInputFiles(SourceManager &SourceMgr,
     Entry.IsSystemFile = Cache->IsSystemFile;
     Entry.IsTransient = Cache->IsTransient;
     Entry.BufferOverridden = Cache->BufferOverridden;
+    // Only hash the contents that were already read: a file that was never
+    // entered has no buffer, and is validated by its timestamp only.
+    Entry.ContentHash = 0;
+    if (HSOpts.ValidateASTInputFilesContent && !Cache->BufferOverridden)
+      if (const llvm::MemoryBuffer *Buffer = Cache->getRawBuffer())
+        Entry.ContentHash = ComputeInputFileHash(Buffer->getBuffer());
+
+    // The contents of the file are embedded in the AST file; store them now,
+    // so that the control block can record what the AST file depends on.
+    if (!ContentStoreDir.empty() &&
+        (Cache->BufferOverridden || Cache->IsTransient) &&
+        !ContentStoreFiles.count(Cache->OrigEntry)) {
+      const llvm::MemoryBuffer *Buffer =
+          Cache->getBuffer(SourceMgr.getDiagnostics(), SourceMgr);
+      SmallString<128> StoredPath;
+      if (storeInContentStore(ContentStoreDir, Buffer->getBuffer(),
+                              StoredPath)) {
+        ContentStoreFiles[Cache->OrigEntry] = StoredPath.str();
+        StoredFiles.push_back({StoredPath.str(), Buffer->getBufferSize(),
+                               ComputeInputFileHash(Buffer->getBuffer())});
+      }
+    }
+
     if (Cache->IsSystemFile)
       SortedFiles.push_back(Entry);
     else
@@ -1724,6 +1830,11 @@ void ASTWriter::WriteInputFiles(SourceManager &SourceMgr,
         Entry.IsTransient};
 
     EmitRecordWithPath(IFAbbrevCode, Record, Entry.File->getName());
+
+    RecordData::value_type HashRecord[] = {
+        INPUT_FILE_HASH, uint32_t(Entry.ContentHash),
+        uint32_t(Entry.ContentHash >> 32)};
+    Stream.EmitRecordWithAbbrev(IFHAbbrevCode, HashRecord);
   }
 
   Stream.ExitBlock();
@@ -1741,6 +1852,27 @@ void ASTWriter::WriteInputFiles(SourceManager &SourceMgr,
   RecordData::value_type Record[] = {INPUT_FILE_OFFSETS,
                                      InputFileOffsets.size(), UserFilesNum};
   Stream.EmitRecordWithBlob(OffsetsAbbrevCode, Record, bytes(InputFileOffsets));
+
+  if (StoredFiles.empty())
+    return;
+
+  // Write the content store files that the embedded files refer to, with the
+  // size and hash of their contents, so that readers can check them when
+  // validating the AST file.
+  auto StoredAbbrev = std::make_shared<BitCodeAbbrev>();
+  StoredAbbrev->Add(BitCodeAbbrevOp(CONTENT_STORE_FILE));
+  StoredAbbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));     // Size
+  StoredAbbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32)); // Lower bits
+  StoredAbbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32)); // Upper bits
+  StoredAbbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));      // Path
+  unsigned StoredAbbrevCode = Stream.EmitAbbrev(std::move(StoredAbbrev));
+
+  for (const StoredFile &File : StoredFiles) {
+    RecordData::value_type StoredRecord[] = {CONTENT_STORE_FILE, File.Size,
+                                             uint32_t(File.ContentHash),
+                                             uint32_t(File.ContentHash >> 32)};
+    Stream.EmitRecordWithBlob(StoredAbbrevCode, StoredRecord, File.Path);
+  }
 }
 
 //===----------------------------------------------------------------------===//
@@ -1796,6 +1928,18 @@ static unsigned CreateSLocBufferBlobAbbrev(llvm::BitstreamWriter &Stream,
   return Stream.EmitAbbrev(std::move(Abbrev));
 }
 
+/// \brief Create an abbreviation for the SLocEntry that refers to a buffer
+/// stored in a content store.
+static unsigned CreateSLocBufferBlobRefAbbrev(llvm::BitstreamWriter &Stream) {
+  using namespace llvm;
+
+  auto Abbrev = std::make_shared<BitCodeAbbrev>();
+  Abbrev->Add(BitCodeAbbrevOp(SM_SLOC_BUFFER_BLOB_REF));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8)); // Size
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob)); // Path in the store
+  return Stream.EmitAbbrev(std::move(Abbrev));
+}
+
 /// \brief Create an abbreviation for the SLocEntry that refers to a macro
 /// expansion.
 static unsigned CreateSLocExpansionAbbrev(llvm::BitstreamWriter &Stream) {
@@ -2049,6 +2193,12 @@ void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
       CreateSLocBufferBlobAbbrev(Stream, true);
   unsigned SLocExpansionAbbrv = CreateSLocExpansionAbbrev(Stream);
 
+  // The contents of embedded files that were written to a content store along
+  // with the input files are referred to rather than embedded.
+  unsigned SLocBufferBlobRefAbbrv = 0;
+  if (!ContentStoreFiles.empty())
+    SLocBufferBlobRefAbbrv = CreateSLocBufferBlobRefAbbrev(Stream);
+
   // Write out the source location entry table. We skip the first
   // entry, which is always the same dummy entry.
   std::vector<uint32_t> SLocEntryOffsets;
@@ -2133,9 +2283,20 @@ void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
         // if we're writing it uncompressed.
         const llvm::MemoryBuffer *Buffer =
             Content->getBuffer(PP.getDiagnostics(), PP.getSourceManager());
-        StringRef Blob(Buffer->getBufferStart(), Buffer->getBufferSize() + 1);
-        emitBlob(Stream, Blob, SLocBufferBlobCompressedAbbrv,
-                 SLocBufferBlobAbbrv);
+        auto StoredFile = Content->OrigEntry
+                              ? ContentStoreFiles.find(Content->OrigEntry)
+                              : ContentStoreFiles.end();
+        if (StoredFile != ContentStoreFiles.end()) {
+          RecordData::value_type Record[] = {SM_SLOC_BUFFER_BLOB_REF,
+                                             Buffer->getBufferSize()};
+          Stream.EmitRecordWithBlob(SLocBufferBlobRefAbbrv, Record,
+                                    StoredFile->second);
+        } else {
+          StringRef Blob(Buffer->getBufferStart(),
+                         Buffer->getBufferSize() + 1);
+          emitBlob(Stream, Blob, SLocBufferBlobCompressedAbbrv,
+                   SLocBufferBlobAbbrv);
+        }
       }
     } else {
       // The source location entry is a macro expansion.
@@ -3470,6 +3631,7 @@ void ASTWriter::WriteIdentifierTable(Preprocessor &PP,
     // Create the on-disk hash table representation. We only store offsets
     // for identifiers that appear here for the first time.
     IdentifierOffsets.resize(NextIdentID - FirstIdentID);
+    SmallVector<unsigned, 128> Hashes;
     for (auto IdentIDPair : IdentifierIDs) {
       auto *II = const_cast<IdentifierInfo *>(IdentIDPair.first);
       IdentID ID = IdentIDPair.second;
@@ -3479,8 +3641,10 @@ void ASTWriter::WriteIdentifierTable(Preprocessor &PP,
       if (ID >= FirstIdentID || !Chain || !II->isFromAST()
           || II->hasChangedSinceDeserialization() ||
           (Trait.needDecls() &&
-           II->hasFETokenInfoChangedSinceDeserialization()))
+           II->hasFETokenInfoChangedSinceDeserialization())) {
         Generator.insert(II, ID, Trait);
+        Hashes.push_back(Trait.ComputeHash(II));
+      }
     }
 
     // Create the on-disk hash table in a buffer.
@@ -3504,6 +3668,33 @@ void ASTWriter::WriteIdentifierTable(Preprocessor &PP,
     // Write the identifier table
     RecordData::value_type Record[] = {IDENTIFIER_TABLE, BucketOffset};
     Stream.EmitRecordWithBlob(IDTableAbbrev, Record, IdentifierTable);
+
+    // Write a Bloom filter over the identifiers in the table, with about ten
+    // bits per identifier, so that readers looking up an identifier across
+    // many AST files can skip most of the files that don't have it.
+    if (!Hashes.empty()) {
+      unsigned Log2NumBits = 6;
+      while (Log2NumBits < 31 && (1ULL << Log2NumBits) < Hashes.size() * 10)
+        ++Log2NumBits;
+
+      SmallString<1024> Filter;
+      Filter.resize((1U << Log2NumBits) / 8, 0);
+      for (unsigned Hash : Hashes) {
+        std::pair<unsigned, unsigned> Bits =
+            getIdentifierFilterBits(Hash, Log2NumBits);
+        Filter[Bits.first / 8] |= 1U << (Bits.first % 8);
+        Filter[Bits.second / 8] |= 1U << (Bits.second % 8);
+      }
+
+      auto Abbrev = std::make_shared<BitCodeAbbrev>();
+      Abbrev->Add(BitCodeAbbrevOp(IDENTIFIER_FILTER));
+      Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 5)); // log2(# bits)
+      Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+      unsigned FilterAbbrev = Stream.EmitAbbrev(std::move(Abbrev));
+
+      RecordData::value_type Record[] = {IDENTIFIER_FILTER, Log2NumBits};
+      Stream.EmitRecordWithBlob(FilterAbbrev, Record, Filter);
+    }
   }
 
   // Write the offsets table for identifier IDs.
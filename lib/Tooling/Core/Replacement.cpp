@@ -539,6 +539,27 @@ unsigned Replacements::getShiftedCodePosition(unsigned Position) const {
 }
 
 bool applyAllReplacements(const Replacements &Replaces, Rewriter &Rewrite) {
+  if (Replaces.empty())
+    return true;
+
+  // All replacements are in the same file, so hand them to its rewrite buffer
+  // as a single batch, which can apply them in one pass.
+  const Replacement &First = *Replaces.begin();
+  SourceManager &SM = Rewrite.getSourceMgr();
+  const FileEntry *Entry = First.isApplicable()
+                               ? SM.getFileManager().getFile(First.getFilePath())
+                               : nullptr;
+  if (Entry) {
+    FileID ID = SM.getOrCreateFileID(Entry, SrcMgr::C_User);
+    std::vector<RewriteBuffer::Edit> Edits;
+    Edits.reserve(Replaces.size());
+    for (auto I = Replaces.rbegin(), E = Replaces.rend(); I != E; ++I)
+      Edits.push_back({RewriteBuffer::Edit::Replace, I->getOffset(),
+                       I->getLength(), I->getReplacementText()});
+    Rewrite.getEditBuffer(ID).applyEdits(Edits);
+    return true;
+  }
+
   bool Result = true;
   for (auto I = Replaces.rbegin(), E = Replaces.rend(); I != E; ++I) {
     if (I->isApplicable()) {
@@ -555,30 +576,31 @@ llvm::Expected<std::string> applyAllReplacements(StringRef Code,
   if (Replaces.empty())
     return Code.str();
 
-  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFileSystem(
-      new vfs::InMemoryFileSystem);
-  FileManager Files(FileSystemOptions(), InMemoryFileSystem);
-  DiagnosticsEngine Diagnostics(
-      IntrusiveRefCntPtr<DiagnosticIDs>(new DiagnosticIDs),
-      new DiagnosticOptions);
-  SourceManager SourceMgr(Diagnostics, Files);
-  Rewriter Rewrite(SourceMgr, LangOptions());
-  InMemoryFileSystem->addFile(
-      "<stdin>", 0, llvm::MemoryBuffer::getMemBuffer(Code, "<stdin>"));
-  FileID ID = SourceMgr.createFileID(Files.getFile("<stdin>"), SourceLocation(),
-                                     clang::SrcMgr::C_User);
-  for (auto I = Replaces.rbegin(), E = Replaces.rend(); I != E; ++I) {
-    Replacement Replace("<stdin>", I->getOffset(), I->getLength(),
-                        I->getReplacementText());
-    if (!Replace.apply(Rewrite))
+  // Replacements are kept sorted and non-overlapping, so the new code can be
+  // built in a single pass over the old one, without a Rewriter.
+  size_t ResultSize = Code.size();
+  unsigned Pos = 0;
+  for (const Replacement &R : Replaces) {
+    if (R.getOffset() < Pos || R.getOffset() + R.getLength() > Code.size())
       return llvm::make_error<ReplacementError>(
-          replacement_error::fail_to_apply, Replace);
+          replacement_error::fail_to_apply,
+          Replacement("<stdin>", R.getOffset(), R.getLength(),
+                      R.getReplacementText()));
+    ResultSize += R.getReplacementText().size();
+    ResultSize -= R.getLength();
+    Pos = R.getOffset() + R.getLength();
   }
+
   std::string Result;
-  llvm::raw_string_ostream OS(Result);
-  Rewrite.getEditBuffer(ID).write(OS);
-  OS.flush();
-  return Result;
+  Result.reserve(ResultSize);
+  Pos = 0;
+  for (const Replacement &R : Replaces) {
+    Result.append(Code.data() + Pos, R.getOffset() - Pos);
+    Result.append(R.getReplacementText());
+    Pos = R.getOffset() + R.getLength();
+  }
+  Result.append(Code.data() + Pos, Code.size() - Pos);
+  return std::move(Result);
 }
 
 std::map<std::string, Replacements> groupReplacementsByFile(
@@ -0,0 +1,136 @@
+//===--- DependencyScanningTool.cpp - Scan dependencies of a TU -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Tooling/DependencyScanningTool.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Frontend/Utils.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+using namespace tooling;
+
+namespace {
+
+/// \brief Collects the dependencies that -M or -MM would write.
+class ScanDependencyCollector : public DependencyCollector {
+  bool IncludeSystemHeaders;
+
+public:
+  explicit ScanDependencyCollector(bool IncludeSystemHeaders)
+      : IncludeSystemHeaders(IncludeSystemHeaders) {}
+
+  bool needSystemDependencies() override { return IncludeSystemHeaders; }
+
+  bool sawDependency(StringRef Filename, bool FromModule, bool IsSystem,
+                     bool IsModuleFile, bool IsMissing) override {
+    // Missing files are diagnosed by the scan instead.
+    return !IsMissing &&
+           DependencyCollector::sawDependency(Filename, FromModule, IsSystem,
+                                              IsModuleFile, IsMissing);
+  }
+};
+
+/// \brief Print \p Filename as a Makefile target or prerequisite.
+void printMakefileName(raw_ostream &OS, StringRef Filename) {
+  for (char C : Filename) {
+    if (C == ' ' || C == '#')
+      OS << '\\';
+    else if (C == '$')
+      OS << '$';
+    OS << C;
+  }
+}
+
+class ScanDependenciesToolAction : public ToolAction {
+  std::string &Dependencies;
+
+public:
+  explicit ScanDependenciesToolAction(std::string &Dependencies)
+      : Dependencies(Dependencies) {}
+
+  bool runInvocation(std::shared_ptr<CompilerInvocation> Invocation,
+                     FileManager *Files,
+                     std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+                     DiagnosticConsumer *DiagConsumer) override {
+    CompilerInstance Compiler(std::move(PCHContainerOps));
+    Compiler.setInvocation(std::move(Invocation));
+    Compiler.setFileManager(Files);
+    Compiler.createDiagnostics(DiagConsumer, /*ShouldOwnClient=*/false);
+    if (!Compiler.hasDiagnostics())
+      return false;
+    Compiler.createSourceManager(*Files);
+
+    // The dependencies are returned rather than written out.
+    DependencyOutputOptions &DepOpts = Compiler.getDependencyOutputOpts();
+    std::vector<std::string> Targets = std::move(DepOpts.Targets);
+    DepOpts.Targets.clear();
+    DepOpts.OutputFile.clear();
+    auto Collector =
+        std::make_shared<ScanDependencyCollector>(DepOpts.IncludeSystemHeaders);
+    Compiler.addDependencyCollector(Collector);
+
+    ScanDependenciesAction Action;
+    const bool Success = Compiler.ExecuteAction(Action);
+    Files->clearStatCaches();
+    if (!Success)
+      return false;
+
+    // The targets given with -MT are already quoted by the driver.
+    llvm::raw_string_ostream OS(Dependencies);
+    for (unsigned I = 0, E = Targets.size(); I != E; ++I)
+      OS << (I ? " " : "") << Targets[I];
+    if (Targets.empty()) {
+      const FrontendOptions &Opts = Compiler.getFrontendOpts();
+      if (!Opts.OutputFile.empty() && Opts.OutputFile != "-") {
+        printMakefileName(OS, Opts.OutputFile);
+      } else if (!Opts.Inputs.empty() && Opts.Inputs[0].isFile()) {
+        SmallString<128> Target(
+            llvm::sys::path::filename(Opts.Inputs[0].getFile()));
+        llvm::sys::path::replace_extension(Target, "o");
+        printMakefileName(OS, Target);
+      }
+    }
+    OS << ':';
+    for (const std::string &Dependency : Collector->getDependencies()) {
+      OS << " \\\n  ";
+      printMakefileName(OS, Dependency);
+    }
+    OS << '\n';
+    return true;
+  }
+};
+
+} // end anonymous namespace
+
+DependencyScanningTool::DependencyScanningTool(
+    std::shared_ptr<DependencyScanningCache> Cache,
+    IntrusiveRefCntPtr<vfs::FileSystem> FS)
+    : FS(new DependencyScanningFileSystem(std::move(Cache), std::move(FS))) {}
+
+bool DependencyScanningTool::computeDependencies(
+    const std::vector<std::string> &CommandLine, StringRef WorkingDirectory,
+    std::string &Dependencies, DiagnosticConsumer *DiagConsumer) {
+  Dependencies.clear();
+  if (FS->setCurrentWorkingDirectory(WorkingDirectory))
+    return false;
+
+  // A new file manager per scan, as it caches the files relative to the
+  // working directory. The minimized files are cached by the file system.
+  llvm::IntrusiveRefCntPtr<FileManager> Files(
+      new FileManager(FileSystemOptions(), FS));
+  ScanDependenciesToolAction Action(Dependencies);
+  ToolInvocation Invocation(CommandLine, &Action, Files.get(),
+                            std::make_shared<PCHContainerOperations>());
+  Invocation.setDiagnosticConsumer(DiagConsumer);
+  return Invocation.run();
+}
@@ -19,8 +19,12 @@
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Rewrite/Core/Rewriter.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_os_ostream.h"
+#include <algorithm>
+#include <thread>
 
 namespace clang {
 namespace tooling {
@@ -100,5 +104,109 @@ bool formatAndApplyAllReplacements(
   return Result;
 }
 
+/// \brief Apply \p Replaces to the file at \p FilePath, formatting them with
+/// \p Style first if it is non-empty, and atomically replace the file with
+/// the result.
+static llvm::Error applyAndSaveFile(vfs::FileSystem &FS, StringRef FilePath,
+                                    const Replacements &Replaces,
+                                    StringRef Style) {
+  auto Buffer = FS.getBufferForFile(FilePath);
+  if (!Buffer)
+    return llvm::make_error<llvm::StringError>(
+        "unable to read " + FilePath + ": " + Buffer.getError().message(),
+        Buffer.getError());
+  StringRef Code = (*Buffer)->getBuffer();
+
+  const Replacements *ToApply = &Replaces;
+  Replacements Formatted;
+  if (!Style.empty()) {
+    auto CurStyle = format::getStyle(Style, FilePath, "LLVM", Code, &FS);
+    if (!CurStyle)
+      return CurStyle.takeError();
+    auto NewReplacements =
+        format::formatReplacements(Code, Replaces, *CurStyle);
+    if (!NewReplacements)
+      return NewReplacements.takeError();
+    Formatted = std::move(*NewReplacements);
+    ToApply = &Formatted;
+  }
+
+  auto NewCode = applyAllReplacements(Code, *ToApply);
+  if (!NewCode)
+    return NewCode.takeError();
+
+  // Write the new contents next to the file and move them into place, so
+  // that a failure never leaves a half-written file behind.
+  SmallString<128> TempPath(FilePath);
+  TempPath += "-%%%%%%%%";
+  int FD;
+  if (std::error_code EC =
+          llvm::sys::fs::createUniqueFile(TempPath, FD, TempPath))
+    return llvm::make_error<llvm::StringError>(
+        "unable to make temporary file " + TempPath.str() + ": " + EC.message(), EC);
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << *NewCode;
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return llvm::make_error<llvm::StringError>(
+          "unable to write " + TempPath.str(), llvm::inconvertibleErrorCode());
+    }
+  }
+  if (std::error_code EC = llvm::sys::fs::rename(TempPath, FilePath)) {
+    llvm::sys::fs::remove(TempPath);
+    return llvm::make_error<llvm::StringError>(
+        "unable to rename " + TempPath.str() + " to " + FilePath + ": " +
+            EC.message(),
+        EC);
+  }
+  return llvm::Error::success();
+}
+
+bool applyAllReplacementsAndSave(
+    const std::map<std::string, Replacements> &FileToReplaces,
+    FileManager &Files, StringRef Style, unsigned NumThreads) {
+  std::map<std::string, Replacements> Grouped =
+      groupReplacementsByFile(Files, FileToReplaces);
+  IntrusiveRefCntPtr<vfs::FileSystem> FS = Files.getVirtualFileSystem();
+
+  std::vector<const std::pair<const std::string, Replacements> *> Work;
+  for (const auto &FileAndReplaces : Grouped)
+    if (!FileAndReplaces.second.empty())
+      Work.push_back(&FileAndReplaces);
+  if (Work.empty())
+    return true;
+
+  if (NumThreads == 0)
+    NumThreads = std::max(1U, std::thread::hardware_concurrency());
+  NumThreads = std::min<size_t>(NumThreads, Work.size());
+
+  // Errors are collected per file and reported in a deterministic order once
+  // all files have been processed.
+  std::vector<std::string> Errors(Work.size());
+  {
+    llvm::ThreadPool Pool(NumThreads);
+    for (unsigned I = 0, E = Work.size(); I != E; ++I) {
+      Pool.async([&, I] {
+        if (llvm::Error Err = applyAndSaveFile(*FS, Work[I]->first,
+                                               Work[I]->second, Style))
+          Errors[I] = llvm::toString(std::move(Err));
+      });
+    }
+    Pool.wait();
+  }
+
+  bool Result = true;
+  for (const std::string &Error : Errors) {
+    if (Error.empty())
+      continue;
+    llvm::errs() << Error << "\n";
+    Result = false;
+  }
+  return Result;
+}
+
 } // end namespace tooling
 } // end namespace clang
@@ -0,0 +1,15 @@
+// REQUIRES: x86-registered-target
+// RUN: not %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj %s \
+// RUN:   -o %t.0.o -parallel-codegen-output %t.1.o 2>&1 | FileCheck %s
+
+// Diagnostics raised while generating code for a partition are reported
+// through the frontend, at their location in the source, and fail the
+// compilation.
+
+int f(int X) {
+  // CHECK: parallel-codegen-diagnostics.c:[[@LINE+1]]:{{[0-9]+}}: error: invalid instruction mnemonic 'abc'
+  __asm__ ("abc incl    %0" : "+r" (X));
+  return X;
+}
+
+int g(int X) { return X + 1; }
@@ -0,0 +1,22 @@
+// REQUIRES: x86-registered-target
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -S -O1 %s -o %t.0.s \
+// RUN:   -parallel-codegen-output %t.1.s
+// RUN: cat %t.0.s %t.1.s | FileCheck %s
+// RUN: cat %t.0.s %t.1.s | FileCheck -check-prefix=LOCAL %s
+// RUN: FileCheck -check-prefix=PART %s < %t.0.s
+// RUN: FileCheck -check-prefix=PART %s < %t.1.s
+
+// Every function is emitted in exactly one of the partitions, and static
+// functions stay local.
+// CHECK-DAG: {{^}}f:
+// CHECK-DAG: {{^}}g:
+// CHECK-DAG: {{^}}h:
+// LOCAL-NOT: .globl{{.*}}helper
+
+// Both partitions received some of the code.
+// PART: {{^[fgh]:}}
+
+__attribute__((noinline)) static int helper(int x) { return x * 3; }
+int f(int x) { return helper(x) + 1; }
+int g(int x) { return x - 1; }
+int h(int x) { return helper(x) * 2; }
@@ -0,0 +1,27 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm -debug-info-kind=limited -debug-omit-unreferenced-methods %s -o %t.ll
+// RUN: FileCheck %s < %t.ll
+// RUN: FileCheck -check-prefix=OMIT %s < %t.ll
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm -debug-info-kind=limited %s -o - | FileCheck -check-prefix=ALL %s
+// CodeView expects the full method list.
+// RUN: %clang_cc1 -triple x86_64-pc-windows-msvc -emit-llvm -debug-info-kind=standalone -gcodeview -debug-omit-unreferenced-methods %s -o - | FileCheck -check-prefix=ALL %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm-only -debug-info-kind=limited -debug-omit-unreferenced-methods -print-stats %s 2>&1 | FileCheck -check-prefix=STATS %s
+
+struct S {
+  virtual void virt();
+  void defined();
+  void unused();
+};
+
+void S::virt() {}
+void S::defined() {}
+
+// Virtual methods are always described, and methods defined in this TU are
+// described when their definition is emitted.
+// CHECK-DAG: !DISubprogram(name: "virt", linkageName: "_ZN1S4virtEv", {{.*}}isDefinition: false
+// CHECK-DAG: !DISubprogram(name: "defined", linkageName: "_ZN1S7definedEv", {{.*}}isDefinition: false
+
+// OMIT-NOT: name: "unused"
+// ALL: !DISubprogram(name: "unused"
+
+// STATS: *** Debug Info Stats:
+// STATS: 1 unreferenced methods omitted
@@ -209,6 +209,25 @@
 // RUN: diff %t.tgt1 %t.res.tgt1
 // RUN: diff %t.tgt2 %t.res.tgt2
 
+// Check that device bundles can be extracted without the host bundle.
+// RUN: clang-offload-bundler -type=bc -targets=openmp-x86_64-pc-linux-gnu -outputs=%t.res.tgt2 -inputs=%t.bundle3.bc -unbundle
+// RUN: diff %t.tgt2 %t.res.tgt2
+// RUN: not clang-offload-bundler -type=bc -targets=host-powerpc64le-ibm-linux-gnu,host-powerpc64le-ibm-linux-gnu -outputs=%t.res.bc,%t.res.tgt1 -inputs=%t.bundle3.bc -unbundle 2>&1 \
+// RUN: | FileCheck %s --check-prefix CK-ERR-UNBUNDLE-HOSTS
+// CK-ERR-UNBUNDLE-HOSTS: error: expecting at most one host target but got 2.
+
+// Check bundles large enough to be copied directly between files.
+// RUN: echo 'Content of a large device file' > %t.large
+// RUN: cat %t.large %t.large %t.large %t.large %t.large %t.large %t.large %t.large > %t.large8
+// RUN: cat %t.large8 %t.large8 %t.large8 %t.large8 %t.large8 %t.large8 %t.large8 %t.large8 > %t.large64
+// RUN: cat %t.large64 %t.large64 %t.large64 %t.large64 %t.large64 %t.large64 %t.large64 %t.large64 > %t.large512
+// RUN: cat %t.large512 %t.large512 %t.large512 %t.large512 %t.large512 %t.large512 %t.large512 %t.large512 > %t.large4096
+// RUN: clang-offload-bundler -type=bc -targets=host-powerpc64le-ibm-linux-gnu,openmp-powerpc64le-ibm-linux-gnu,openmp-x86_64-pc-linux-gnu -inputs=%t.bc,%t.large4096,%t.tgt2 -outputs=%t.bundle.large.bc
+// RUN: clang-offload-bundler -type=bc -targets=host-powerpc64le-ibm-linux-gnu,openmp-powerpc64le-ibm-linux-gnu,openmp-x86_64-pc-linux-gnu -outputs=%t.res.bc,%t.res.large,%t.res.tgt2 -inputs=%t.bundle.large.bc -unbundle
+// RUN: diff %t.bc %t.res.bc
+// RUN: diff %t.large4096 %t.res.large
+// RUN: diff %t.tgt2 %t.res.tgt2
+
 // Check if we can unbundle a file with no magic strings.
 // RUN: clang-offload-bundler -type=bc -targets=host-powerpc64le-ibm-linux-gnu,openmp-powerpc64le-ibm-linux-gnu,openmp-x86_64-pc-linux-gnu -outputs=%t.res.bc,%t.res.tgt1,%t.res.tgt2 -inputs=%t.bc -unbundle
 // RUN: diff %t.bc %t.res.bc
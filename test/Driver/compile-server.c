@@ -0,0 +1,9 @@
+// RUN: %clang -### -fcompile-server=%t.sock -c %s 2>&1 | FileCheck %s
+// CHECK: "-cc1"
+// CHECK-NOT: "-fcompile-server
+
+// Without a server listening, jobs are run by the driver.
+// RUN: rm -f %t.sock
+// RUN: %clang -fcompile-server=%t.sock -c %s -o %t.o
+
+int f(void) { return 0; }
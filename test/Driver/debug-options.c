@@ -220,3 +220,13 @@
 // RUN: %clang -###                  %s 2>&1 | FileCheck -check-prefix=NOMACRO %s
 // MACRO: "-debug-info-macro"
 // NOMACRO-NOT: "-debug-info-macro"
+
+// RUN: %clang -### -c -g -gomit-unreferenced-methods %s 2>&1 \
+// RUN:        | FileCheck -check-prefix=OMITMETHODS %s
+// RUN: %clang -### -c -g -gomit-unreferenced-methods -gno-omit-unreferenced-methods %s 2>&1 \
+// RUN:        | FileCheck -check-prefix=NOOMITMETHODS %s
+// RUN: %clang -### -c -gline-tables-only -gomit-unreferenced-methods %s 2>&1 \
+// RUN:        | FileCheck -check-prefix=NOOMITMETHODS %s
+//
+// OMITMETHODS: "-debug-omit-unreferenced-methods"
+// NOOMITMETHODS-NOT: "-debug-omit-unreferenced-methods"
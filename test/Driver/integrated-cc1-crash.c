@@ -0,0 +1,9 @@
+// A crash of the in-process -cc1 job leaves no temporary or output files.
+// RUN: rm -rf %t && mkdir %t
+// RUN: not %clang -fintegrated-cc1 -fno-crash-diagnostics -c %s \
+// RUN:   -o %t/crash.o -MD -MF %t/crash.d
+// RUN: ls %t | count 0
+
+// REQUIRES: crash-recovery
+
+#pragma clang __debug crash
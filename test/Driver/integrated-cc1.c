@@ -0,0 +1,24 @@
+// RUN: %clang -### -fintegrated-cc1 -c %s 2>&1 | FileCheck %s
+// CHECK: (in-process)
+// CHECK-NEXT: "-cc1"
+// CHECK-NOT: "-fintegrated-cc1"
+
+// RUN: %clang -### -fintegrated-cc1 -fno-integrated-cc1 -c %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=NO %s
+// NO-NOT: (in-process)
+// NO: "-cc1"
+// NO-NOT: "-fno-integrated-cc1"
+
+// Several -cc1 jobs are all spawned.
+// RUN: %clang -### -fintegrated-cc1 -fsyntax-only %s %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=MULTI %s
+// MULTI-NOT: (in-process)
+// MULTI: "-cc1"
+// MULTI-NOT: (in-process)
+// MULTI: "-cc1"
+// MULTI-NOT: (in-process)
+
+// RUN: %clang -fintegrated-cc1 -c %s -o %t.o
+// RUN: %clang -fintegrated-cc1 -fsyntax-only %s %s
+
+int f(void) { return 0; }
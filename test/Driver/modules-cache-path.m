@@ -3,3 +3,6 @@
 
 // RUN: %clang -fmodules -### %s 2>&1 | FileCheck %s -check-prefix=CHECK-DEFAULT
 // CHECK-DEFAULT: -fmodules-cache-path={{.*}}org.llvm.clang.{{[A-Za-z0-9_]*[/\\]+}}ModuleCache
+
+// RUN: %clang -fmodules -fmodules-content-store -### %s 2>&1 | FileCheck %s -check-prefix=CHECK-CONTENT-STORE
+// CHECK-CONTENT-STORE: "-fmodules-content-store"
@@ -33,6 +33,12 @@
 // RUN: %clang -fmodules-validate-system-headers -### %s 2>&1 | FileCheck -check-prefix=MODULES_VALIDATE_SYSTEM_HEADERS %s
 // MODULES_VALIDATE_SYSTEM_HEADERS: -fmodules-validate-system-headers
 
+// RUN: %clang -### %s 2>&1 | FileCheck -check-prefix=VALIDATE_INPUT_FILES_CONTENT_DEFAULT %s
+// VALIDATE_INPUT_FILES_CONTENT_DEFAULT-NOT: -fvalidate-ast-input-files-content
+
+// RUN: %clang -fvalidate-ast-input-files-content -### %s 2>&1 | FileCheck -check-prefix=VALIDATE_INPUT_FILES_CONTENT %s
+// VALIDATE_INPUT_FILES_CONTENT: -fvalidate-ast-input-files-content
+
 // RUN: %clang -### %s 2>&1 | FileCheck -check-prefix=MODULES_DISABLE_DIAGNOSTIC_VALIDATION_DEFAULT %s
 // MODULES_DISABLE_DIAGNOSTIC_VALIDATION_DEFAULT-NOT: -fmodules-disable-diagnostic-validation
 
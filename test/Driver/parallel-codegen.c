@@ -0,0 +1,32 @@
+// RUN: %clang -### -target x86_64-unknown-linux-gnu -fparallel-codegen=3 \
+// RUN:   -c %s -o %t.o 2>&1 | FileCheck %s
+// CHECK: "-cc1"
+// CHECK-SAME: "-o" "[[P0:[^"]*parallel-codegen[^"]*\.o]]"
+// CHECK-SAME: "-parallel-codegen-output" "[[P1:[^"]*parallel-codegen[^"]*\.o]]"
+// CHECK-SAME: "-parallel-codegen-output" "[[P2:[^"]*parallel-codegen[^"]*\.o]]"
+// CHECK-NOT: "-fparallel-codegen
+// CHECK: "-r" "-m" "elf_x86_64" "-o" "{{.*}}.o" "[[P0]]" "[[P1]]" "[[P2]]"
+
+// The partial link uses the emulation of the target, not the host default.
+// RUN: %clang -### -target x86_64-unknown-linux-gnu -m32 -fparallel-codegen=2 \
+// RUN:   -c %s -o %t.o 2>&1 | FileCheck -check-prefix=M32 %s
+// M32: "-cc1" "-triple" "i386-unknown-linux-gnu"
+// M32: "-r" "-m" "elf_i386" "-o"
+
+// A single partition, or an output other than an object, is compiled as usual.
+// RUN: %clang -### -target x86_64-unknown-linux-gnu -fparallel-codegen=1 \
+// RUN:   -c %s 2>&1 | FileCheck -check-prefix=SERIAL %s
+// RUN: %clang -### -target x86_64-unknown-linux-gnu -fparallel-codegen=4 \
+// RUN:   -S %s 2>&1 | FileCheck -check-prefix=SERIAL %s
+// SERIAL-NOT: "-parallel-codegen-output"
+// SERIAL-NOT: "-r"
+
+// RUN: %clang -### -target x86_64-unknown-linux-gnu -fparallel-codegen=0 \
+// RUN:   -c %s 2>&1 | FileCheck -check-prefix=INVALID %s
+// INVALID: error: invalid integral value '0' in '-fparallel-codegen=0'
+
+// RUN: %clang -### -target x86_64-apple-darwin -fparallel-codegen=2 \
+// RUN:   -c %s 2>&1 | FileCheck -check-prefix=UNSUPPORTED %s
+// UNSUPPORTED: error: unsupported option '-fparallel-codegen=2' for target
+
+int f(void) { return 0; }
@@ -0,0 +1,39 @@
+// RUN: %clang -### -E -fparallel-preprocess=4 %s %S/Inputs/wildcard1.c 2>&1 \
+// RUN:   | FileCheck %s
+// CHECK: "-cc1"
+// CHECK-SAME: "-E"
+// CHECK-SAME: "-batch-preprocess=4"
+// CHECK-SAME: "-batch-output" "-" "-batch-output" "-"
+// CHECK-SAME: "{{[^"]*}}parallel-preprocess.c" "{{[^"]*}}wildcard1.c"
+// CHECK-NOT: "-cc1"
+
+// Each output file is passed along with its input.
+// RUN: %clang -### -save-temps=obj -fparallel-preprocess=2 -c \
+// RUN:   %s %S/Inputs/wildcard1.c 2>&1 \
+// RUN:   | FileCheck -check-prefix=SAVE-TEMPS %s
+// SAVE-TEMPS: "-cc1"
+// SAVE-TEMPS-SAME: "-batch-output" "{{[^"]*}}parallel-preprocess.i"
+// SAVE-TEMPS-SAME: "-batch-output" "{{[^"]*}}wildcard1.i"
+
+// A job that is not merged with others keeps its -o.
+// RUN: %clang -### -save-temps -fparallel-preprocess=4 -c %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=SINGLE %s
+// RUN: %clang -### -E -fparallel-preprocess=4 -MD %s %S/Inputs/wildcard1.c \
+// RUN:   2>&1 | FileCheck -check-prefix=SINGLE %s
+// SINGLE-NOT: "-batch-preprocess
+// SINGLE-NOT: "-batch-output"
+
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %clang -save-temps=obj -fparallel-preprocess=4 -c %s -o %t/single.o
+// RUN: FileCheck -check-prefix=SAVED %s < %t/single.i
+// SAVED: int f(void) { return 0; }
+
+// RUN: %clang -### -E -fparallel-preprocess=1 %s %S/Inputs/wildcard1.c 2>&1 \
+// RUN:   | FileCheck -check-prefix=SERIAL %s
+// SERIAL-NOT: "-batch-preprocess
+
+// RUN: %clang -### -E -fparallel-preprocess=x %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=INVALID %s
+// INVALID: error: invalid integral value 'x' in '-fparallel-preprocess=x'
+
+int f(void) { return 0; }
@@ -0,0 +1,7 @@
+// RUN: %clang -### -x c++-header %s -o %t.pch -fpch-instantiate-templates 2>&1 | FileCheck %s
+// CHECK: "-emit-pch"
+// CHECK-SAME: "-fpch-instantiate-templates"
+
+// RUN: %clang -### -x c++-header %s -o %t.pch -fpch-instantiate-templates -fno-pch-instantiate-templates 2>&1 | FileCheck %s -check-prefix=NO
+// RUN: %clang -### -x c++-header %s -o %t.pch 2>&1 | FileCheck %s -check-prefix=NO
+// NO-NOT: "-fpch-instantiate-templates"
@@ -0,0 +1,21 @@
+// RUN: c-index-test core -print-source-symbols -- %s -std=c++14 -target x86_64-apple-macosx10.7 | FileCheck %s
+
+// The USR of a context is reused as the prefix of the USRs of its members,
+// except where it contains type substitutions that the members refer to.
+
+namespace ns {
+// CHECK: [[@LINE+1]]:8 | struct/C++ | A | c:@N@ns@S@A | <no-cgname> | Def,RelChild |
+struct A {
+  // CHECK: [[@LINE+1]]:8 | instance-method/C++ | f | c:@N@ns@S@A@F@f# | __ZN2ns1A1fEv | Decl,RelChild |
+  void f();
+  // CHECK: [[@LINE+1]]:8 | instance-method/C++ | g | c:@N@ns@S@A@F@g# | __ZN2ns1A1gEv | Decl,RelChild |
+  void g();
+};
+}
+
+template <typename T> struct S {};
+// CHECK: [[@LINE+1]]:30 | {{.*}} | S | [[S_USR:c:@SP>1#T@S>#\*t0.0]] |
+template <typename T> struct S<T *> {
+  // CHECK: [[@LINE+1]]:8 | {{.*}} | h | [[S_USR]]@F@h#{{[^|]+}} |
+  void h(T *);
+};
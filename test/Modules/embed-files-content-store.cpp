@@ -0,0 +1,34 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: echo 'module a { header "a.h" header "x.h" } module b { header "b.h" }' > %t/modulemap
+// RUN: echo 'extern int t;' > %t/t.h
+// RUN: echo '#include "t.h"' > %t/a.h
+// RUN: echo '#include "t.h"' > %t/b.h
+// RUN: echo '#include "t.h"' > %t/x.h
+
+// RUN: %clang_cc1 -fmodules -I%t -fmodules-cache-path=%t/cache -fmodule-map-file=%t/modulemap -fmodules-embed-all-files -fmodules-content-store %s -verify
+// RUN: ls %t/cache/content | FileCheck %s -check-prefix=CHECK-STORE
+// CHECK-STORE: {{[0-9a-f]+}}
+
+// REQUIRES: shell
+
+// A damaged or missing store file makes the modules that refer to it out of
+// date, so they are rebuilt and the store is repaired.
+// RUN: for f in %t/cache/content/*; do sed -e 's/[a-z]/z/' $f > $f.tmp && mv $f.tmp $f; done
+// RUN: %clang_cc1 -fmodules -I%t -fmodules-cache-path=%t/cache -fmodule-map-file=%t/modulemap -fmodules-embed-all-files -fmodules-content-store %s -verify
+// RUN: not grep -r -e znclude -e zxtern %t/cache/content
+// RUN: rm %t/cache/content/*
+// RUN: %clang_cc1 -fmodules -I%t -fmodules-cache-path=%t/cache -fmodule-map-file=%t/modulemap -fmodules-embed-all-files -fmodules-content-store %s -verify
+// RUN: ls %t/cache/content | FileCheck %s -check-prefix=CHECK-STORE
+
+// The embedded contents are read back from the store, so the modules remain
+// usable once the original headers are gone.
+// RUN: rm %t/x.h
+// RUN: %clang_cc1 -fmodules -I%t -fmodules-cache-path=%t/cache -fmodule-map-file=%t/modulemap -fmodules-embed-all-files -fmodules-content-store %s -verify
+#include "a.h"
+char t; // expected-error {{different type}}
+// expected-note@t.h:1 {{here}}
+#include "t.h"
+#include "b.h"
+char t; // expected-error {{different type}}
+// expected-note@t.h:1 {{here}}
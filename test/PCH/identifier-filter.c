@@ -0,0 +1,25 @@
+// Identifiers that aren't in the PCH are ruled out by its identifier filter
+// without probing its identifier table; the ones that are are still found.
+
+// RUN: %clang_cc1 -emit-pch -o %t %s
+// RUN: %clang_cc1 -include-pch %t -fsyntax-only -verify -print-stats %s 2>&1 | FileCheck %s
+
+#ifndef HEADER
+#define HEADER
+
+int from_pch;
+#define MACRO_FROM_PCH 1
+
+#else
+
+// expected-no-diagnostics
+
+int f(void) {
+  int not_in_pch_a = 0, not_in_pch_b = 0, not_in_pch_c = 0, not_in_pch_d = 0;
+  return from_pch + MACRO_FROM_PCH + not_in_pch_a + not_in_pch_b +
+         not_in_pch_c + not_in_pch_d;
+}
+
+// CHECK: identifier table lookups skipped by filters
+
+#endif
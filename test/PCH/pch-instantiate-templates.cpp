@@ -0,0 +1,37 @@
+// Without -fpch-instantiate-templates, the instantiation is left to the user
+// of the PCH; with it, it is performed while building the PCH.
+// RUN: %clang_cc1 -triple %itanium_abi_triple -x c++-header -emit-pch -o %t %s
+// RUN: %clang_cc1 -triple %itanium_abi_triple -include-pch %t %s -emit-llvm -o - | FileCheck %s
+// RUN: %clang_cc1 -triple %itanium_abi_triple -x c++-header -emit-pch -fpch-instantiate-templates -o %t.inst %s
+// RUN: %clang_cc1 -triple %itanium_abi_triple -include-pch %t.inst %s -emit-llvm -o - | FileCheck %s
+
+// Errors in the instantiation show up when building the PCH only if the
+// instantiation is performed there.
+// RUN: %clang_cc1 -triple %itanium_abi_triple -x c++-header -emit-pch -o %t.bad %s -DBAD
+// RUN: not %clang_cc1 -triple %itanium_abi_triple -x c++-header -emit-pch -fpch-instantiate-templates -o %t.bad %s -DBAD 2>&1 | FileCheck %s -check-prefix=BAD
+
+#ifndef HEADER
+#define HEADER
+
+struct S {
+  static const int value = 1;
+};
+
+template <typename T> int get() { return T::value; }
+
+inline int use_in_header() { return get<S>(); }
+
+#ifdef BAD
+// BAD: error: no member named 'missing' in 'S'
+template <typename T> void bad() { T::missing(); }
+
+inline void use_bad() { bad<S>(); }
+#endif
+
+#else
+
+int use() { return get<S>(); }
+
+// CHECK: define linkonce_odr {{.*}}i32 @_Z3getI1SEiv()
+
+#endif
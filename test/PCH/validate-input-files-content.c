@@ -0,0 +1,24 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo '#include "b.h"' > %t/a.h
+// RUN: echo 'int b = 1;' > %t/b.h
+// RUN: %clang_cc1 -x c-header %t/a.h -emit-pch -o %t/a.pch \
+// RUN:   -fvalidate-ast-input-files-content
+
+// A header whose modification time changed is up to date if its contents
+// didn't change.
+// RUN: touch -m -t 200001010000 %t/b.h
+// RUN: %clang_cc1 %s -include-pch %t/a.pch -fsyntax-only -verify \
+// RUN:   -fvalidate-ast-input-files-content
+// RUN: not %clang_cc1 %s -include-pch %t/a.pch -fsyntax-only 2>&1 \
+// RUN:   | FileCheck %s
+
+// Its contents are compared even if its size is the same.
+// RUN: echo 'int b = 2;' > %t/b.h
+// RUN: not %clang_cc1 %s -include-pch %t/a.pch -fsyntax-only \
+// RUN:   -fvalidate-ast-input-files-content 2>&1 | FileCheck %s
+
+// CHECK: fatal error: file {{.*}}b.h' has been modified since the precompiled header {{.*}} was built
+
+// expected-no-diagnostics
+int use = b;
+// REQUIRES: shell
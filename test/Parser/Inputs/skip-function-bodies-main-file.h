@@ -0,0 +1,7 @@
+inline void header_body() {
+  undeclared_in_header();
+}
+
+struct HeaderStruct {
+  void header_method() { undeclared_in_header_method(); }
+};
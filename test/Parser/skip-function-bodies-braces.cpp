@@ -0,0 +1,78 @@
+// Trigraphs are enabled in -std=c++14 but not in -std=gnu++14.
+// RUN: %clang_cc1 -fsyntax-only -std=c++14 -skip-function-bodies -Wno-trigraphs -DTRIGRAPHS -verify %s
+// RUN: %clang_cc1 -fsyntax-only -std=gnu++14 -skip-function-bodies -verify %s
+// expected-no-diagnostics
+
+// Each skipped body is followed by a declaration that is checked below, to
+// make sure that skipping stopped at the right closing brace.
+
+#define OPEN {
+#define CLOSE }
+
+void literals() {
+  const char *S = "}}";
+  const char *E = "\"}";
+  char C = '}';
+  char Q = '\'';
+  int N = 1'000'000;
+  const char *R = R"x(})x";
+}
+int after_literals;
+
+void comments() {
+  // }
+  /* } */
+  /*/ } */
+  // \
+  }
+}
+int after_comments;
+
+void digraphs() <%
+  int A<:1:>;
+%>
+int after_digraphs;
+
+#ifdef TRIGRAPHS
+void trigraphs() ??<
+  int A??(1??);
+??>
+
+void trigraph_escapes() {
+  const char *S = "??/"}";
+  int I = '??/'' + '}';
+  // A line comment continued by a trigraph ??/
+  }
+}
+#endif
+int after_trigraphs;
+
+void macros() {
+  if (true) OPEN
+  CLOSE
+}
+int after_macros;
+
+void directives() {
+#if 0
+  }
+#endif
+}
+int after_directives;
+
+void nested() {
+  { { } }
+  [] { return; }();
+}
+int after_nested;
+
+struct S {
+  void inline_method() { const char *S = "}"; }
+  int member;
+};
+
+static_assert(sizeof(after_literals) + sizeof(after_comments) +
+                  sizeof(after_digraphs) + sizeof(after_trigraphs) +
+                  sizeof(after_macros) + sizeof(after_directives) +
+                  sizeof(after_nested) == 7 * sizeof(int), "");
+static_assert(sizeof(S) == sizeof(int), "");
@@ -0,0 +1,17 @@
+// RUN: %clang_cc1 -fsyntax-only -std=c89 -skip-function-bodies -verify %s
+// expected-no-diagnostics
+
+// C89 has no line comments, yet "//" still starts one unless followed by '*'.
+
+void line_comment(void) {
+  int X = 1; // }
+}
+int after_line_comment;
+
+void divide(void) {
+  int Y = 4 //**/ 2
+  ;
+}
+int after_divide;
+
+int *check[] = { &after_line_comment, &after_divide };
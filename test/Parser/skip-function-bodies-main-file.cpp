@@ -0,0 +1,24 @@
+// RUN: %clang_cc1 -fsyntax-only -skip-function-bodies -keep-main-file-function-bodies -I %S/Inputs -verify %s
+// RUN: %clang_cc1 -fsyntax-only -skip-function-bodies -keep-main-file-function-bodies -keep-function-body-lines=21:21 -I %S/Inputs -verify -DLINES %s
+// RUN: not %clang_cc1 -fsyntax-only -keep-function-body-lines=2:1 %s 2>&1 | FileCheck -check-prefix=INVALID %s
+
+// Bodies in headers are skipped, so the errors in their bodies are not
+// diagnosed.
+#include "skip-function-bodies-main-file.h"
+
+void outside_lines() {
+#ifndef LINES
+  undeclared_a(); // expected-error {{use of undeclared identifier 'undeclared_a'}}
+#endif
+}
+
+struct S {
+  void inline_method() {
+#ifndef LINES
+    undeclared_b(); // expected-error {{use of undeclared identifier 'undeclared_b'}}
+#endif
+  }
+  void within_lines() { undeclared_c(); } // expected-error {{use of undeclared identifier 'undeclared_c'}}
+};
+
+// INVALID: error: invalid value '2:1' in '-keep-function-body-lines=2:1'
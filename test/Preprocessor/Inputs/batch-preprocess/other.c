@@ -0,0 +1,3 @@
+#include "shared.h"
+int other = SHARED_VALUE + 1;
+#warning other input
@@ -0,0 +1,2 @@
+#define SHARED_VALUE 42
+int shared_decl;
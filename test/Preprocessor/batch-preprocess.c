@@ -0,0 +1,37 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %clang_cc1 -E -batch-preprocess=2 -I %S/Inputs/batch-preprocess \
+// RUN:   -batch-output %t/main.i -batch-output %t/other.i \
+// RUN:   %s %S/Inputs/batch-preprocess/other.c 2>&1 \
+// RUN:   | FileCheck -check-prefix=DIAGS %s
+// RUN: FileCheck -check-prefix=MAIN %s < %t/main.i
+// RUN: FileCheck -check-prefix=OTHER %s < %t/other.i
+
+// A single input without -batch-output is written to its -o file.
+// RUN: %clang_cc1 -E -batch-preprocess=2 -I %S/Inputs/batch-preprocess \
+// RUN:   %s -o %t/single.i
+// RUN: FileCheck -check-prefix=MAIN %s < %t/single.i
+
+// Outputs to standard output are emitted in input order.
+// RUN: %clang_cc1 -E -batch-preprocess=0 -I %S/Inputs/batch-preprocess \
+// RUN:   %s %S/Inputs/batch-preprocess/other.c 2>/dev/null \
+// RUN:   | FileCheck -check-prefix=STDOUT %s
+
+// RUN: not %clang_cc1 -fsyntax-only -batch-preprocess=2 %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=NOT-E %s
+// NOT-E: error: invalid argument '-batch-preprocess=2' only allowed with '-E'
+
+#include "shared.h"
+int main_value = SHARED_VALUE;
+
+// DIAGS: other.c:3:2: warning: other input
+// DIAGS: 1 warning generated.
+
+// MAIN: int shared_decl;
+// MAIN: int main_value = 42;
+// MAIN-NOT: other
+
+// OTHER: int shared_decl;
+// OTHER: int other = 42 + 1;
+
+// STDOUT: int main_value = 42;
+// STDOUT: int other = 42 + 1;
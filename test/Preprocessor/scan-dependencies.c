@@ -0,0 +1,23 @@
+// RUN: %clang_cc1 -scan-dependencies -I %S/Inputs/scan-dependencies \
+// RUN:   -dependency-file %t.d -MT out.o %s
+// RUN: FileCheck %s < %t.d
+
+// Only the directives are preprocessed, so the code in between, which would
+// not compile, is ignored. The macros still select what is included.
+
+// CHECK: out.o:
+// CHECK-NEXT: scan-dependencies.c
+// CHECK-NEXT: a.h
+// CHECK-NEXT: b.h
+// CHECK-NOT: not-included.h
+
+#include "a.h"
+#include "a.h"
+#if USE_B
+#include "b.h"
+#else
+#include "not-included.h"
+#endif
+#include "b.h"
+
+this is not C;
@@ -70,13 +70,14 @@ static cl::opt<std::string>
 
 static void printSymbolInfo(SymbolInfo SymInfo, raw_ostream &OS);
 static void printSymbolNameAndUSR(const Decl *D, ASTContext &Ctx,
-                                  raw_ostream &OS);
+                                  USRCache &USRs, raw_ostream &OS);
 
 namespace {
 
 class PrintIndexDataConsumer : public IndexDataConsumer {
   raw_ostream &OS;
   std::unique_ptr<CodegenNameGenerator> CGNameGen;
+  USRCache USRs;
 
 public:
   PrintIndexDataConsumer(raw_ostream &OS) : OS(OS) {
@@ -84,6 +85,7 @@ public:
 
   void initialize(ASTContext &Ctx) override {
     CGNameGen.reset(new CodegenNameGenerator(Ctx));
+    USRs.clear();
   }
 
   bool handleDeclOccurence(const Decl *D, SymbolRoleSet Roles,
@@ -100,7 +102,7 @@ public:
     printSymbolInfo(getSymbolInfo(D), OS);
     OS << " | ";
 
-    printSymbolNameAndUSR(D, Ctx, OS);
+    printSymbolNameAndUSR(D, Ctx, USRs, OS);
     OS << " | ";
 
     if (CGNameGen->writeName(D, OS))
@@ -116,7 +118,7 @@ public:
       OS << '\t';
       printSymbolRoles(SymRel.Roles, OS);
       OS << " | ";
-      printSymbolNameAndUSR(SymRel.RelatedSymbol, Ctx, OS);
+      printSymbolNameAndUSR(SymRel.RelatedSymbol, Ctx, USRs, OS);
       OS << '\n';
     }
 
@@ -252,14 +254,14 @@ static void printSymbolInfo(SymbolInfo SymInfo, raw_ostream &OS) {
 }
 
 static void printSymbolNameAndUSR(const Decl *D, ASTContext &Ctx,
-                                  raw_ostream &OS) {
+                                  USRCache &USRs, raw_ostream &OS) {
   if (printSymbolName(D, Ctx.getLangOpts(), OS)) {
     OS << "<no-name>";
   }
   OS << " | ";
 
   SmallString<256> USRBuf;
-  if (generateUSRForDecl(D, USRBuf)) {
+  if (USRs.generateUSRForDecl(D, USRBuf)) {
     OS << "<no-usr>";
   } else {
     OS << USRBuf;
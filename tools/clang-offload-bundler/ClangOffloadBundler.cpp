@@ -42,12 +42,18 @@
 #include "llvm/Support/Signals.h"
 #include <algorithm>
 #include <cassert>
+#include <cerrno>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
 #include <system_error>
 #include <vector>
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 using namespace llvm;
 using namespace llvm::object;
@@ -130,6 +136,93 @@ static bool hasHostKind(StringRef Target) {
   return OffloadKind == "host";
 }
 
+/// Ranges of input files smaller than this are copied through the stream
+/// buffer rather than with a system call.
+static const uint64_t MinDirectCopySize = 64 * 1024;
+
+/// Output stream for bundled and unbundled files, which can copy ranges of the
+/// (memory mapped) input files to the output without reading them into this
+/// process.
+class BundleOutputStream final : public raw_fd_ostream {
+  /// The file descriptor written by the stream.
+  int FD;
+
+  BundleOutputStream(int FD)
+      : raw_fd_ostream(FD, /*shouldClose=*/true), FD(FD) {}
+
+  /// Copy as much as possible of \a Data, a range of the file contents \a
+  /// Input, to the output within the kernel. Return the number of bytes
+  /// copied.
+  uint64_t copyFileRange(MemoryBuffer &Input, StringRef Data) {
+#if defined(__linux__)
+    // Standard input is not necessarily a regular file.
+    if (Input.getBufferIdentifier() == "<stdin>")
+      return 0;
+
+    int InputFD;
+    if (sys::fs::openFileForRead(Input.getBufferIdentifier(), InputFD))
+      return 0;
+
+    // Everything written so far must reach the file first.
+    flush();
+
+    off_t Offset = Data.data() - Input.getBufferStart();
+    uint64_t Copied = 0;
+    bool UseCopyFileRange = true;
+    while (Copied != Data.size()) {
+      size_t Remaining = Data.size() - Copied;
+      ssize_t N = -1;
+#ifdef SYS_copy_file_range
+      // copy_file_range can share the data between the files (e.g., reflinks),
+      // but is not supported by all kernels and file systems.
+      if (UseCopyFileRange) {
+        N = syscall(SYS_copy_file_range, InputFD, &Offset, FD, nullptr,
+                    Remaining, 0u);
+        if (N <= 0 && errno != EINTR) {
+          UseCopyFileRange = false;
+          continue;
+        }
+      } else
+#endif
+        N = ::sendfile(FD, InputFD, &Offset, Remaining);
+      if (N < 0 && errno == EINTR)
+        continue;
+      if (N <= 0)
+        break;
+      Copied += N;
+    }
+    (void)UseCopyFileRange;
+    ::close(InputFD);
+    return Copied;
+#else
+    return 0;
+#endif
+  }
+
+public:
+  /// Create the output file \a Path.
+  static std::unique_ptr<BundleOutputStream> create(StringRef Path,
+                                                    std::error_code &EC) {
+    int FD;
+    EC = sys::fs::openFileForWrite(Path, FD, sys::fs::F_None);
+    if (EC)
+      return nullptr;
+    return std::unique_ptr<BundleOutputStream>(new BundleOutputStream(FD));
+  }
+
+  /// Write \a Data, a range of the file contents \a Input, to the stream.
+  /// Large ranges are copied from the input file by the kernel when possible,
+  /// so that their pages are never touched by this process.
+  void writeFileData(MemoryBuffer &Input, StringRef Data) {
+    assert(Data.begin() >= Input.getBufferStart() &&
+           Data.end() <= Input.getBufferEnd() && "Data is not in the input!");
+    uint64_t Copied = 0;
+    if (Data.size() >= MinDirectCopySize)
+      Copied = copyFileRange(Input, Data);
+    write(Data.data() + Copied, Data.size() - Copied);
+  }
+};
+
 /// Generic file handler interface.
 class FileHandler {
 public:
@@ -150,24 +243,26 @@ public:
   virtual void ReadBundleEnd(MemoryBuffer &Input) = 0;
 
   /// Read the current bundle and write the result into the stream \a OS.
-  virtual void ReadBundle(raw_fd_ostream &OS, MemoryBuffer &Input) = 0;
+  virtual void ReadBundle(BundleOutputStream &OS, MemoryBuffer &Input) = 0;
 
   /// Write the header of the bundled file to \a OS based on the information
   /// gathered from \a Inputs.
-  virtual void WriteHeader(raw_fd_ostream &OS,
+  virtual void WriteHeader(BundleOutputStream &OS,
                            ArrayRef<std::unique_ptr<MemoryBuffer>> Inputs) = 0;
 
   /// Write the marker that initiates a bundle for the triple \a TargetTriple to
   /// \a OS.
-  virtual void WriteBundleStart(raw_fd_ostream &OS, StringRef TargetTriple) = 0;
+  virtual void WriteBundleStart(BundleOutputStream &OS,
+                                StringRef TargetTriple) = 0;
 
   /// Write the marker that closes a bundle for the triple \a TargetTriple to \a
   /// OS. Return true if any error was found.
 
-  virtual bool WriteBundleEnd(raw_fd_ostream &OS, StringRef TargetTriple) = 0;
+  virtual bool WriteBundleEnd(BundleOutputStream &OS,
+                              StringRef TargetTriple) = 0;
 
   /// Write the bundle from \a Input into \a OS.
-  virtual void WriteBundle(raw_fd_ostream &OS, MemoryBuffer &Input) = 0;
+  virtual void WriteBundle(BundleOutputStream &OS, MemoryBuffer &Input) = 0;
 };
 
 /// Handler for binary files. The bundled file will have the following format
@@ -207,7 +302,7 @@ static uint64_t Read8byteIntegerFromBuffer(StringRef Buffer, size_t pos) {
 }
 
 /// Write 8-byte integers to a buffer in little-endian format.
-static void Write8byteIntegerToBuffer(raw_fd_ostream &OS, uint64_t Val) {
+static void Write8byteIntegerToBuffer(BundleOutputStream &OS, uint64_t Val) {
   for (unsigned i = 0; i < 8; ++i) {
     char Char = (char)(Val & 0xffu);
     OS.write(&Char, 1);
@@ -316,14 +411,14 @@ public:
     ++CurBundleInfo;
   }
 
-  void ReadBundle(raw_fd_ostream &OS, MemoryBuffer &Input) final {
+  void ReadBundle(BundleOutputStream &OS, MemoryBuffer &Input) final {
     assert(CurBundleInfo != BundlesInfo.end() && "Invalid reader info!");
     StringRef FC = Input.getBuffer();
-    OS.write(FC.data() + CurBundleInfo->second.Offset,
-             CurBundleInfo->second.Size);
+    OS.writeFileData(Input, FC.substr(CurBundleInfo->second.Offset,
+                                      CurBundleInfo->second.Size));
   }
 
-  void WriteHeader(raw_fd_ostream &OS,
+  void WriteHeader(BundleOutputStream &OS,
                    ArrayRef<std::unique_ptr<MemoryBuffer>> Inputs) final {
     // Compute size of the header.
     uint64_t HeaderSize = 0;
@@ -356,14 +451,14 @@ public:
     }
   }
 
-  void WriteBundleStart(raw_fd_ostream &OS, StringRef TargetTriple) final {}
+  void WriteBundleStart(BundleOutputStream &OS, StringRef TargetTriple) final {}
 
-  bool WriteBundleEnd(raw_fd_ostream &OS, StringRef TargetTriple) final {
+  bool WriteBundleEnd(BundleOutputStream &OS, StringRef TargetTriple) final {
     return false;
   }
 
-  void WriteBundle(raw_fd_ostream &OS, MemoryBuffer &Input) final {
-    OS.write(Input.getBufferStart(), Input.getBufferSize());
+  void WriteBundle(BundleOutputStream &OS, MemoryBuffer &Input) final {
+    OS.writeFileData(Input, Input.getBuffer());
   }
 };
 
@@ -455,7 +550,7 @@ public:
 
   void ReadBundleEnd(MemoryBuffer &Input) final {}
 
-  void ReadBundle(raw_fd_ostream &OS, MemoryBuffer &Input) final {
+  void ReadBundle(BundleOutputStream &OS, MemoryBuffer &Input) final {
     // If the current section has size one, that means that the content we are
     // interested in is the file itself. Otherwise it is the content of the
     // section.
@@ -467,12 +562,12 @@ public:
     CurrentSection->getContents(Content);
 
     if (Content.size() < 2)
-      OS.write(Input.getBufferStart(), Input.getBufferSize());
+      OS.writeFileData(Input, Input.getBuffer());
     else
-      OS.write(Content.data(), Content.size());
+      OS.writeFileData(Input, Content);
   }
 
-  void WriteHeader(raw_fd_ostream &OS,
+  void WriteHeader(BundleOutputStream &OS,
                    ArrayRef<std::unique_ptr<MemoryBuffer>> Inputs) final {
     assert(HostInputIndex != ~0u && "Host input index not defined.");
 
@@ -485,7 +580,7 @@ public:
     AuxModule.reset(M);
   }
 
-  void WriteBundleStart(raw_fd_ostream &OS, StringRef TargetTriple) final {
+  void WriteBundleStart(BundleOutputStream &OS, StringRef TargetTriple) final {
     ++NumberOfProcessedInputs;
 
     // Record the triple we are using, that will be used to name the section we
@@ -493,7 +588,7 @@ public:
     CurrentTriple = TargetTriple;
   }
 
-  bool WriteBundleEnd(raw_fd_ostream &OS, StringRef TargetTriple) final {
+  bool WriteBundleEnd(BundleOutputStream &OS, StringRef TargetTriple) final {
     assert(NumberOfProcessedInputs <= NumberOfInputs &&
            "Processing more inputs that actually exist!");
     assert(HostInputIndex != ~0u && "Host input index not defined.");
@@ -580,7 +675,7 @@ public:
     return false;
   }
 
-  void WriteBundle(raw_fd_ostream &OS, MemoryBuffer &Input) final {
+  void WriteBundle(BundleOutputStream &OS, MemoryBuffer &Input) final {
     Module *M = AuxModule.get();
 
     // Create the new section name, it will consist of the reserved prefix
@@ -671,7 +766,7 @@ protected:
     ++ReadChars;
   }
 
-  void ReadBundle(raw_fd_ostream &OS, MemoryBuffer &Input) final {
+  void ReadBundle(BundleOutputStream &OS, MemoryBuffer &Input) final {
     StringRef FC = Input.getBuffer();
     size_t BundleStart = ReadChars;
 
@@ -682,19 +777,19 @@ protected:
     OS << Bundle;
   }
 
-  void WriteHeader(raw_fd_ostream &OS,
+  void WriteHeader(BundleOutputStream &OS,
                    ArrayRef<std::unique_ptr<MemoryBuffer>> Inputs) final {}
 
-  void WriteBundleStart(raw_fd_ostream &OS, StringRef TargetTriple) final {
+  void WriteBundleStart(BundleOutputStream &OS, StringRef TargetTriple) final {
     OS << BundleStartString << TargetTriple << "\n";
   }
 
-  bool WriteBundleEnd(raw_fd_ostream &OS, StringRef TargetTriple) final {
+  bool WriteBundleEnd(BundleOutputStream &OS, StringRef TargetTriple) final {
     OS << BundleEndString << TargetTriple << "\n";
     return false;
   }
 
-  void WriteBundle(raw_fd_ostream &OS, MemoryBuffer &Input) final {
+  void WriteBundle(BundleOutputStream &OS, MemoryBuffer &Input) final {
     OS << Input.getBuffer();
   }
 
@@ -763,21 +858,25 @@ static bool BundleFiles() {
   std::error_code EC;
 
   // Create output file.
-  raw_fd_ostream OutputFile(OutputFileNames.front(), EC, sys::fs::F_None);
+  std::unique_ptr<BundleOutputStream> OutputFile =
+      BundleOutputStream::create(OutputFileNames.front(), EC);
 
   if (EC) {
     errs() << "error: Can't open file " << OutputFileNames.front() << ".\n";
     return true;
   }
 
-  // Open input files.
+  // Open input files. They are memory mapped, and need no null terminator
+  // since they may be binary files, so that only the parts that are used are
+  // read.
   std::vector<std::unique_ptr<MemoryBuffer>> InputBuffers(
       InputFileNames.size());
 
   unsigned Idx = 0;
   for (auto &I : InputFileNames) {
     ErrorOr<std::unique_ptr<MemoryBuffer>> CodeOrErr =
-        MemoryBuffer::getFileOrSTDIN(I);
+        MemoryBuffer::getFileOrSTDIN(I, /*FileSize=*/-1,
+                                     /*RequiresNullTerminator=*/false);
     if (std::error_code EC = CodeOrErr.getError()) {
       errs() << "error: Can't open file " << I << ": " << EC.message() << "\n";
       return true;
@@ -795,15 +894,15 @@ static bool BundleFiles() {
     return true;
 
   // Write header.
-  FH.get()->WriteHeader(OutputFile, InputBuffers);
+  FH.get()->WriteHeader(*OutputFile, InputBuffers);
 
   // Write all bundles along with the start/end markers. If an error was found
   // writing the end of the bundle component, abort the bundle writing.
   auto Input = InputBuffers.begin();
   for (auto &Triple : TargetNames) {
-    FH.get()->WriteBundleStart(OutputFile, Triple);
-    FH.get()->WriteBundle(OutputFile, *Input->get());
-    if (FH.get()->WriteBundleEnd(OutputFile, Triple))
+    FH.get()->WriteBundleStart(*OutputFile, Triple);
+    FH.get()->WriteBundle(*OutputFile, *Input->get());
+    if (FH.get()->WriteBundleEnd(*OutputFile, Triple))
       return true;
     ++Input;
   }
@@ -812,9 +911,10 @@ static bool BundleFiles() {
 
 // Unbundle the files. Return true if an error was found.
 static bool UnbundleFiles() {
-  // Open Input file.
+  // Open Input file. Bundles that are not requested are not read.
   ErrorOr<std::unique_ptr<MemoryBuffer>> CodeOrErr =
-      MemoryBuffer::getFileOrSTDIN(InputFileNames.front());
+      MemoryBuffer::getFileOrSTDIN(InputFileNames.front(), /*FileSize=*/-1,
+                                   /*RequiresNullTerminator=*/false);
   if (std::error_code EC = CodeOrErr.getError()) {
     errs() << "error: Can't open file " << InputFileNames.front() << ": "
            << EC.message() << "\n";
@@ -861,13 +961,14 @@ static bool UnbundleFiles() {
 
     // Check if the output file can be opened and copy the bundle to it.
     std::error_code EC;
-    raw_fd_ostream OutputFile(Output->second, EC, sys::fs::F_None);
+    std::unique_ptr<BundleOutputStream> OutputFile =
+        BundleOutputStream::create(Output->second, EC);
     if (EC) {
       errs() << "error: Can't open file " << Output->second << ": "
              << EC.message() << "\n";
       return true;
     }
-    FH.get()->ReadBundle(OutputFile, Input);
+    FH.get()->ReadBundle(*OutputFile, Input);
     FH.get()->ReadBundleEnd(Input);
     Worklist.erase(Output);
 
@@ -881,7 +982,8 @@ static bool UnbundleFiles() {
   if (Worklist.size() == TargetNames.size()) {
     for (auto &E : Worklist) {
       std::error_code EC;
-      raw_fd_ostream OutputFile(E.second, EC, sys::fs::F_None);
+      std::unique_ptr<BundleOutputStream> OutputFile =
+          BundleOutputStream::create(E.second, EC);
       if (EC) {
         errs() << "error: Can't open file " << E.second << ": " << EC.message()
                << "\n";
@@ -890,13 +992,14 @@ static bool UnbundleFiles() {
 
       // If this entry has a host kind, copy the input file to the output file.
       if (hasHostKind(E.first()))
-        OutputFile.write(Input.getBufferStart(), Input.getBufferSize());
+        OutputFile->writeFileData(Input, Input.getBuffer());
     }
     return false;
   }
 
-  // If we found elements, we emit an error if none of those were for the host.
-  if (!FoundHostBundle) {
+  // If we found elements, we emit an error if none of those were for the host,
+  // unless only device bundles were requested.
+  if (!FoundHostBundle && HostInputIndex != ~0u) {
     errs() << "error: Can't find bundle for the host target\n";
     return true;
   }
@@ -904,7 +1007,8 @@ static bool UnbundleFiles() {
   // If we still have any elements in the worklist, create empty files for them.
   for (auto &E : Worklist) {
     std::error_code EC;
-    raw_fd_ostream OutputFile(E.second, EC, sys::fs::F_None);
+    std::unique_ptr<BundleOutputStream> OutputFile =
+        BundleOutputStream::create(E.second, EC);
     if (EC) {
       errs() << "error: Can't open file " << E.second << ": "  << EC.message()
              << "\n";
@@ -959,7 +1063,8 @@ int main(int argc, const char **argv) {
   }
 
   // Verify that the offload kinds and triples are known. We also check that we
-  // have exactly one host target.
+  // have exactly one host target, or at most one when unbundling, so that
+  // device bundles can be extracted on their own.
   unsigned Index = 0u;
   unsigned HostTargetNum = 0u;
   for (StringRef Target : TargetNames) {
@@ -998,10 +1103,10 @@ int main(int argc, const char **argv) {
     ++Index;
   }
 
-  if (HostTargetNum != 1) {
+  if (Unbundle ? HostTargetNum > 1 : HostTargetNum != 1) {
     Error = true;
-    errs() << "error: expecting exactly one host target but got "
-           << HostTargetNum << ".\n";
+    errs() << "error: expecting " << (Unbundle ? "at most" : "exactly")
+           << " one host target but got " << HostTargetNum << ".\n";
   }
 
   if (Error)
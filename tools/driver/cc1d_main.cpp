@@ -0,0 +1,60 @@
+//===-- cc1d_main.cpp - Clang CC1 Compile Server --------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This is the entry point to the clang -cc1d functionality, which runs a
+// persistent compile server for -cc1 jobs sent by 'clang -fcompile-server'.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Driver/CompileServer.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#include <string>
+
+using namespace clang;
+using namespace clang::driver;
+
+extern int cc1_main(ArrayRef<const char *> Argv, const char *Argv0,
+                    void *MainAddr);
+
+int cc1d_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
+  if (Argv.size() != 1) {
+    llvm::errs() << "usage: " << Argv0 << " -cc1d <socket>\n";
+    return 1;
+  }
+
+  // Do the work shared by all jobs once, before forking them: everything that
+  // was initialized when the server started (loading the executable, static
+  // constructors, registering passes) is inherited by each job, which starts
+  // at cc1_main.
+  llvm::InitializeAllTargets();
+  llvm::InitializeAllTargetMCs();
+  llvm::InitializeAllAsmPrinters();
+  llvm::InitializeAllAsmParsers();
+
+  std::string ErrMsg;
+  bool Success = compile_server::serve(
+      Argv[0],
+      [&](ArrayRef<const char *> JobArgv) {
+        // Only -cc1 jobs are sent to the server.
+        if (JobArgv.size() < 2 || StringRef(JobArgv[1]) != "-cc1") {
+          llvm::errs() << "error: compile server can only run -cc1 jobs\n";
+          return 1;
+        }
+        return cc1_main(JobArgv.slice(2), Argv0, MainAddr);
+      },
+      /*MaxJobs=*/0, &ErrMsg);
+  if (!Success) {
+    llvm::errs() << "error: compile server: " << ErrMsg << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -80,6 +80,7 @@ CXTranslationUnit cxtu::MakeCXTranslationUnit(CIndexer *CIdx,
   D->Diagnostics = nullptr;
   D->OverridenCursorsPool = createOverridenCXCursorsPool();
   D->CommentToXML = nullptr;
+  CIdx->registerTranslationUnit(D);
   return D;
 }
 
@@ -3251,7 +3252,7 @@ enum CXErrorCode clang_createTranslationUnit2(CXIndex CIdx,
       CXXIdx->getOnlyLocalDecls(), None,
       /*CaptureDiagnostics=*/true,
       /*AllowPCHWithCompilerErrors=*/true,
-      /*UserFilesAreVolatile=*/true);
+      /*UserFilesAreVolatile=*/true, CXXIdx->getSourceBufferPool());
   *out_TU = MakeCXTranslationUnit(CXXIdx, std::move(AU));
   return *out_TU ? CXError_Success : CXError_Failure;
 }
@@ -3305,6 +3306,8 @@ clang_parseTranslationUnit_Impl(CXIndex CIdx, const char *source_filename,
   bool IncludeBriefCommentsInCodeCompletion
     = options & CXTranslationUnit_IncludeBriefCommentsInCodeCompletion;
   bool SkipFunctionBodies = options & CXTranslationUnit_SkipFunctionBodies;
+  bool KeepMainFileFunctionBodies =
+      options & CXTranslationUnit_KeepMainFileFunctionBodies;
   bool ForSerialization = options & CXTranslationUnit_ForSerialization;
 
   // Configure the diagnostics.
@@ -3387,9 +3390,10 @@ clang_parseTranslationUnit_Impl(CXIndex CIdx, const char *source_filename,
       /*RemappedFilesKeepOriginalName=*/true, PrecompilePreambleAfterNParses,
       TUKind, CacheCodeCompletionResults, IncludeBriefCommentsInCodeCompletion,
       /*AllowPCHWithCompilerErrors=*/true, SkipFunctionBodies,
-      /*UserFilesAreVolatile=*/true, ForSerialization,
+      KeepMainFileFunctionBodies, /*UserFilesAreVolatile=*/true,
+      ForSerialization,
       CXXIdx->getPCHContainerOperations()->getRawReader().getFormat(),
-      &ErrUnit));
+      &ErrUnit, CXXIdx->getSourceBufferPool()));
 
   // Early failures in LoadFromCommandLine may return with ErrUnit unset.
   if (!Unit && !ErrUnit)
@@ -3899,6 +3903,9 @@ int clang_saveTranslationUnit(CXTranslationUnit TU, const char *FileName,
 
 void clang_disposeTranslationUnit(CXTranslationUnit CTUnit) {
   if (CTUnit) {
+    if (CTUnit->CIdx)
+      CTUnit->CIdx->unregisterTranslationUnit(CTUnit);
+
     // If the translation unit has been marked as unsafe to free, just discard
     // it.
     ASTUnit *Unit = cxtu::getASTUnit(CTUnit);
@@ -3935,6 +3942,7 @@ clang_reparseTranslationUnit_Impl(CXTranslationUnit TU,
   CIndexer *CXXIdx = TU->CIdx;
   if (CXXIdx->isOptEnabled(CXGlobalOpt_ThreadBackgroundPriorityForEditing))
     setThreadBackgroundPriority();
+  CXXIdx->markTranslationUnitUsed(TU);
 
   ASTUnit *CXXUnit = cxtu::getASTUnit(TU);
   ASTUnit::ConcurrencyCheck Check(*CXXUnit);
@@ -7748,19 +7756,21 @@ const char *clang_getTUResourceUsageName(CXTUResourceUsageKind kind) {
     case CXTUResourceUsage_Preprocessor_HeaderSearch:
       str = "Preprocessor: header search tables";
       break;
+    case CXTUResourceUsage_Sema:
+      str = "Sema: allocator and side tables";
+      break;
+    case CXTUResourceUsage_Preamble:
+      str = "ASTUnit: precompiled preamble bookkeeping";
+      break;
+    case CXTUResourceUsage_ExternalASTSource_DataStructures:
+      str = "ExternalASTSource: data structures and tables";
+      break;
   }
   return str;
 }
 
-CXTUResourceUsage clang_getCXTUResourceUsage(CXTranslationUnit TU) {
-  if (isNotUsableTU(TU)) {
-    LOG_BAD_TU(TU);
-    CXTUResourceUsage usage = { (void*) nullptr, 0, nullptr };
-    return usage;
-  }
-  
-  ASTUnit *astUnit = cxtu::getASTUnit(TU);
-  std::unique_ptr<MemUsageEntries> entries(new MemUsageEntries());
+static void getResourceUsageEntries(ASTUnit *astUnit,
+                                    MemUsageEntries *entries) {
   ASTContext &astContext = astUnit->getASTContext();
   
   // How much memory is used by AST nodes and types?
@@ -7820,6 +7830,9 @@ CXTUResourceUsage clang_getCXTUResourceUsage(CXTranslationUnit TU) {
     createCXTUResourceUsageEntry(*entries,
       CXTUResourceUsage_ExternalASTSource_Membuffer_MMap,
                                  (unsigned long) sizes.mmap_bytes);
+    createCXTUResourceUsageEntry(*entries,
+      CXTUResourceUsage_ExternalASTSource_DataStructures,
+                                 (unsigned long) esrc->getDataStructureSizes());
   }
   
   // How much memory is being used by the Preprocessor?
@@ -7838,6 +7851,40 @@ CXTUResourceUsage clang_getCXTUResourceUsage(CXTranslationUnit TU) {
                                CXTUResourceUsage_Preprocessor_HeaderSearch,
                                pp.getHeaderSearchInfo().getTotalMemory());
 
+  // How much memory is being used by Sema?
+  if (astUnit->hasSema())
+    createCXTUResourceUsageEntry(*entries, CXTUResourceUsage_Sema,
+                                 astUnit->getSema().getTotalMemory());
+
+  // How much memory is being used to keep the precompiled preamble around?
+  createCXTUResourceUsageEntry(*entries, CXTUResourceUsage_Preamble,
+                               astUnit->getPreambleMemory());
+}
+
+/// \brief Sum up the entries of a translation unit that are measured in
+/// bytes.
+static unsigned long long getTotalMemoryUsage(ASTUnit *astUnit) {
+  MemUsageEntries entries;
+  getResourceUsageEntries(astUnit, &entries);
+
+  unsigned long long total = 0;
+  for (const CXTUResourceUsageEntry &entry : entries)
+    if (entry.kind >= CXTUResourceUsage_MEMORY_IN_BYTES_BEGIN &&
+        entry.kind <= CXTUResourceUsage_MEMORY_IN_BYTES_END)
+      total += entry.amount;
+  return total;
+}
+
+CXTUResourceUsage clang_getCXTUResourceUsage(CXTranslationUnit TU) {
+  if (isNotUsableTU(TU)) {
+    LOG_BAD_TU(TU);
+    CXTUResourceUsage usage = { (void*) nullptr, 0, nullptr };
+    return usage;
+  }
+
+  std::unique_ptr<MemUsageEntries> entries(new MemUsageEntries());
+  getResourceUsageEntries(cxtu::getASTUnit(TU), entries.get());
+
   CXTUResourceUsage usage = { (void*) entries.get(),
                             (unsigned) entries->size(),
                             !entries->empty() ? &(*entries)[0] : nullptr };
@@ -7850,6 +7897,75 @@ void clang_disposeCXTUResourceUsage(CXTUResourceUsage usage) {
     delete (MemUsageEntries*) usage.data;
 }
 
+unsigned long long clang_getTranslationUnitMemoryUsage(CXTranslationUnit TU) {
+  if (isNotUsableTU(TU)) {
+    LOG_BAD_TU(TU);
+    return 0;
+  }
+
+  return getTotalMemoryUsage(cxtu::getASTUnit(TU));
+}
+
+void clang_CXIndex_setMemoryBudget(CXIndex CIdx, unsigned long long budget) {
+  if (CIdx)
+    static_cast<CIndexer *>(CIdx)->setMemoryBudget(budget);
+}
+
+unsigned long long clang_CXIndex_getMemoryBudget(CXIndex CIdx) {
+  if (CIdx)
+    return static_cast<CIndexer *>(CIdx)->getMemoryBudget();
+  return 0;
+}
+
+unsigned clang_CXIndex_enforceMemoryBudget(CXIndex CIdx,
+                                           CXTranslationUnitEvictor evictor,
+                                           CXClientData client_data) {
+  if (!CIdx)
+    return 0;
+
+  CIndexer *CXXIdx = static_cast<CIndexer *>(CIdx);
+  unsigned long long budget = CXXIdx->getMemoryBudget();
+  if (!budget)
+    return 0;
+
+  // Translation units that crashed are in an inconsistent state; leave them
+  // alone.
+  std::vector<CXTranslationUnit> TUs;
+  for (CXTranslationUnit TU : CXXIdx->getTranslationUnitsByRecency())
+    if (!cxtu::getASTUnit(TU)->isUnsafeToFree())
+      TUs.push_back(TU);
+
+  std::vector<unsigned long long> usage;
+  unsigned long long total = 0;
+  for (CXTranslationUnit TU : TUs) {
+    usage.push_back(getTotalMemoryUsage(cxtu::getASTUnit(TU)));
+    total += usage.back();
+  }
+
+  // First, drop the caches that will be recomputed on the next reparse,
+  // starting with the least recently used translation unit.
+  for (unsigned I = 0, N = TUs.size(); I != N && total > budget; ++I) {
+    ASTUnit *CXXUnit = cxtu::getASTUnit(TUs[I]);
+    ASTUnit::ConcurrencyCheck Check(*CXXUnit);
+    unsigned long long released = std::min<unsigned long long>(
+        CXXUnit->releaseCachedCompletionResults(), usage[I]);
+    usage[I] -= released;
+    total -= released;
+  }
+
+  // Then let the client dispose of whole translation units.
+  unsigned numEvicted = 0;
+  for (unsigned I = 0, N = TUs.size(); I != N && total > budget && evictor;
+       ++I) {
+    if (evictor(TUs[I], usage[I], client_data)) {
+      total -= usage[I];
+      ++numEvicted;
+    }
+  }
+
+  return numEvicted;
+}
+
 CXSourceRangeList *clang_getSkippedRanges(CXTranslationUnit TU, CXFile file) {
   CXSourceRangeList *skipped = new CXSourceRangeList;
   skipped->count = 0;
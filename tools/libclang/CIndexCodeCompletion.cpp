@@ -668,6 +668,7 @@ clang_codeCompleteAt_Impl(CXTranslationUnit TU, const char *complete_filename,
   CIndexer *CXXIdx = TU->CIdx;
   if (CXXIdx->isOptEnabled(CXGlobalOpt_ThreadBackgroundPriorityForEditing))
     setThreadBackgroundPriority();
+  CXXIdx->markTranslationUnitUsed(TU);
 
   ASTUnit::ConcurrencyCheck Check(*AST);
 
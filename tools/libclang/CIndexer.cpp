@@ -16,8 +16,10 @@
 #include "clang/Basic/Version.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/MutexGuard.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
+#include <algorithm>
 #include <cstdio>
 
 #ifdef __CYGWIN__
@@ -76,3 +78,27 @@ const std::string &CIndexer::getClangResourcesPath() {
   ResourcesPath = LibClangPath.str();
   return ResourcesPath;
 }
+
+void CIndexer::registerTranslationUnit(CXTranslationUnit TU) {
+  llvm::MutexGuard Lock(TUsMutex);
+  TUsByRecency.push_back(TU);
+}
+
+void CIndexer::unregisterTranslationUnit(CXTranslationUnit TU) {
+  llvm::MutexGuard Lock(TUsMutex);
+  auto I = std::find(TUsByRecency.begin(), TUsByRecency.end(), TU);
+  if (I != TUsByRecency.end())
+    TUsByRecency.erase(I);
+}
+
+void CIndexer::markTranslationUnitUsed(CXTranslationUnit TU) {
+  llvm::MutexGuard Lock(TUsMutex);
+  auto I = std::find(TUsByRecency.begin(), TUsByRecency.end(), TU);
+  if (I != TUsByRecency.end())
+    std::rotate(I, std::next(I), TUsByRecency.end());
+}
+
+std::vector<CXTranslationUnit> CIndexer::getTranslationUnitsByRecency() const {
+  llvm::MutexGuard Lock(TUsMutex);
+  return TUsByRecency;
+}
@@ -16,9 +16,12 @@
 #define LLVM_CLANG_TOOLS_LIBCLANG_CINDEXER_H
 
 #include "clang-c/Index.h"
+#include "clang/Basic/SourceManager.h"
 #include "clang/Frontend/PCHContainerOperations.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Mutex.h"
 #include <utility>
+#include <vector>
 
 namespace llvm {
   class CrashRecoveryContext;
@@ -40,11 +43,24 @@ class CIndexer {
   std::string ResourcesPath;
   std::shared_ptr<PCHContainerOperations> PCHContainerOps;
 
+  /// \brief The pool through which the translation units created from this
+  /// index share the contents of system headers.
+  std::shared_ptr<SourceBufferPool> BufferPool;
+
+  /// \brief The memory budget for all translation units, or 0 if none.
+  unsigned long long MemoryBudget;
+
+  /// \brief The live translation units created from this index, least
+  /// recently used first.
+  std::vector<CXTranslationUnit> TUsByRecency;
+  mutable llvm::sys::Mutex TUsMutex;
+
 public:
   CIndexer(std::shared_ptr<PCHContainerOperations> PCHContainerOps =
                std::make_shared<PCHContainerOperations>())
       : OnlyLocalDecls(false), DisplayDiagnostics(false),
-        Options(CXGlobalOpt_None), PCHContainerOps(std::move(PCHContainerOps)) {
+        Options(CXGlobalOpt_None), PCHContainerOps(std::move(PCHContainerOps)),
+        BufferPool(std::make_shared<SourceBufferPool>()), MemoryBudget(0) {
   }
 
   /// \brief Whether we only want to see "local" declarations (that did not
@@ -62,6 +78,10 @@ public:
     return PCHContainerOps;
   }
 
+  std::shared_ptr<SourceBufferPool> getSourceBufferPool() const {
+    return BufferPool;
+  }
+
   unsigned getCXGlobalOptFlags() const { return Options; }
   void setCXGlobalOptFlags(unsigned options) { Options = options; }
 
@@ -71,6 +91,22 @@ public:
 
   /// \brief Get the path of the clang resource files.
   const std::string &getClangResourcesPath();
+
+  unsigned long long getMemoryBudget() const { return MemoryBudget; }
+  void setMemoryBudget(unsigned long long Budget) { MemoryBudget = Budget; }
+
+  /// \brief Start tracking a newly-created translation unit as the most
+  /// recently used one.
+  void registerTranslationUnit(CXTranslationUnit TU);
+
+  /// \brief Stop tracking a translation unit that is being disposed.
+  void unregisterTranslationUnit(CXTranslationUnit TU);
+
+  /// \brief Mark the given translation unit as the most recently used one.
+  void markTranslationUnitUsed(CXTranslationUnit TU);
+
+  /// \brief Retrieve the live translation units, least recently used first.
+  std::vector<CXTranslationUnit> getTranslationUnitsByRecency() const;
 };
 
   /// \brief Return the current size to request for "safety".
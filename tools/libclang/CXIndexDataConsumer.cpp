@@ -407,6 +407,7 @@ const char *ScratchAlloc::copyCStr(StringRef Str) {
 
 void CXIndexDataConsumer::setASTContext(ASTContext &ctx) {
   Ctx = &ctx;
+  USRs.clear();
   cxtu::getASTUnit(CXTU)->setASTContext(&ctx);
 }
 
@@ -1188,7 +1189,7 @@ void CXIndexDataConsumer::getEntityInfo(const NamedDecl *D,
 
   {
     SmallString<512> StrBuf;
-    bool Ignore = getDeclCursorUSR(D, StrBuf);
+    bool Ignore = USRs.generateUSRForDecl(D, StrBuf);
     if (Ignore) {
       EntityInfo.USR = nullptr;
     } else {
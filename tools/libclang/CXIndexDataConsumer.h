@@ -13,6 +13,7 @@
 #include "CXCursor.h"
 #include "Index_Internal.h"
 #include "clang/Index/IndexDataConsumer.h"
+#include "clang/Index/USRGeneration.h"
 #include "clang/AST/DeclGroup.h"
 #include "clang/AST/DeclObjC.h"
 #include "llvm/ADT/DenseSet.h"
@@ -292,6 +293,9 @@ class CXIndexDataConsumer : public index::IndexDataConsumer {
   typedef std::pair<const FileEntry *, const Decl *> RefFileOccurrence;
   llvm::DenseSet<RefFileOccurrence> RefFileOccurrences;
 
+  /// \brief The USRs of the entities reported so far.
+  index::USRCache USRs;
+
   llvm::BumpPtrAllocator StrScratch;
   unsigned StrAdapterCount;
   friend class ScratchAlloc;
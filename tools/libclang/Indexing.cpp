@@ -521,7 +521,8 @@ static CXErrorCode clang_indexSourceFile_Impl(
     CXXIdx->getPCHContainerOperations()->getRawReader().getFormat();
 
   auto Unit = ASTUnit::create(CInvok, Diags, CaptureDiagnostics,
-                              /*UserFilesAreVolatile=*/true);
+                              /*UserFilesAreVolatile=*/true,
+                              CXXIdx->getSourceBufferPool());
   if (!Unit)
     return CXError_InvalidArguments;
 
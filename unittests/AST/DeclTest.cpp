@@ -11,10 +11,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclContextInternals.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Frontend/ASTUnit.h"
 #include "clang/Tooling/Tooling.h"
 #include "gtest/gtest.h"
 
+using namespace clang;
 using namespace clang::ast_matchers;
 using namespace clang::tooling;
 
@@ -57,3 +61,36 @@ TEST(Decl, CleansUpAPValues) {
       "constexpr _Complex __uint128_t c = 0xffffffffffffffff;",
       Args));
 }
+
+TEST(Decl, LookupInLargeAndSmallContexts) {
+  std::string Code = "namespace big {\n";
+  for (unsigned I = 0; I != 500; ++I)
+    Code += "int v" + std::to_string(I) + ";\n";
+  Code += "void f(int); void f(double);\n"
+          "}\n"
+          "struct Small { int a; };\n";
+
+  std::unique_ptr<ASTUnit> AST = buildASTFromCode(Code);
+  ASSERT_TRUE(AST.get());
+  ASTContext &Ctx = AST->getASTContext();
+  auto Lookup = [&](const DeclContext *DC, StringRef Name) {
+    return DC->lookup(&Ctx.Idents.get(Name));
+  };
+
+  DeclContext *TU = Ctx.getTranslationUnitDecl();
+  ASSERT_EQ(1U, Lookup(TU, "big").size());
+  auto *Big = cast<NamespaceDecl>(Lookup(TU, "big").front());
+  for (unsigned I = 0; I != 500; ++I)
+    EXPECT_EQ(1U, Lookup(Big, "v" + std::to_string(I)).size());
+  EXPECT_EQ(2U, Lookup(Big, "f").size());
+  EXPECT_EQ(0U, Lookup(Big, "a").size());
+  ASSERT_TRUE(Big->getLookupPtr());
+  EXPECT_FALSE(Big->getLookupPtr()->usesInlineStorage());
+
+  ASSERT_EQ(1U, Lookup(TU, "Small").size());
+  auto *Small = cast<CXXRecordDecl>(Lookup(TU, "Small").front());
+  EXPECT_EQ(1U, Lookup(Small, "a").size());
+  EXPECT_EQ(0U, Lookup(Small, "v0").size());
+  ASSERT_TRUE(Small->getLookupPtr());
+  EXPECT_TRUE(Small->getLookupPtr()->usesInlineStorage());
+}
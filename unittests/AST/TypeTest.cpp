@@ -0,0 +1,83 @@
+//===- unittests/AST/TypeTest.cpp --- Type tests --------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Unit tests for Type nodes in the AST.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclTemplate.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Tooling/Tooling.h"
+#include "gtest/gtest.h"
+
+using namespace clang;
+using namespace clang::tooling;
+
+namespace {
+
+TEST(Type, UniquesFunctionProtoTypesWithCachedHashes) {
+  std::unique_ptr<ASTUnit> AST = buildASTFromCode("");
+  ASSERT_TRUE(AST.get());
+  ASTContext &Ctx = AST->getASTContext();
+
+  // Build enough types that the uniquing table has to grow several times.
+  FunctionProtoType::ExtProtoInfo EPI;
+  std::vector<QualType> Types;
+  QualType Param = Ctx.IntTy;
+  for (unsigned I = 0; I != 1000; ++I) {
+    Types.push_back(Ctx.getFunctionType(Ctx.VoidTy, {Param, Ctx.CharTy}, EPI));
+    Param = Ctx.getPointerType(Param);
+  }
+
+  Param = Ctx.IntTy;
+  for (unsigned I = 0; I != 1000; ++I) {
+    QualType T = Ctx.getFunctionType(Ctx.VoidTy, {Param, Ctx.CharTy}, EPI);
+    EXPECT_EQ(Types[I], T);
+
+    const auto *FPT = cast<FunctionProtoType>(T);
+    llvm::FoldingSetNodeID ID;
+    FPT->Profile(ID, Ctx);
+    EXPECT_EQ(ID.ComputeHash(), FPT->getProfileHash(Ctx));
+    Param = Ctx.getPointerType(Param);
+  }
+  EXPECT_NE(Types[0], Ctx.getFunctionType(Ctx.VoidTy, {Ctx.CharTy}, EPI));
+}
+
+TEST(Type, UniquesTemplateSpecializationTypesWithCachedHashes) {
+  std::unique_ptr<ASTUnit> AST =
+      buildASTFromCode("template <typename T, typename U> struct A;");
+  ASSERT_TRUE(AST.get());
+  ASTContext &Ctx = AST->getASTContext();
+  auto Found = Ctx.getTranslationUnitDecl()->lookup(&Ctx.Idents.get("A"));
+  ASSERT_EQ(1U, Found.size());
+  TemplateName Template(cast<ClassTemplateDecl>(Found.front()));
+
+  auto GetSpecialization = [&](unsigned Index) {
+    TemplateArgument Args[] = {
+        TemplateArgument(Ctx.getTemplateTypeParmType(0, Index, false)),
+        TemplateArgument(Ctx.IntTy)};
+    return Ctx.getCanonicalTemplateSpecializationType(Template, Args);
+  };
+
+  std::vector<QualType> Types;
+  for (unsigned I = 0; I != 500; ++I)
+    Types.push_back(GetSpecialization(I));
+  for (unsigned I = 0; I != 500; ++I) {
+    QualType T = GetSpecialization(I);
+    EXPECT_EQ(Types[I], T);
+
+    const auto *TST = cast<TemplateSpecializationType>(T);
+    llvm::FoldingSetNodeID ID;
+    TST->Profile(ID, Ctx);
+    EXPECT_EQ(ID.ComputeHash(), TST->getProfileHash(Ctx));
+  }
+}
+
+} // end anonymous namespace
@@ -0,0 +1,142 @@
+//===- unittests/Analysis/CloneDetectionTest.cpp - Clone detection tests --===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Analysis/CloneDetection.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+namespace clang {
+namespace analysis {
+namespace {
+
+const char *Clones = "void log();\n"
+                     "int max(int a, int b) {\n"
+                     "  log();\n"
+                     "  if (a > b)\n"
+                     "    return a;\n"
+                     "  return b;\n"
+                     "}\n"
+                     "int maxClone(int x, int y) {\n"
+                     "  log();\n"
+                     "  if (x > y)\n"
+                     "    return x;\n"
+                     "  return y;\n"
+                     "}\n"
+                     "int minClone(int x, int y) {\n"
+                     "  log();\n"
+                     "  if (x > y)\n"
+                     "    return y;\n"
+                     "  return x;\n"
+                     "}\n"
+                     "long maxLong(long a, long b) {\n"
+                     "  log();\n"
+                     "  if (a > b)\n"
+                     "    return a;\n"
+                     "  return b;\n"
+                     "}\n";
+
+std::unique_ptr<ASTUnit> analyze(StringRef Code, StringRef FileName,
+                                 CloneDetector &Detector) {
+  std::unique_ptr<ASTUnit> AST =
+      tooling::buildASTFromCodeWithArgs(Code, {"-std=c++11"}, FileName);
+  for (const Decl *D : AST->getASTContext().getTranslationUnitDecl()->decls()) {
+    const auto *FD = dyn_cast<FunctionDecl>(D);
+    if (FD && FD->doesThisDeclarationHaveABody())
+      Detector.analyzeCodeBody(FD);
+  }
+  return AST;
+}
+
+TEST(CloneDetector, ConcurrentSearchMatchesSerialSearch) {
+  CloneDetector Detector;
+  std::unique_ptr<ASTUnit> AST = analyze(Clones, "input.cc", Detector);
+
+  for (bool CheckPatterns : {true, false}) {
+    std::vector<CloneDetector::CloneGroup> Serial, Concurrent;
+    Detector.findClones(Serial, 10, CheckPatterns, /*NumThreads=*/1);
+    Detector.findClones(Concurrent, 10, CheckPatterns, /*NumThreads=*/4);
+
+    ASSERT_FALSE(Serial.empty());
+    ASSERT_EQ(Serial.size(), Concurrent.size());
+    for (unsigned i = 0; i < Serial.size(); ++i)
+      EXPECT_EQ(Serial[i].Sequences, Concurrent[i].Sequences);
+  }
+}
+
+TEST(CloneDetector, GroupsSignaturesAcrossTranslationUnits) {
+  const char *Max = "int max(int a, int b) {\n"
+                    "  if (a > b)\n"
+                    "    return a + 1;\n"
+                    "  return b - 1;\n"
+                    "}\n";
+  const char *MaxClone = "int other();\n"
+                         "int maxClone(int x, int y) {\n"
+                         "  if (x > y)\n"
+                         "    return x + 1;\n"
+                         "  return y - 1;\n"
+                         "}\n";
+
+  std::string SignaturesA, SignaturesB;
+  {
+    CloneDetector Detector;
+    std::unique_ptr<ASTUnit> AST = analyze(Max, "a.cc", Detector);
+    llvm::raw_string_ostream OS(SignaturesA);
+    Detector.writeSignatures(OS, 10);
+  }
+  {
+    CloneDetector Detector;
+    std::unique_ptr<ASTUnit> AST = analyze(MaxClone, "b.cc", Detector);
+    llvm::raw_string_ostream OS(SignaturesB);
+    Detector.writeSignatures(OS, 10);
+  }
+
+  std::vector<CloneDetector::SignatureRecord> Records;
+  ASSERT_TRUE(CloneDetector::readSignatures(SignaturesA, Records));
+  ASSERT_TRUE(CloneDetector::readSignatures(SignaturesB, Records));
+
+  std::vector<std::vector<CloneDetector::SignatureRecord>> Groups;
+  CloneDetector::groupSignatures(Records, 10, Groups);
+  ASSERT_EQ(1U, Groups.size());
+  ASSERT_EQ(2U, Groups[0].size());
+  EXPECT_TRUE(StringRef(Groups[0][0].File).endswith("a.cc"));
+  EXPECT_EQ(1U, Groups[0][0].StartLine);
+  EXPECT_EQ(5U, Groups[0][0].EndLine);
+  EXPECT_TRUE(StringRef(Groups[0][1].File).endswith("b.cc"));
+  EXPECT_EQ(2U, Groups[0][1].StartLine);
+  EXPECT_EQ(6U, Groups[0][1].EndLine);
+
+  // The same code seen by several translation units is not a clone.
+  Records.clear();
+  ASSERT_TRUE(CloneDetector::readSignatures(SignaturesA, Records));
+  ASSERT_TRUE(CloneDetector::readSignatures(SignaturesA, Records));
+  Groups.clear();
+  CloneDetector::groupSignatures(Records, 10, Groups);
+  EXPECT_TRUE(Groups.empty());
+}
+
+TEST(CloneDetector, RejectsMalformedSignatures) {
+  std::vector<CloneDetector::SignatureRecord> Records;
+  EXPECT_FALSE(CloneDetector::readSignatures("not a signature\n", Records));
+  EXPECT_FALSE(CloneDetector::readSignatures("ff 10 1:1 2:2\n", Records));
+  EXPECT_TRUE(Records.empty());
+
+  EXPECT_TRUE(CloneDetector::readSignatures("ff 10 1:1 2:2 a file.cc\n",
+                                            Records));
+  ASSERT_EQ(1U, Records.size());
+  EXPECT_EQ(0xffU, Records[0].Hash);
+  EXPECT_EQ("a file.cc", Records[0].File);
+}
+
+} // namespace
+} // namespace analysis
+} // namespace clang
@@ -21,6 +21,9 @@
 #include "clang/Lex/PreprocessorOptions.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 using namespace clang;
@@ -121,6 +124,44 @@ TEST_F(SourceManagerTest, isBeforeInTranslationUnit) {
   EXPECT_TRUE(SourceMgr.isBeforeInTranslationUnit(idLoc, macroExpEndLoc));
 }
 
+TEST_F(SourceManagerTest, getFileIDWithManyEntries) {
+  // Interleave files and macro expansions of different sizes, recording where
+  // each of them starts and how many offsets it covers.
+  std::vector<std::pair<SourceLocation, unsigned>> Entries;
+  for (unsigned I = 0; I != 500; ++I) {
+    if (I % 3 == 0) {
+      std::string Source(I % 17 + 1, 'x');
+      FileID FID = SourceMgr.createFileID(
+          llvm::MemoryBuffer::getMemBufferCopy(Source));
+      Entries.push_back(
+          std::make_pair(SourceMgr.getLocForStartOfFile(FID),
+                         unsigned(Source.size() + 1)));
+    } else {
+      SourceLocation Spelling = Entries.front().first;
+      unsigned TokLength = I % 5 + 1;
+      SourceLocation Loc = SourceMgr.createExpansionLoc(Spelling, Spelling,
+                                                        Spelling, TokLength);
+      Entries.push_back(std::make_pair(Loc, TokLength + 1));
+    }
+  }
+
+  // Visit the entries in a scattered order, so that most lookups miss the
+  // lookup caches, and alternate with lookups in the first file, which should
+  // stay cached.
+  for (unsigned Step = 0; Step != Entries.size(); ++Step) {
+    unsigned I = (Step * 211) % Entries.size();
+    for (unsigned Offs = 0; Offs != Entries[I].second; ++Offs) {
+      SourceLocation Loc = Entries[I].first.getLocWithOffset(Offs);
+      EXPECT_EQ(Entries[I].first.getOffset(),
+                SourceMgr.getSLocEntry(SourceMgr.getFileID(Loc)).getOffset());
+
+      SourceLocation First = Entries.front().first.getLocWithOffset(Offs % 2);
+      EXPECT_EQ(Entries.front().first.getOffset(),
+                SourceMgr.getSLocEntry(SourceMgr.getFileID(First)).getOffset());
+    }
+  }
+}
+
 TEST_F(SourceManagerTest, getColumnNumber) {
   const char *Source =
     "int x;\n"
@@ -171,6 +212,73 @@ TEST_F(SourceManagerTest, getColumnNumber) {
   EXPECT_EQ(1U, SourceMgr.getColumnNumber(MainFileID, 0, nullptr));
 }
 
+TEST_F(SourceManagerTest, sharesContentsThroughBufferPool) {
+  int FD;
+  SmallString<64> Path;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("pooled", "h", FD, Path));
+  llvm::FileRemover Remover(Path);
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << "int x;\nint y;\n";
+  }
+
+  auto Pool = std::make_shared<SourceBufferPool>();
+  SourceMgr.setBufferPool(Pool);
+  SourceManager OtherSourceMgr(Diags, FileMgr);
+  OtherSourceMgr.setBufferPool(Pool);
+
+  const FileEntry *File = FileMgr.getFile(Path);
+  ASSERT_TRUE(File);
+  FileID FID =
+      SourceMgr.createFileID(File, SourceLocation(), SrcMgr::C_System);
+  FileID OtherFID =
+      OtherSourceMgr.createFileID(File, SourceLocation(), SrcMgr::C_System);
+
+  bool Invalid = false;
+  StringRef Buffer = SourceMgr.getBufferData(FID, &Invalid);
+  ASSERT_FALSE(Invalid);
+  StringRef OtherBuffer = OtherSourceMgr.getBufferData(OtherFID, &Invalid);
+  ASSERT_FALSE(Invalid);
+  EXPECT_EQ(Buffer.data(), OtherBuffer.data());
+  EXPECT_EQ(1U, Pool->getNumFiles());
+
+  EXPECT_EQ(2U, SourceMgr.getLineNumber(FID, 7));
+  EXPECT_EQ(2U, OtherSourceMgr.getLineNumber(OtherFID, 7));
+  EXPECT_EQ(5U, OtherSourceMgr.getColumnNumber(OtherFID, 11));
+}
+
+TEST_F(SourceManagerTest, overridesPooledContents) {
+  int FD;
+  SmallString<64> Path;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("pooled", "h", FD, Path));
+  llvm::FileRemover Remover(Path);
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << "int x;\nint y;\n";
+  }
+
+  auto Pool = std::make_shared<SourceBufferPool>();
+  SourceMgr.setBufferPool(Pool);
+  const FileEntry *File = FileMgr.getFile(Path);
+  ASSERT_TRUE(File);
+  FileID FID =
+      SourceMgr.createFileID(File, SourceLocation(), SrcMgr::C_System);
+  EXPECT_EQ(2U, SourceMgr.getLineNumber(FID, 7));
+  EXPECT_EQ(1U, Pool->getNumFiles());
+
+  // The overridden file gets its own line table, and the pooled contents
+  // are released.
+  SourceMgr.overrideFileContents(
+      File, llvm::MemoryBuffer::getMemBuffer("a\nb\nc\n").release());
+  EXPECT_EQ(0U, Pool->getNumFiles());
+  EXPECT_EQ(3U, SourceMgr.getLineNumber(FID, 4));
+
+  SourceMgr.disableFileContentsOverride(File);
+  EXPECT_EQ("int x;\nint y;\n", SourceMgr.getBufferData(FID));
+  EXPECT_EQ(1U, Pool->getNumFiles());
+  EXPECT_EQ(2U, SourceMgr.getLineNumber(FID, 7));
+}
+
 #if defined(LLVM_ON_UNIX)
 
 TEST_F(SourceManagerTest, getMacroArgExpandedLocation) {
@@ -0,0 +1,92 @@
+//===- unittests/Driver/CompileServerTest.cpp --- Compile server tests ----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Driver/CompileServer.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+#include "gtest/gtest.h"
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+using namespace clang;
+using namespace clang::driver;
+
+namespace {
+
+/// Send a job to the server at \p SocketPath, waiting for it to start.
+bool runJobWhenReady(StringRef SocketPath, ArrayRef<const char *> Argv,
+                     int &Result) {
+  for (unsigned I = 0; I != 500; ++I) {
+    if (compile_server::runJob(SocketPath, Argv, Result))
+      return true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return false;
+}
+
+TEST(CompileServerTest, RunsJobs) {
+  if (!compile_server::isSupported())
+    return;
+
+  SmallString<128> SocketPath;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("compile-server", "sock",
+                                                  SocketPath));
+  llvm::sys::fs::remove(SocketPath);
+
+  std::thread Server([&] {
+    std::string ErrMsg;
+    EXPECT_TRUE(compile_server::serve(
+        SocketPath,
+        [](ArrayRef<const char *> Argv) {
+          if (StringRef(Argv[1]) == "crash")
+            abort();
+          return (int)Argv.size();
+        },
+        /*MaxJobs=*/3, &ErrMsg))
+        << ErrMsg;
+  });
+
+  int Result = 0;
+  const char *Job[] = {"clang", "-cc1", "a.c"};
+  EXPECT_TRUE(runJobWhenReady(SocketPath, Job, Result));
+  EXPECT_EQ(3, Result);
+
+  // Only the user running the server can access its socket.
+  llvm::sys::fs::file_status Status;
+  EXPECT_FALSE(llvm::sys::fs::status(SocketPath, Status));
+  EXPECT_EQ(0u, unsigned(Status.permissions() & (llvm::sys::fs::group_all |
+                                                 llvm::sys::fs::others_all)));
+
+  const char *Crash[] = {"clang", "crash"};
+  EXPECT_TRUE(runJobWhenReady(SocketPath, Crash, Result));
+  EXPECT_GT(0, Result);
+
+  // A job that the server refuses is not reported as a crash, so that the
+  // caller can run it instead.
+  std::string ErrMsg;
+  EXPECT_FALSE(compile_server::runJob(SocketPath, None, Result, &ErrMsg));
+  EXPECT_FALSE(ErrMsg.empty());
+
+  Server.join();
+  EXPECT_FALSE(llvm::sys::fs::exists(SocketPath));
+}
+
+TEST(CompileServerTest, NoServer) {
+  int Result;
+  std::string ErrMsg;
+  const char *Job[] = {"clang", "-cc1"};
+  EXPECT_FALSE(compile_server::runJob("no-such-compile-server.sock", Job,
+                                      Result, &ErrMsg));
+  EXPECT_FALSE(ErrMsg.empty());
+}
+
+} // end anonymous namespace
@@ -0,0 +1,111 @@
+//===- unittests/Frontend/SerializedDiagnosticTableTest.cpp ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/SerializedDiagnosticTable.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Frontend/SerializedDiagnosticPrinter.h"
+#include "clang/Frontend/SerializedDiagnosticReader.h"
+#include "clang/Frontend/SerializedDiagnostics.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace clang;
+using namespace clang::serialized_diags;
+
+namespace {
+
+class SerializedDiagnosticTableTest : public ::testing::Test {
+protected:
+  std::vector<std::string> Paths;
+
+  void TearDown() override {
+    for (const std::string &Path : Paths)
+      llvm::sys::fs::remove(Path);
+  }
+
+  /// Write a serialized diagnostics file containing one warning per message.
+  std::string writeWarnings(ArrayRef<StringRef> Messages) {
+    SmallString<128> Path;
+    EXPECT_FALSE(llvm::sys::fs::createTemporaryFile("diags", "dia", Path));
+    Paths.push_back(Path.str());
+
+    IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+    std::unique_ptr<DiagnosticConsumer> Consumer =
+        serialized_diags::create(Path, &*DiagOpts);
+    DiagnosticsEngine Diags(new DiagnosticIDs(), &*DiagOpts, Consumer.get(),
+                            /*ShouldOwnClient=*/false);
+    unsigned ID = Diags.getCustomDiagID(DiagnosticsEngine::Warning, "%0");
+    for (StringRef Message : Messages)
+      Diags.Report(ID) << Message;
+    Consumer->finish();
+    return Path.str();
+  }
+};
+
+TEST_F(SerializedDiagnosticTableTest, DeduplicatesAcrossFiles) {
+  std::string A = writeWarnings({"shared", "only in a"});
+  std::string B = writeWarnings({"shared", "only in b"});
+
+  SerializedDiagnosticTable Table;
+  EXPECT_FALSE(Table.addFile(A));
+  EXPECT_FALSE(Table.addFile(B));
+
+  EXPECT_EQ(2U, Table.getNumSources());
+  EXPECT_EQ(4U, Table.getNumDiagnosticsRead());
+  ASSERT_EQ(3U, Table.size());
+
+  EXPECT_EQ("shared", Table.getString(Table.getMessages()[0]));
+  EXPECT_EQ(2U, Table.getOccurrences()[0]);
+  EXPECT_EQ(0U, Table.getFirstSources()[0]);
+  EXPECT_EQ("only in b", Table.getString(Table.getMessages()[2]));
+  EXPECT_EQ(1U, Table.getOccurrences()[2]);
+  EXPECT_EQ(B, Table.getSourceName(Table.getFirstSources()[2]));
+  for (unsigned Severity : Table.getSeverities())
+    EXPECT_EQ((unsigned)serialized_diags::Warning, Severity);
+  for (unsigned File : Table.getFiles())
+    EXPECT_EQ("", Table.getString(File));
+}
+
+TEST_F(SerializedDiagnosticTableTest, AddFilesIsDeterministic) {
+  std::vector<std::string> Files;
+  for (unsigned I = 0; I != 20; ++I)
+    Files.push_back(writeWarnings({"shared", I % 2 ? "odd" : "even"}));
+  Files.push_back("no-such-file.dia");
+
+  SerializedDiagnosticTable Serial, Parallel;
+  EXPECT_EQ(1U, Serial.addFiles(Files, 1));
+  EXPECT_EQ(1U, Parallel.addFiles(Files, 4));
+
+  ASSERT_EQ(3U, Parallel.size());
+  EXPECT_EQ(20U, Parallel.getNumSources());
+  EXPECT_EQ(20U, Parallel.getOccurrences()[0]);
+  EXPECT_EQ(10U, Parallel.getOccurrences()[1]);
+  for (unsigned I = 0; I != 3; ++I) {
+    EXPECT_EQ(Serial.getString(Serial.getMessages()[I]),
+              Parallel.getString(Parallel.getMessages()[I]));
+    EXPECT_EQ(Serial.getOccurrences()[I], Parallel.getOccurrences()[I]);
+  }
+}
+
+TEST_F(SerializedDiagnosticTableTest, RejectsInvalidFiles) {
+  SerializedDiagnosticTable Table;
+  EXPECT_EQ(SDError::CouldNotLoad, Table.addFile("no-such-file.dia"));
+
+  std::unique_ptr<MemoryBuffer> Garbage =
+      MemoryBuffer::getMemBuffer("not a diagnostics file");
+  EXPECT_EQ(SDError::InvalidSignature,
+            Table.addBuffer(Garbage->getMemBufferRef(), "garbage"));
+  EXPECT_EQ(0U, Table.getNumSources());
+  EXPECT_TRUE(Table.empty());
+}
+
+} // anonymous namespace
@@ -0,0 +1,118 @@
+//===- unittests/Lex/DependencyDirectivesSourceMinimizerTest.cpp ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
+#include "llvm/ADT/SmallString.h"
+#include "gtest/gtest.h"
+
+using namespace clang;
+using namespace llvm;
+
+namespace {
+
+std::string minimize(StringRef Input) {
+  SmallString<128> Out;
+  EXPECT_FALSE(minimizeSourceToDependencyDirectives(Input, Out));
+  return Out.str();
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, Empty) {
+  EXPECT_EQ("", minimize(""));
+  EXPECT_EQ("", minimize("int x;\nvoid f() { return; }\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, KeptDirectives) {
+  EXPECT_EQ("#include <a.h>\n"
+            "#include_next \"b.h\"\n"
+            "#import <c.h>\n"
+            "#define X(a) a + 1\n"
+            "#undef Y\n"
+            "#if defined(X) && __has_include(<d.h>)\n"
+            "#elif 0\n"
+            "#else\n"
+            "#endif\n",
+            minimize("#include <a.h>\n"
+                     "#include_next \"b.h\"\n"
+                     "#import <c.h>\n"
+                     "#define X(a) a + 1\n"
+                     "int x = X(1);\n"
+                     "#undef Y\n"
+                     "#if defined(X) && __has_include(<d.h>)\n"
+                     "#elif 0\n"
+                     "#else\n"
+                     "#endif\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, DroppedDirectives) {
+  EXPECT_EQ("#ifdef X\n#endif\n",
+            minimize("#ifdef X\n#error oops\n#warning hmm\n#line 3\n#\n"
+                     "#pragma mark - foo\n#ident \"x\"\n#endif\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, Pragmas) {
+  EXPECT_EQ("#pragma once\n"
+            "#pragma push_macro(\"X\")\n"
+            "#pragma GCC system_header\n"
+            "#pragma clang module import Foo\n",
+            minimize("#pragma once\n"
+                     "#pragma push_macro(\"X\")\n"
+                     "#pragma GCC system_header\n"
+                     "#pragma GCC poison X\n"
+                     "#pragma clang diagnostic push\n"
+                     "#pragma clang module import Foo\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, WhitespaceAndComments) {
+  EXPECT_EQ("#include \"a.h\"\n"
+            "#define X 1 + 2\n"
+            "#define Y \"/* not a comment */\"\n",
+            minimize("  #  include \"a.h\" // trailing\n"
+                     "/* leading\n comment */ # define X 1 /* c */+ 2\n"
+                     "#define Y \"/* not a comment */\"\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, LineSplices) {
+  EXPECT_EQ("#define X 1 + 2\n#include <a.h>\n",
+            minimize("#define X 1 \\\n  + 2\n"
+                     "// comment \\\n#include <not-included.h>\n"
+                     "#include \\\r\n<a.h>\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, NotAtStartOfLine) {
+  EXPECT_EQ("", minimize("int x; #include <a.h>\n"));
+  EXPECT_EQ("", minimize("int x; /* c\n */ #include <a.h>\n"));
+  EXPECT_EQ("#include <a.h>\n", minimize("int x; // c\n#include <a.h>\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, Literals) {
+  // Literals hide comments and directives.
+  EXPECT_EQ("#include <a.h>\n",
+            minimize("const char *s = \"/*\";\n#include <a.h>\n"));
+  EXPECT_EQ("#include <a.h>\n",
+            minimize("const char *s = R\"x(\n#include <b.h>\n)x\";\n"
+                     "#include <a.h>\n"));
+  EXPECT_EQ("#include <a.h>\n",
+            minimize("int x = 1'000'000; char c = '\"';\n#include <a.h>\n"));
+  // An unterminated literal ends at the end of its line.
+  EXPECT_EQ("#if 0\n#endif\n#include <a.h>\n",
+            minimize("#if 0\ndon't\n#endif\n#include <a.h>\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, AtImport) {
+  EXPECT_EQ("@import A;\n@import A.B;\n",
+            minimize("@import A;\n@import A . B; int x;\n@interface I\n"));
+  SmallString<128> Out;
+  EXPECT_TRUE(minimizeSourceToDependencyDirectives("@import A\n", Out));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, Digraphs) {
+  EXPECT_EQ("#include <a.h>\n", minimize("%:include <a.h>\n"));
+}
+
+} // anonymous namespace
@@ -17,6 +17,7 @@
 #include "clang/Basic/TargetOptions.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/HeaderSearchOptions.h"
+#include "clang/Lex/MacroInfo.h"
 #include "clang/Lex/ModuleLoader.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/PreprocessorOptions.h"
@@ -58,24 +59,32 @@ protected:
     Target = TargetInfo::CreateTargetInfo(Diags, TargetOpts);
   }
 
-  std::vector<Token> Lex(StringRef Source) {
+  std::unique_ptr<Preprocessor> CreatePP(StringRef Source,
+                                         VoidModuleLoader &ModLoader) {
     std::unique_ptr<llvm::MemoryBuffer> Buf =
         llvm::MemoryBuffer::getMemBuffer(Source);
     SourceMgr.setMainFileID(SourceMgr.createFileID(std::move(Buf)));
 
+    HeaderSearch *HeaderInfo =
+        new HeaderSearch(std::make_shared<HeaderSearchOptions>(), SourceMgr,
+                         Diags, LangOpts, Target.get());
+    std::unique_ptr<Preprocessor> PP = llvm::make_unique<Preprocessor>(
+        std::make_shared<PreprocessorOptions>(), Diags, LangOpts, SourceMgr,
+        *HeaderInfo, ModLoader, /*IILookup =*/nullptr,
+        /*OwnsHeaderSearch =*/true);
+    PP->Initialize(*Target);
+    PP->EnterMainSourceFile();
+    return PP;
+  }
+
+  std::vector<Token> Lex(StringRef Source) {
     VoidModuleLoader ModLoader;
-    HeaderSearch HeaderInfo(std::make_shared<HeaderSearchOptions>(), SourceMgr,
-                            Diags, LangOpts, Target.get());
-    Preprocessor PP(std::make_shared<PreprocessorOptions>(), Diags, LangOpts,
-                    SourceMgr, HeaderInfo, ModLoader, /*IILookup =*/nullptr,
-                    /*OwnsHeaderSearch =*/false);
-    PP.Initialize(*Target);
-    PP.EnterMainSourceFile();
+    std::unique_ptr<Preprocessor> PP = CreatePP(Source, ModLoader);
 
     std::vector<Token> toks;
     while (1) {
       Token tok;
-      PP.Lex(tok);
+      PP->Lex(tok);
       if (tok.is(tok::eof))
         break;
       toks.push_back(tok);
@@ -380,4 +389,126 @@ TEST_F(LexerTest, DontMergeMacroArgsFromDifferentMacroFiles) {
   EXPECT_EQ(SourceMgr.getFileIDSize(SourceMgr.getFileID(helper1ArgLoc)), 8U);
 }
 
+TEST_F(LexerTest, IdentifiersFoundWithLexerHash) {
+  const char *Source = "int foo;\n"
+                       "int fo\\\no;\n"
+                       "int foo$;\n"
+                       "int foo;\n"
+                       "int \xc3\xa9t\xc3\xa9;\n"
+                       "int \xc3\xa9t\xc3\xa9;\n";
+  VoidModuleLoader ModLoader;
+  std::unique_ptr<Preprocessor> PPPtr = CreatePP(Source, ModLoader);
+  Preprocessor &PP = *PPPtr;
+
+  std::vector<IdentifierInfo *> Identifiers;
+  for (Token Tok; PP.Lex(Tok), Tok.isNot(tok::eof);)
+    if (Tok.is(tok::identifier))
+      Identifiers.push_back(Tok.getIdentifierInfo());
+
+  // Spellings that need cleaning and the ones that don't are found in the
+  // same table.
+  ASSERT_EQ(6U, Identifiers.size());
+  EXPECT_EQ(PP.getIdentifierInfo("foo"), Identifiers[0]);
+  EXPECT_EQ(Identifiers[0], Identifiers[1]);
+  EXPECT_EQ(PP.getIdentifierInfo("foo$"), Identifiers[2]);
+  EXPECT_EQ(Identifiers[0], Identifiers[3]);
+  EXPECT_EQ(PP.getIdentifierInfo("\xc3\xa9t\xc3\xa9"), Identifiers[4]);
+  EXPECT_EQ(Identifiers[4], Identifiers[5]);
+
+  IdentifierTable &Table = PP.getIdentifierTable();
+  EXPECT_EQ(&Table.get("bar"),
+            &Table.getWithHash("bar", IdentifierTable::getHashValue("bar")));
+  EXPECT_EQ(&Table.get("bar"),
+            &Table.getWithHash("bar", IdentifierTable::getHashValue("bar")));
+}
+
+TEST_F(LexerTest, MacroTokensStoredInPreprocessor) {
+  VoidModuleLoader ModLoader;
+  std::unique_ptr<Preprocessor> PP =
+      CreatePP("#define EMPTY\n"
+               "#define PLUS_ONE(x) (x) + 1\n"
+               "#define CAT(a, ...) a ## __VA_ARGS__\n"
+               "PLUS_ONE(EMPTY 2)\n",
+               ModLoader);
+
+  std::vector<Token> Toks;
+  for (Token Tok; PP->Lex(Tok), Tok.isNot(tok::eof);)
+    Toks.push_back(Tok);
+  ASSERT_EQ(5U, Toks.size());
+  EXPECT_TRUE(Toks[0].is(tok::l_paren));
+  EXPECT_TRUE(Toks[1].is(tok::numeric_constant));
+  EXPECT_TRUE(Toks[4].is(tok::numeric_constant));
+
+  const MacroInfo *Empty = PP->getMacroInfo(PP->getIdentifierInfo("EMPTY"));
+  ASSERT_TRUE(Empty);
+  EXPECT_TRUE(Empty->tokens_empty());
+  EXPECT_EQ(0U, Empty->getNumTokens());
+
+  const MacroInfo *PlusOne =
+      PP->getMacroInfo(PP->getIdentifierInfo("PLUS_ONE"));
+  ASSERT_TRUE(PlusOne);
+  ArrayRef<Token> Body = PlusOne->tokens();
+  ASSERT_EQ(5U, Body.size());
+  EXPECT_EQ(Body.begin(), PlusOne->tokens_begin());
+  EXPECT_TRUE(Body[0].is(tok::l_paren));
+  EXPECT_EQ(PP->getIdentifierInfo("x"), Body[1].getIdentifierInfo());
+  EXPECT_TRUE(Body[3].is(tok::plus));
+  EXPECT_TRUE(PlusOne->getReplacementToken(4).is(tok::numeric_constant));
+
+  const MacroInfo *Cat = PP->getMacroInfo(PP->getIdentifierInfo("CAT"));
+  ASSERT_TRUE(Cat);
+  ASSERT_EQ(3U, Cat->getNumTokens());
+  EXPECT_TRUE(Cat->getReplacementToken(1).is(tok::hashhash));
+  EXPECT_FALSE(Cat->hasCommaPasting());
+}
+
+TEST_F(LexerTest, SkipBalancedBraces) {
+  LangOpts.LineComment = true;
+  LangOpts.Digraphs = true;
+  LangOpts.CPlusPlus14 = true;
+  VoidModuleLoader ModLoader;
+  std::unique_ptr<Preprocessor> PP = CreatePP(
+      "{ int x = '}'; \"}\"; 1'0; /* } */ <% { } %> // }\n"
+      "} after",
+      ModLoader);
+
+  Token Tok;
+  PP->Lex(Tok);
+  ASSERT_TRUE(Tok.is(tok::l_brace));
+  ASSERT_TRUE(PP->SkipBalancedBraces(1, Tok));
+  EXPECT_TRUE(Tok.is(tok::r_brace));
+  EXPECT_TRUE(Tok.isAtStartOfLine());
+  EXPECT_EQ(48U, SourceMgr.getFileOffset(Tok.getLocation()));
+
+  PP->Lex(Tok);
+  ASSERT_TRUE(Tok.is(tok::identifier));
+  EXPECT_EQ("after", Tok.getIdentifierInfo()->getName());
+  EXPECT_TRUE(Tok.hasLeadingSpace());
+}
+
+TEST_F(LexerTest, SkipBalancedBracesDefersToLexer) {
+  LangOpts.LineComment = true;
+  const char *Sources[] = {
+      "{ __LINE__ }",         "{ #pragma }",
+      "{ R\"(})\" }",         "{ ??> }",
+      "{ x // \\\n} }",       "{ x /* *\\\n/ } */ }",
+      "{ \"}\n}",             "{ x",
+  };
+  for (const char *Source : Sources) {
+    VoidModuleLoader ModLoader;
+    std::unique_ptr<Preprocessor> PP = CreatePP(Source, ModLoader);
+
+    Token Tok;
+    PP->Lex(Tok);
+    ASSERT_TRUE(Tok.is(tok::l_brace));
+    EXPECT_FALSE(PP->SkipBalancedBraces(1, Tok)) << Source;
+
+    // Nothing was consumed.
+    PP->Lex(Tok);
+    EXPECT_EQ(2U, SourceMgr.getFileOffset(
+                      SourceMgr.getExpansionLoc(Tok.getLocation())))
+        << Source;
+  }
+}
+
 } // anonymous namespace
@@ -48,4 +48,155 @@ TEST(RewriteBuffer, TagRanges) {
   EXPECT_EQ(Output, Result);
 }
 
+static std::string getContents(const RewriteBuffer &Buf) {
+  std::string Result;
+  raw_string_ostream OS(Result);
+  Buf.write(OS);
+  return OS.str();
+}
+
+static void applyEditsOneByOne(ArrayRef<RewriteBuffer::Edit> Edits,
+                               RewriteBuffer &Buf) {
+  for (const RewriteBuffer::Edit &E : Edits) {
+    switch (E.Kind) {
+    case RewriteBuffer::Edit::InsertBefore:
+      Buf.InsertTextBefore(E.OrigOffset, E.Text);
+      break;
+    case RewriteBuffer::Edit::InsertAfter:
+      Buf.InsertTextAfter(E.OrigOffset, E.Text);
+      break;
+    case RewriteBuffer::Edit::Replace:
+      Buf.ReplaceText(E.OrigOffset, E.OrigLength, E.Text);
+      break;
+    }
+  }
+}
+
+TEST(RewriteBuffer, ApplyEditsOrdersEditsAtSameOffset) {
+  StringRef Input = "0123456789";
+  std::vector<RewriteBuffer::Edit> Edits = {
+      {RewriteBuffer::Edit::Replace, 2, 3, "r1"},
+      {RewriteBuffer::Edit::InsertAfter, 2, 0, "a1"},
+      {RewriteBuffer::Edit::InsertBefore, 2, 0, "b1"},
+      {RewriteBuffer::Edit::Replace, 2, 0, "r2"},
+      {RewriteBuffer::Edit::InsertAfter, 2, 0, "a2"},
+      {RewriteBuffer::Edit::InsertBefore, 2, 0, "b2"},
+      {RewriteBuffer::Edit::InsertBefore, 5, 0, "e"},
+      {RewriteBuffer::Edit::Replace, 0, 1, ""},
+      {RewriteBuffer::Edit::InsertAfter, 10, 0, "!"},
+  };
+
+  RewriteBuffer Batched;
+  Batched.Initialize(Input);
+  Batched.applyEdits(Edits);
+  EXPECT_EQ("1b2b1a1a2r2r1e56789!", getContents(Batched));
+
+  // Offsets are still mapped correctly after the batch.
+  RewriteBuffer OneByOne;
+  OneByOne.Initialize(Input);
+  applyEditsOneByOne(Edits, OneByOne);
+  for (RewriteBuffer *Buf : {&Batched, &OneByOne}) {
+    Buf->InsertTextAfter(2, "<");
+    Buf->InsertTextBefore(5, ">");
+    Buf->ReplaceText(7, 1, "_");
+  }
+  EXPECT_EQ(getContents(OneByOne), getContents(Batched));
+}
+
+TEST(RewriteBuffer, ApplyEditsMatchesEditsOneByOne) {
+  // Rename every "foo" in a large input and wrap every line, as a mass
+  // refactoring would.
+  std::string Input;
+  for (unsigned I = 0; I != 2000; ++I)
+    Input += "int foo" + std::to_string(I) + " = foo;\n";
+
+  std::vector<RewriteBuffer::Edit> Edits;
+  size_t LineStart = 0;
+  for (size_t Pos = Input.find("foo"); Pos != std::string::npos;
+       Pos = Input.find("foo", Pos + 3))
+    Edits.push_back({RewriteBuffer::Edit::Replace, (unsigned)Pos, 3, "bar"});
+  for (size_t Pos = Input.find('\n'); Pos != std::string::npos;
+       Pos = Input.find('\n', Pos + 1)) {
+    Edits.push_back(
+        {RewriteBuffer::Edit::InsertAfter, (unsigned)LineStart, 0, "/*"});
+    Edits.push_back({RewriteBuffer::Edit::InsertBefore, (unsigned)Pos, 0, "*/"});
+    LineStart = Pos + 1;
+  }
+
+  RewriteBuffer Batched, OneByOne;
+  Batched.Initialize(Input);
+  OneByOne.Initialize(Input);
+  Batched.applyEdits(Edits);
+  applyEditsOneByOne(Edits, OneByOne);
+  EXPECT_EQ(getContents(OneByOne), getContents(Batched));
+
+  // A second batch is applied on top of the first one.
+  std::vector<RewriteBuffer::Edit> More = {
+      {RewriteBuffer::Edit::Replace, 4, 3, "baz"},
+      {RewriteBuffer::Edit::InsertBefore, 0, 0, "// header\n"},
+  };
+  Batched.applyEdits(More);
+  applyEditsOneByOne(More, OneByOne);
+  EXPECT_EQ(getContents(OneByOne), getContents(Batched));
+}
+
+TEST(RewriteBuffer, ApplyEditsWithOverlappingRemovals) {
+  // A replacement that removes text inserted at the same offset by an earlier
+  // one cannot be applied in a single pass, but must still work.
+  StringRef Input = "abcdef";
+  std::vector<RewriteBuffer::Edit> Edits = {
+      {RewriteBuffer::Edit::Replace, 1, 0, "XY"},
+      {RewriteBuffer::Edit::Replace, 1, 3, "Z"},
+  };
+
+  RewriteBuffer Batched, OneByOne;
+  Batched.Initialize(Input);
+  OneByOne.Initialize(Input);
+  Batched.applyEdits(Edits);
+  applyEditsOneByOne(Edits, OneByOne);
+  EXPECT_EQ(getContents(OneByOne), getContents(Batched));
+}
+
+TEST(RewriteBuffer, RemoveManyEmptyLines) {
+  std::string Input, Output;
+  for (unsigned I = 0; I != 1000; ++I) {
+    Input += "  dead();\nlive();\n";
+    Output += "live();\n";
+  }
+
+  RewriteBuffer Buf;
+  Buf.Initialize(Input);
+  for (unsigned I = 0; I != 1000; ++I)
+    Buf.RemoveText(I * 18 + 2, 7, /*removeLineIfEmpty=*/true);
+  EXPECT_EQ(Output, getContents(Buf));
+}
+
+TEST(RewriteBuffer, RemoveLongEmptyLine) {
+  std::string Spaces(1000, ' ');
+  RewriteBuffer Buf;
+  Buf.Initialize("a\n" + Spaces + "x" + Spaces + "\nb\n");
+  Buf.InsertTextAfter(1, "a");
+  Buf.RemoveText(1002, 1, /*removeLineIfEmpty=*/true);
+  EXPECT_EQ("aa\nb\n", getContents(Buf));
+}
+
+TEST(RewriteRope, Seek) {
+  RewriteRope Rope;
+  std::string Expected;
+  for (unsigned I = 0; I != 500; ++I) {
+    std::string Str = std::to_string(I) + ",";
+    unsigned Offset = Expected.size() / 2;
+    Rope.insert(Offset, Str.data(), Str.data() + Str.size());
+    Expected.insert(Offset, Str);
+  }
+
+  for (unsigned I = 0, E = Expected.size(); I != E; ++I) {
+    RewriteRope::iterator It = Rope.seek(I);
+    ASSERT_TRUE(It != Rope.end());
+    EXPECT_EQ(Expected[I], *It);
+    EXPECT_EQ(Expected[I], It.piece()[0]);
+  }
+  EXPECT_TRUE(Rope.seek(Expected.size()) == Rope.end());
+}
+
 } // anonymous namespace
@@ -0,0 +1,89 @@
+//===- unittest/Tooling/DependencyScanningToolTest.cpp --------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Tooling/DependencyScanningTool.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/VirtualFileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace tooling {
+
+namespace {
+
+llvm::IntrusiveRefCntPtr<vfs::FileSystem> createSources() {
+  llvm::IntrusiveRefCntPtr<vfs::OverlayFileSystem> OverlayFileSystem(
+      new vfs::OverlayFileSystem(vfs::getRealFileSystem()));
+  llvm::IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFileSystem(
+      new vfs::InMemoryFileSystem);
+  OverlayFileSystem->pushOverlay(InMemoryFileSystem);
+  // The code outside of the directives is not parsed, errors included.
+  InMemoryFileSystem->addFile(
+      "/scan/src/main.c", 0,
+      llvm::MemoryBuffer::getMemBuffer("#include \"a.h\"\n"
+                                       "#include <b.h>\n"
+                                       "int main() { return undeclared; }\n"));
+  InMemoryFileSystem->addFile(
+      "/scan/src/other.c", 0,
+      llvm::MemoryBuffer::getMemBuffer("#include <b.h>\n"));
+  InMemoryFileSystem->addFile(
+      "/scan/src/a.h", 0,
+      llvm::MemoryBuffer::getMemBuffer("#if 0\n#include \"missing.h\"\n"
+                                       "#endif\nvoid f(void) {\n"));
+  InMemoryFileSystem->addFile(
+      "/scan/inc/b.h", 0, llvm::MemoryBuffer::getMemBuffer("#pragma once\n"));
+  return OverlayFileSystem;
+}
+
+} // end anonymous namespace
+
+TEST(DependencyScanningTool, ComputesDependencies) {
+  DependencyScanningTool Tool(std::make_shared<DependencyScanningCache>(),
+                              createSources());
+  std::string Dependencies;
+  EXPECT_TRUE(Tool.computeDependencies(
+      {"clang", "-c", "main.c", "-o", "main.o", "-I/scan/inc"}, "/scan/src",
+      Dependencies));
+  EXPECT_EQ("main.o: main.c \\\n  a.h \\\n  /scan/inc/b.h\n", Dependencies);
+}
+
+TEST(DependencyScanningTool, SharesCacheAcrossWorkingDirectories) {
+  auto Cache = std::make_shared<DependencyScanningCache>();
+  DependencyScanningTool Tool(Cache, createSources());
+  std::string Dependencies;
+  EXPECT_TRUE(Tool.computeDependencies(
+      {"clang", "-c", "src/other.c", "-MT", "other.o", "-Iinc"}, "/scan",
+      Dependencies));
+  EXPECT_EQ("other.o: src/other.c \\\n  inc/b.h\n", Dependencies);
+
+  DependencyScanningTool OtherTool(Cache, createSources());
+  EXPECT_TRUE(OtherTool.computeDependencies(
+      {"clang", "-c", "other.c", "-I../inc"}, "/scan/src", Dependencies));
+  EXPECT_EQ("other.o: other.c \\\n  ../inc/b.h\n", Dependencies);
+}
+
+TEST(DependencyScanningTool, FailsOnMissingInclude) {
+  llvm::IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFileSystem(
+      new vfs::InMemoryFileSystem);
+  InMemoryFileSystem->addFile(
+      "/scan/main.c", 0,
+      llvm::MemoryBuffer::getMemBuffer("#include \"missing.h\"\n"));
+  DependencyScanningTool Tool(std::make_shared<DependencyScanningCache>(),
+                              InMemoryFileSystem);
+  DiagnosticConsumer Diags;
+  std::string Dependencies;
+  EXPECT_FALSE(Tool.computeDependencies({"clang", "-c", "main.c"}, "/scan",
+                                        Dependencies, &Diags));
+}
+
+} // end namespace tooling
+} // end namespace clang
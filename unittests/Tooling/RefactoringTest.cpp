@@ -546,6 +546,22 @@ TEST_F(ReplacementTest, MultipleFilesReplaceAndFormat) {
   EXPECT_EQ(Expected2, Context.getRewrittenText(ID2));
 }
 
+TEST(ApplyAllReplacementsTest, AppliesToCodeInOnePass) {
+  Replacements Replaces =
+      toReplacements({Replacement("", 0, 0, "// "), Replacement("", 4, 3, "x"),
+                      Replacement("", 9, 0, "y"), Replacement("", 9, 1, "z")});
+  auto Result = applyAllReplacements("int abc = 1;", Replaces);
+  ASSERT_TRUE(static_cast<bool>(Result));
+  EXPECT_EQ("// int x =yz1;", *Result);
+}
+
+TEST(ApplyAllReplacementsTest, FailsForOffsetsPastTheEnd) {
+  Replacements Replaces = toReplacements({Replacement("", 3, 5, "x")});
+  auto Result = applyAllReplacements("int", Replaces);
+  EXPECT_FALSE(static_cast<bool>(Result));
+  llvm::consumeError(Result.takeError());
+}
+
 TEST(ShiftedCodePositionTest, FindsNewCodePosition) {
   Replacements Replaces =
       toReplacements({Replacement("", 0, 1, ""), Replacement("", 4, 3, " ")});
@@ -645,6 +661,38 @@ TEST_F(FlushRewrittenFilesTest, StoresChangesOnDisk) {
             getFileContentFromDisk("input.cpp"));
 }
 
+TEST_F(FlushRewrittenFilesTest, AppliesAndSavesManyFiles) {
+  createFile("a.cpp", "int a = 1;\nint b = 2;\n");
+  createFile("b.cpp", "int c = 3;\n");
+  createFile("unchanged.cpp", "int d = 4;\n");
+
+  std::map<std::string, Replacements> FileToReplaces;
+  std::string PathA = TemporaryFiles.lookup("a.cpp");
+  std::string PathB = TemporaryFiles.lookup("b.cpp");
+  FileToReplaces[PathA] = toReplacements(
+      {Replacement(PathA, 8, 1, "10"), Replacement(PathA, 19, 1, "20")});
+  FileToReplaces[PathB] = toReplacements({Replacement(PathB, 4, 1, "cc")});
+
+  EXPECT_TRUE(applyAllReplacementsAndSave(FileToReplaces, Context.Files,
+                                          /*Style=*/"", /*NumThreads=*/2));
+  EXPECT_EQ("int a = 10;\nint b = 20;\n", getFileContentFromDisk("a.cpp"));
+  EXPECT_EQ("int cc = 3;\n", getFileContentFromDisk("b.cpp"));
+  EXPECT_EQ("int d = 4;\n", getFileContentFromDisk("unchanged.cpp"));
+}
+
+TEST_F(FlushRewrittenFilesTest, ApplyAndSaveFormatsReplacements) {
+  createFile("format.cpp", "int x = 123;\nint y = 0;");
+  std::string Path = TemporaryFiles.lookup("format.cpp");
+
+  std::map<std::string, Replacements> FileToReplaces;
+  FileToReplaces[Path] = toReplacements(
+      {Replacement(Path, 11, 0, "4567890123"), Replacement(Path, 21, 1, "10")});
+  EXPECT_TRUE(applyAllReplacementsAndSave(
+      FileToReplaces, Context.Files, "{BasedOnStyle: LLVM, ColumnLimit: 20}"));
+  EXPECT_EQ("int x =\n    1234567890123;\nint y = 10;",
+            getFileContentFromDisk("format.cpp"));
+}
+
 namespace {
 template <typename T>
 class TestVisitor : public clang::RecursiveASTVisitor<T> {
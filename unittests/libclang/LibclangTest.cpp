@@ -18,6 +18,7 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <vector>
 #define DEBUG_TYPE "libclang-test"
 
 TEST(libclang, clang_parseTranslationUnit2_InvalidArgs) {
@@ -460,6 +461,42 @@ TEST_F(LibclangParseTest, AllSkippedRanges) {
   clang_disposeSourceRangeList(Ranges);
 }
 
+static int RecordAndDisposeTU(CXTranslationUnit TU, unsigned long long Bytes,
+                              CXClientData Data) {
+  static_cast<std::vector<CXTranslationUnit> *>(Data)->push_back(TU);
+  clang_disposeTranslationUnit(TU);
+  return 1;
+}
+
+TEST_F(LibclangParseTest, MemoryBudget) {
+  std::string Main1 = "main1.c", Main2 = "main2.c";
+  WriteFile(Main1, "int foo(void) { return 0; }\n");
+  WriteFile(Main2, "int bar(void) { return 1; }\n");
+
+  CXTranslationUnit TU1 = clang_parseTranslationUnit(
+      Index, Main1.c_str(), nullptr, 0, nullptr, 0, TUFlags);
+  ClangTU = clang_parseTranslationUnit(Index, Main2.c_str(), nullptr, 0,
+                                       nullptr, 0, TUFlags);
+  ASSERT_TRUE(TU1 && ClangTU);
+  EXPECT_NE(0ULL, clang_getTranslationUnitMemoryUsage(TU1));
+
+  // No budget: nothing is evicted.
+  std::vector<CXTranslationUnit> Evicted;
+  EXPECT_EQ(0U, clang_CXIndex_enforceMemoryBudget(Index, RecordAndDisposeTU,
+                                                  &Evicted));
+
+  // Reparsing TU1 makes ClangTU the least recently used one.
+  ASSERT_EQ(0, clang_reparseTranslationUnit(TU1, 0, nullptr,
+                                            clang_defaultReparseOptions(TU1)));
+  clang_CXIndex_setMemoryBudget(Index,
+                                clang_getTranslationUnitMemoryUsage(TU1));
+  EXPECT_EQ(1U, clang_CXIndex_enforceMemoryBudget(Index, RecordAndDisposeTU,
+                                                  &Evicted));
+  ASSERT_EQ(1U, Evicted.size());
+  EXPECT_EQ(ClangTU, Evicted[0]);
+  ClangTU = TU1;
+}
+
 class LibclangReparseTest : public LibclangParseTest {
 public:
   void DisplayDiagnostics() {
@@ -0,0 +1,103 @@
+#!/usr/bin/env python
+
+"""
+Measure the throughput of clang-offload-bundler when bundling and unbundling
+large binary device images.
+
+The benchmark writes one host file and several device images of the requested
+size to a scratch directory, then times bundling them, unbundling all of them,
+and extracting a single device image.
+
+Usage:
+  offload-bundler-throughput.py [--bundler PATH] [--size-mb N] [--devices N]
+                                [--repeat N] [--dir DIR]
+"""
+
+from __future__ import print_function
+
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+HOST = 'host-x86_64-unknown-linux-gnu'
+DEVICE = 'openmp-nvptx64-nvidia-cuda%d'
+
+
+def write_file(path, size):
+    chunk = os.urandom(1 << 20)
+    with open(path, 'wb') as f:
+        while size > 0:
+            f.write(chunk[:min(size, len(chunk))])
+            size -= len(chunk)
+
+
+def run(cmd, repeat):
+    best = None
+    for _ in range(repeat):
+        start = time.time()
+        subprocess.check_call(cmd)
+        elapsed = time.time() - start
+        best = elapsed if best is None else min(best, elapsed)
+    return best
+
+
+def report(name, num_bytes, seconds):
+    print('%-10s %8.3f s  %10.1f MB/s' %
+          (name, seconds, num_bytes / float(1 << 20) / max(seconds, 1e-9)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--bundler', default='clang-offload-bundler',
+                        help='path to clang-offload-bundler')
+    parser.add_argument('--size-mb', type=int, default=256,
+                        help='size of each device image, in MB')
+    parser.add_argument('--devices', type=int, default=2,
+                        help='number of device images')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='number of runs; the fastest is reported')
+    parser.add_argument('--dir', help='scratch directory (default: a new '
+                        'temporary directory, which is removed afterwards)')
+    args = parser.parse_args()
+
+    scratch = args.dir or tempfile.mkdtemp(prefix='offload-bundler-')
+    try:
+        size = args.size_mb << 20
+        host = os.path.join(scratch, 'host.bc')
+        write_file(host, 1 << 20)
+        targets = [HOST]
+        inputs = [host]
+        for i in range(args.devices):
+            targets.append(DEVICE % i)
+            inputs.append(os.path.join(scratch, 'device%d.bin' % i))
+            write_file(inputs[-1], size)
+        total = sum(os.path.getsize(f) for f in inputs)
+
+        bundle = os.path.join(scratch, 'bundle.bc')
+        bundle_cmd = [args.bundler, '-type=bc', '-targets=' + ','.join(targets),
+                      '-inputs=' + ','.join(inputs), '-outputs=' + bundle]
+        report('bundle', total, run(bundle_cmd, args.repeat))
+
+        outputs = [os.path.join(scratch, 'out%d' % i)
+                   for i in range(len(targets))]
+        unbundle_cmd = [args.bundler, '-type=bc', '-unbundle',
+                        '-targets=' + ','.join(targets),
+                        '-inputs=' + bundle, '-outputs=' + ','.join(outputs)]
+        report('unbundle', total, run(unbundle_cmd, args.repeat))
+
+        extract_cmd = [args.bundler, '-type=bc', '-unbundle',
+                       '-targets=' + targets[-1], '-inputs=' + bundle,
+                       '-outputs=' + outputs[-1]]
+        report('extract', size, run(extract_cmd, args.repeat))
+    finally:
+        if not args.dir:
+            shutil.rmtree(scratch)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())